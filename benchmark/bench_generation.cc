@@ -0,0 +1,334 @@
+/*!
+  \file bench_generation.cc
+
+  \brief Time the core generation loops and the samplers without Python.
+
+  For each point of a grid of N, mutation rate, and recombination rate, a
+  population is burned in and then the time taken by one generation of
+  fwdpy::evolve_regions_sampler_cpp_details (standard W-F model) and
+  fwdpy::qtrait::evolve_regions_qtrait_sampler_cpp_details (Gaussian
+  stabilizing selection) is measured.  The samplers pop_properties,
+  additive_variance, and selected_mut_tracker are then timed on the evolved
+  quantitative trait population.
+
+  Output is tab-separated, one line per measurement, with a header line.
+  Times are in seconds per call and are the mean over the timed calls.
+  The generation benchmarks evolve all timed generations in one call, so
+  that setup done once per call is not counted as part of a generation,
+  and report the mean per generation.  allocs is the mean number of calls
+  to operator new per call (or generation), and rss_kb is the resident set
+  size after the timed calls.
+
+  Usage: bench_generation [-N 1000,10000] [-m 0.001,0.01] [-r 0.001,0.01]
+                          [-b burnin] [-g timed generations] [-t 1,4]
+                          [-s seed]
+
+  -m is the total mutation rate.  10% of new mutations are selected.
+  -t is a list of numbers of threads per replicate for the quantitative
+  trait model (see evolve_regions_qtrait).  Each is timed from the same
+  burned-in population.  The default is 1 and the number of hardware
+  threads (at least 2), so that fwdpp's sample_diploid and
+  fwdpy::parallel_sample_diploid are both reported.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <fwdpp/extensions/callbacks.hpp>
+#include <fwdpp/extensions/regions.hpp>
+#include <fwdpp/fitness_models.hpp>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "evolve_regions_sampler.hpp"
+#include "fwdpy_fitness.hpp"
+#include "internal_callbacks.hpp"
+#include "qtrait_evolve.hpp"
+#include "qtrait_evolve_rules.hpp"
+#include "sampler_additive_variance.hpp"
+#include "sampler_no_sampling.hpp"
+#include "sampler_pop_properties.hpp"
+#include "sampler_selected_mut_tracker.hpp"
+#include "types.hpp"
+
+using namespace fwdpy;
+
+namespace
+{
+    std::atomic<unsigned long long> nallocs(0);
+}
+
+// Count heap allocations.  The array forms and nothrow forms of operator new
+// call these.
+void *
+operator new(std::size_t n)
+{
+    ++nallocs;
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+
+    struct timing
+    {
+        bench_clock::duration elapsed;
+        unsigned long long allocs;
+    };
+
+    long
+    rss_kb()
+    // Current resident set size from /proc (Linux), or -1.
+    {
+        std::ifstream statm("/proc/self/statm");
+        long pages_total, pages_resident;
+        if (!(statm >> pages_total >> pages_resident))
+            return -1;
+        return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    struct params
+    {
+        std::vector<unsigned> N;
+        std::vector<double> mu, r;
+        std::vector<unsigned> nthreads;
+        unsigned burnin, generations;
+        unsigned long seed;
+        params()
+            : N{ 1000, 10000 }, mu{ 0.001, 0.01 }, r{ 0.001, 0.01 },
+              nthreads{ 1, std::max(2u, std::thread::hardware_concurrency()) },
+              burnin(100), generations(10), seed(42)
+        {
+        }
+    };
+
+    template <typename T>
+    std::vector<T>
+    parse_list(const char *arg)
+    {
+        std::vector<T> rv;
+        std::istringstream in(arg);
+        std::string item;
+        while (std::getline(in, item, ','))
+            {
+                std::istringstream itemstream(item);
+                T t;
+                if (!(itemstream >> t))
+                    throw std::invalid_argument("bad list element: " + item);
+                rv.push_back(t);
+            }
+        return rv;
+    }
+
+    // Regions used for all models: mutation and recombination are uniform
+    // on [0,1).
+    KTfwd::extensions::discrete_mut_model
+    make_mut_model(const double esize_sd)
+    {
+        std::vector<KTfwd::extensions::shmodel> callbacks(1);
+        internal::make_gaussian_s(&callbacks[0], esize_sd);
+        internal::make_constant_h(&callbacks[0], 1.0);
+        const std::vector<double> beg(1, 0.), end(1, 1.), weight(1, 1.);
+        return KTfwd::extensions::discrete_mut_model(beg, end, weight, beg, end,
+                                                     weight, callbacks);
+    }
+
+    KTfwd::extensions::discrete_rec_model
+    make_rec_model()
+    {
+        const std::vector<double> beg(1, 0.), end(1, 1.), weight(1, 1.);
+        return KTfwd::extensions::discrete_rec_model(beg, end, weight);
+    }
+
+    std::unique_ptr<singlepop_fitness>
+    additive_fitness(const double offset)
+    // Additive over 1, 1+sh, 1+2s.  offset is subtracted, so 1. gives a trait
+    // value.
+    {
+        return std::unique_ptr<singlepop_fitness>(
+            new singlepop_fitness(single_region_fitness_fxn(
+                [offset](const diploid_t &dip, const gcont_t &gametes,
+                         const mcont_t &mutations) {
+                    return KTfwd::additive_diploid()(
+                               gametes[dip.first], gametes[dip.second],
+                               mutations, 2.)
+                           - offset;
+                })));
+    }
+
+    void
+    report(const std::string &what, const unsigned N, const double mu,
+           const double r, const unsigned nthreads, const unsigned ncalls,
+           const timing &t)
+    {
+        const double seconds
+            = std::chrono::duration<double>(t.elapsed).count() / double(ncalls);
+        std::cout << what << '\t' << N << '\t' << mu << '\t' << r << '\t'
+                  << nthreads << '\t' << ncalls << '\t' << seconds << '\t'
+                  << double(t.allocs) / double(ncalls) << '\t' << rss_kb()
+                  << std::endl;
+    }
+
+    template <typename F>
+    timing
+    time_calls(const unsigned ncalls, const F &f)
+    {
+        const auto a = nallocs.load();
+        const auto start = bench_clock::now();
+        for (unsigned i = 0; i < ncalls; ++i)
+            f();
+        return timing{ bench_clock::now() - start, nallocs.load() - a };
+    }
+
+    void
+    bench_wf(const params &p, const unsigned N, const double mu,
+             const double r)
+    {
+        singlepop_t pop(N);
+        auto fitness = additive_fitness(0.);
+        no_sampling s;
+        const std::vector<unsigned> Nvector(p.burnin, N);
+        unsigned long seed = p.seed;
+        auto evolve = [&](const unsigned *Nv, const std::size_t len) {
+            evolve_regions_sampler_cpp_details(
+                &pop, seed++, Nv, len, 0.9 * mu, 0.1 * mu, r, 0., fitness, 0,
+                make_mut_model(0.01), make_rec_model(), s, wf_rules());
+        };
+        if (p.burnin)
+            evolve(Nvector.data(), Nvector.size());
+        const std::vector<unsigned> timed(p.generations, N);
+        report("wf_generation", N, mu, r, 1, p.generations,
+               time_calls(1, [&]() { evolve(timed.data(), timed.size()); }));
+    }
+
+    void
+    bench_qtrait(const params &p, const unsigned N, const double mu,
+                 const double r)
+    {
+        const double sigE = 1., optimum = 0., VS = 1.;
+        singlepop_t pop(N);
+        auto fitness = additive_fitness(1.);
+        no_sampling s;
+        const std::vector<unsigned> Nvector(p.burnin, N);
+        unsigned long seed = p.seed;
+        auto evolve = [&](const unsigned *Nv, const std::size_t len,
+                          const unsigned nthreads) {
+            qtrait::evolve_regions_qtrait_sampler_cpp_details(
+                &pop, seed++, Nv, len, 0.9 * mu, 0.1 * mu, r, 0., sigE,
+                optimum, VS, fitness, 0, make_mut_model(0.25),
+                make_rec_model(), s,
+                qtrait::qtrait_model_rules(sigE, optimum, VS, N), nthreads,
+                p.seed, 0);
+        };
+        if (p.burnin)
+            evolve(Nvector.data(), Nvector.size(), 1);
+        const singlepop_t burned_in(pop);
+        const std::vector<unsigned> timed(p.generations, N);
+        for (const auto nthreads : p.nthreads)
+            {
+                pop = burned_in;
+                report("qtrait_generation", N, mu, r, nthreads, p.generations,
+                       time_calls(1, [&]() {
+                           evolve(timed.data(), timed.size(), nthreads);
+                       }));
+            }
+
+        pop_properties pp(optimum);
+        report("pop_properties", N, mu, r, 1, p.generations,
+               time_calls(p.generations,
+                          [&]() { pp(&pop, pop.generation); }));
+        additive_variance av;
+        report("additive_variance", N, mu, r, 1, p.generations,
+               time_calls(p.generations,
+                          [&]() { av(&pop, pop.generation); }));
+        selected_mut_tracker smt;
+        report("selected_mut_tracker", N, mu, r, 1, p.generations,
+               time_calls(p.generations,
+                          [&]() { smt(&pop, pop.generation); }));
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    params p;
+    int c;
+    try
+        {
+            while ((c = getopt(argc, argv, "N:m:r:b:g:t:s:")) != -1)
+                {
+                    switch (c)
+                        {
+                        case 'N':
+                            p.N = parse_list<unsigned>(optarg);
+                            break;
+                        case 'm':
+                            p.mu = parse_list<double>(optarg);
+                            break;
+                        case 'r':
+                            p.r = parse_list<double>(optarg);
+                            break;
+                        case 'b':
+                            p.burnin = unsigned(std::atoi(optarg));
+                            break;
+                        case 'g':
+                            p.generations = unsigned(std::atoi(optarg));
+                            break;
+                        case 't':
+                            p.nthreads = parse_list<unsigned>(optarg);
+                            break;
+                        case 's':
+                            p.seed = std::strtoul(optarg, nullptr, 10);
+                            break;
+                        default:
+                            std::cerr << "usage: " << argv[0]
+                                      << " [-N list] [-m list] [-r list] [-b "
+                                         "burnin] [-g generations] [-t "
+                                         "list] [-s seed]\n";
+                            return 1;
+                        }
+                }
+            if (!p.generations || p.nthreads.empty()
+                || std::find(p.nthreads.begin(), p.nthreads.end(), 0u)
+                       != p.nthreads.end())
+                throw std::invalid_argument(
+                    "generations and threads must be > 0");
+
+            std::cout << "benchmark\tN\tmu\tr\tnthreads\tcalls\tseconds\t"
+                         "allocs\trss_kb"
+                      << std::endl;
+            for (const auto N : p.N)
+                {
+                    for (const auto mu : p.mu)
+                        {
+                            for (const auto r : p.r)
+                                {
+                                    bench_wf(p, N, mu, r);
+                                    bench_qtrait(p, N, mu, r);
+                                }
+                        }
+                }
+        }
+    catch (std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    return 0;
+}
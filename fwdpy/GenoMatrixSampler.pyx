@@ -130,3 +130,25 @@ cdef class GenoMatrixSampler(TemporalSampler):
         to len(self.vec)-1.  The output file is gzipped.
         """
         self.tofile_details(stub,repstart,keep_origin)
+    cdef void toplink_details_task(self,const geno_matrix_final_t & f,cppstring stub,int repid) except *:
+        cdef vector[pair[uint,geno_matrix_ptr]].const_iterator beg,end
+        beg=f.const_begin()
+        end=f.const_end()
+        while beg<end:
+            write_geno_matrix_plink(deref(beg).second.get(),deref(beg).first,stub,repid)
+            beg+=1
+    def toplink(self,stub,repstart=0):
+        """
+        Write matrices to files in PLINK binary format.
+
+        :param stub: Base name for output files
+        :param repstart: Initial integer for output file names
+
+        For each matrix, three files are written: stub.generationX.repY.bed, .bim, and .fam,
+        where X and Y are as in :func:`tofile`.  Genotypes take 2 bits each, with the derived allele as A1.
+        The .fam phenotype is the genetic value.  Variant j (counting from 1) is given the ID mj.
+        """
+        cdef cppstring s = stub
+        cdef int task
+        for task in range(self.vec.size()):
+            self.toplink_details_task((<geno_matrix_sampler_t*>self.vec[task].get()).f,s,repstart+task)
@@ -37,3 +37,93 @@ def add_mutation(PopType p,
     else:
         raise RuntimeError("PopType not supported")
 
+
+def add_mutations(PopType p, pos, s, h, haplotypes, locus_boundaries = None):
+    """
+    Add many mutations to a population at once.
+
+    :param p: A :class:`fwdpy.fwdpy.Spop` or :class:`fwdpy.fwdpy.MlocusPop`.
+    :param pos: The positions of the new mutations
+    :param s: The selection coefficients/effect sizes of the new mutations
+    :param h: The dominance coefficients of the new mutations
+    :param haplotypes: A 2N x len(pos) matrix of 0/1 values. Rows 2i and 2i+1 are the first and second chromosomes of individual i. Element (r,j) is 1 if chromosome r carries mutation j.
+    :param locus_boundaries: For a :class:`fwdpy.fwdpy.MlocusPop`, a list of [beg,end) tuples, one per locus.  Each mutation is added to the locus containing its position.
+
+    :return: The keys of the new mutations, in the order of pos.
+
+    New mutations are added to whatever each chromosome already carries.  Chromosomes that end up with the same
+    contents share one gamete, and mutation counts are updated once for the whole table.
+
+    .. note:: RuntimeError will be thrown if any position already exists in p or occurs twice in pos.  ValueError will be thrown if the input does not have the right shape, if haplotypes contains values other than 0 and 1, or if a mutation is not present on any chromosome.  In each case, p is not modified.
+
+    Example:
+
+    >>> import fwdpy as fp
+    >>> import numpy as np
+    >>> p = fp.SpopVec(1,2)
+    >>> hap = np.array([[1,0],[0,0],[1,1],[0,1]],dtype=np.uint8)
+    >>> fp.add_mutations(p[0],[0.1,0.2],[0.0,-0.1],[1.0,1.0],hap)
+    [0, 1]
+    """
+    cdef unsigned char[:,::1] hap = np.ascontiguousarray(haplotypes,dtype=np.uint8)
+    cdef vector[double] vpos = pos
+    cdef vector[double] vs = s
+    cdef vector[double] vh = h
+    cdef vector[pair[double,double]] vlb
+    if hap.shape[1] != vpos.size():
+        raise ValueError("haplotypes must have one column per mutation")
+    if isinstance(p,Spop):
+        if hap.shape[0] != 2*(<Spop>p).pop.get().diploids.size():
+            raise ValueError("haplotypes must have two rows per diploid")
+        if vpos.empty():
+            return []
+        return add_mutations_cpp((<Spop>p).pop.get(),vpos,vs,vh,<uint8_t*>&hap[0,0])
+    elif isinstance(p,MlocusPop):
+        if locus_boundaries is None:
+            raise ValueError("locus_boundaries is required for MlocusPop")
+        vlb = locus_boundaries
+        if hap.shape[0] != 2*(<MlocusPop>p).pop.get().diploids.size():
+            raise ValueError("haplotypes must have two rows per diploid")
+        if vpos.empty():
+            return []
+        return add_mutations_cpp((<MlocusPop>p).pop.get(),vpos,vs,vh,<uint8_t*>&hap[0,0],vlb)
+    else:
+        raise RuntimeError("PopType not supported")
+
+def init_from_ms(PopType p, filename, size_t rep = 0, beg = 0.0, end = 1.0, locus_boundaries = None):
+    """
+    Initialize a population from the output of a coalescent simulation, such as ms, instead of by forward
+    simulation.
+
+    :param p: A :class:`fwdpy.fwdpy.Spop` or :class:`fwdpy.fwdpy.MlocusPop` with no mutations.
+    :param filename: A file in ms output format.
+    :param rep: The replicate in filename to use, counting from 0.
+    :param beg: For a :class:`fwdpy.fwdpy.Spop`, ms positions are mapped from [0,1) onto [beg,end).
+    :param end: See beg.
+    :param locus_boundaries: For a :class:`fwdpy.fwdpy.MlocusPop`, a list of [beg,end) tuples, one per locus.  Replicates rep, rep+1, etc., are used for the first, second, etc., locus.
+
+    :return: The number of mutations added.
+
+    Each replicate must contain 2N haplotypes.  Haplotypes 2i and 2i+1 become the two chromosomes of individual i.
+    All mutations are neutral, with an origin time of the population's current generation.  Positions that are equal
+    in the ms output are moved apart by the smallest representable amount.
+
+    Example:
+
+    >>> import fwdpy as fp
+    >>> #ms 2000 4 -t 100 > ms.out
+    >>> pops = fp.SpopVec(4,1000)
+    >>> for i,p in enumerate(pops):
+    ...     fp.init_from_ms(p,'ms.out',rep=i) # doctest: +SKIP
+    """
+    cdef vector[pair[double,double]] vlb
+    cdef string fn = filename
+    if isinstance(p,Spop):
+        return init_from_ms_cpp((<Spop>p).pop.get(),fn,rep,beg,end)
+    elif isinstance(p,MlocusPop):
+        if locus_boundaries is None:
+            raise ValueError("locus_boundaries is required for MlocusPop")
+        vlb = locus_boundaries
+        return init_from_ms_cpp((<MlocusPop>p).pop.get(),fn,rep,vlb)
+    else:
+        raise RuntimeError("PopType not supported")
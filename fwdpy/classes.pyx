@@ -32,6 +32,22 @@ cdef class Spop(PopType):
 
         """
         return self.pop.get().sane()
+    def profile(self):
+        """
+        Returns a dict of timings and counters recorded while evolving this population.
+
+        Times are wall-clock seconds spent sampling offspring ('sample_diploid'), computing
+        fitness ('fitness', which is a subset of 'sample_diploid'), updating mutation
+        counts ('update_mutations'), and in temporal samplers ('sampler').  The counters
+        are the numbers of generations, new mutations, crossovers, recycled mutation and gamete
+        slots, newly-allocated gametes, sampler calls, and gametes removed by merging identical gametes
+        ('merged_gametes').  'gametes_before_dedup' and 'gametes_after_dedup' are the numbers of extant
+        gametes before and after each merge.  All values are summed over generations.
+
+        .. note:: Values are only recorded if fwdpy was built with 'python setup.py build_ext --profile'.  Otherwise, 'enabled' is False and all values are zero,
+           except for the three counts from merging gametes, which are always recorded.
+        """
+        return self.pop.get().profile
 
 cdef class SpopGenMut(PopType):
     """
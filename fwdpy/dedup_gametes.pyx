@@ -0,0 +1,35 @@
+def dedup_gametes(PopType p):
+    """
+    Merge gametes that carry identical mutations.
+
+    Recombination and mutation can make new gametes with the same contents as existing ones.
+    Merging them frees gamete slots for reuse and reduces the work done by functions that
+    loop over gametes.  The population's genotypes are unchanged.
+
+    :param p: A :class:`fwdpy.fwdpy.Spop`, :class:`fwdpy.fwdpy.MlocusPop`, or :class:`fwdpy.fwdpy.MetaPop`
+
+    :return: A dict with the number of extant gametes 'before' and 'after' merging.
+
+    .. note:: Merging can also be done periodically during evolution. See :func:`fwdpy.fwdpy.EventTimeline.gamete_dedup_interval`.
+
+    Example:
+
+    >>> import fwdpy as fp
+    >>> import numpy as np
+    >>> p = fp.SpopVec(1,2)
+    >>> hap = np.array([[1,0],[0,0],[1,0],[0,1]],dtype=np.uint8)
+    >>> keys = fp.add_mutations(p[0],[0.1,0.2],[0.0,0.0],[1.0,1.0],hap)
+    >>> d = fp.dedup_gametes(p[0])
+    >>> d['before'], d['after']
+    (3, 3)
+    """
+    cdef gamete_dedup_result rv
+    if isinstance(p,Spop):
+        rv = dedup_gametes_cpp(deref((<Spop>p).pop.get()))
+    elif isinstance(p,MlocusPop):
+        rv = dedup_gametes_cpp(deref((<MlocusPop>p).pop.get()))
+    elif isinstance(p,MetaPop):
+        rv = dedup_gametes_cpp(deref((<MetaPop>p).mpop.get()))
+    else:
+        raise RuntimeError("fwdpy.dedup_gametes: PopType "+str(type(p))+" is not supported")
+    return rv
@@ -0,0 +1,100 @@
+cdef class EventTimeline(object):
+    """
+    Changes to simulation parameters at given generations, applied during evolution.
+
+    An event for generation g takes effect when offspring are generated from the
+    population at generation g.  If a population has already evolved past g, the
+    event is applied before the first generation.  Events in the same generation
+    are applied in the order they were added.
+
+    A timeline can be passed to :func:`fwdpy.fwdpy.evolve_regions_sampler`,
+    :func:`fwdpy.fwdpy.evolve_regions_sampler_fitness`, and the corresponding functions
+    in :mod:`fwdpy.qtrait`.  The same timeline is applied to each replicate.
+
+    Example:
+
+    .. testcode::
+
+        import fwdpy
+        t = fwdpy.EventTimeline()
+        #Bottleneck at generation 100, then recovery:
+        t.popsize(100,100)
+        t.popsize(150,1000)
+        #Stop sampling at generation 200:
+        t.sampling_interval(200,0)
+
+    .. note:: Deme splits, merges, and admixture are not events, because there is no multi-deme evolve function.
+    """
+    cdef const event_timeline * get(self):
+        return &self.tl
+    def __len__(self):
+        return self.tl.size()
+    def popsize(self,unsigned generation,unsigned N):
+        """
+        Set the number of diploids.  This replaces the sizes given by nlist from
+        generation onwards.
+
+        :raises: ValueError if N is 0.
+        """
+        self.tl.add(generation,EVENT_POPSIZE,N)
+    def neutral_mutation_rate(self,unsigned generation,double mu):
+        """
+        Set the mutation rate to neutral variants.
+
+        :raises: ValueError if mu is negative or not finite.
+        """
+        self.tl.add(generation,EVENT_MU_NEUTRAL,mu)
+    def selected_mutation_rate(self,unsigned generation,double mu):
+        """
+        Set the mutation rate to selected variants.
+
+        :raises: ValueError if mu is negative or not finite.
+        """
+        self.tl.add(generation,EVENT_MU_SELECTED,mu)
+    def recombination_rate(self,unsigned generation,double recrate):
+        """
+        Set the recombination rate.
+
+        :raises: ValueError if recrate is negative or not finite.
+        """
+        self.tl.add(generation,EVENT_RECRATE,recrate)
+    def selfing(self,unsigned generation,double f):
+        """
+        Set the selfing probability.
+
+        :raises: ValueError unless 0 <= f <= 1.
+        """
+        self.tl.add(generation,EVENT_SELFING,f)
+    def sampling_interval(self,unsigned generation,unsigned interval):
+        """
+        Set how often the temporal sampler is applied.  0 turns it off.
+        """
+        self.tl.add(generation,EVENT_SAMPLING_INTERVAL,interval)
+    def gamete_dedup_interval(self,unsigned generation,unsigned interval):
+        """
+        Merge identical gametes every interval generations.  0, the default, turns merging off.
+        The numbers of gametes before and after merging are recorded in the populations' profiles,
+        whether or not fwdpy was built with profiling.
+
+        See :func:`fwdpy.fwdpy.dedup_gametes`.
+        """
+        self.tl.add(generation,EVENT_GAMETE_DEDUP_INTERVAL,interval)
+    def optimum(self,unsigned generation,double optimum):
+        """
+        Set the optimum trait value.  Only valid for quantitative trait simulations.
+        """
+        self.tl.add(generation,EVENT_OPTIMUM,optimum)
+    def VS(self,unsigned generation,double VS):
+        """
+        Set the strength of stabilizing selection.  Only valid for quantitative trait simulations.
+
+        :raises: ValueError if VS <= 0.
+        """
+        self.tl.add(generation,EVENT_VS,VS)
+    def sigmaE(self,unsigned generation,double sigmaE):
+        """
+        Set the standard deviation of the random component of trait values.  Only valid for quantitative trait simulations.
+
+        :raises: ValueError if sigmaE is negative.
+        """
+        self.tl.add(generation,EVENT_SIGMAE,sigmaE)
@@ -165,7 +165,9 @@ def evolve_regions_sampler(GSLrng rng,
                            int sample,
                            double f = 0,
                            double scaling = 2.0,
-                           const char * fitness = "multiplicative"):
+                           const char * fitness = "multiplicative",
+                           EventTimeline timeline = None,
+                           StopCondition stop = None):
     """
     Evolve a single population under standard population genetic fitness models and apply a "sampler" at regular intervals.
     
@@ -183,6 +185,8 @@ def evolve_regions_sampler(GSLrng rng,
     :param f: The selfing probabilty
     :param scaling: For a single mutation, fitness is calculated as 1, 1+sh, and 1+scaling*s for genotypes AA, Aa, and aa, respectively.
     :param fitness: The fitness model.  Must be either "multiplicative" or "additive".
+    :param timeline: (None) An :class:`EventTimeline` of changes to parameters during the simulation.
+    :param stop: (None) A :class:`StopCondition`.  Each replicate stops evolving when its condition is met.
     """
 
     if fitness == b'multiplicative':
@@ -190,13 +194,13 @@ def evolve_regions_sampler(GSLrng rng,
         evolve_regions_sampler_fitness(rng,pops,slist,ffm,nlist,
                                        mu_neutral,mu_selected,recrate,
                                        nregions,sregions,recregions,
-                                       sample,f)
+                                       sample,f,timeline,stop)
     elif fitness == b'additive':
         ffa = SpopAdditive(scaling)
         evolve_regions_sampler_fitness(rng,pops,slist,ffa,nlist,
                                        mu_neutral,mu_selected,recrate,
                                        nregions,sregions,recregions,
-                                       sample,f)
+                                       sample,f,timeline,stop)
 
     else:
         raise RuntimeError("fitness must be either multiplicative or additive")
@@ -214,7 +218,9 @@ def evolve_regions_sampler_fitness(GSLrng rng,
                                    list sregions,
                                    list recregions,
                                    int sample,
-                                   double f = 0):
+                                   double f = 0,
+                                   EventTimeline timeline = None,
+                                   StopCondition stop = None):
     """
     Evolve a single population under arbitrary fitness models and apply a "sampler" at regular intervals.
     
@@ -231,6 +237,8 @@ def evolve_regions_sampler_fitness(GSLrng rng,
     :param recregions: A list specifying how the genetic map varies along the region
     :param sample: Apply the temporal sampler every 'sample' generations during the simulation. 0 means it will never get applied, which may or may not be what you want.
     :param f: The selfing probabilty
+    :param timeline: (None) An :class:`EventTimeline` of changes to parameters during the simulation.
+    :param stop: (None) A :class:`StopCondition`.  Each replicate stops evolving when its condition is met.
     """
     check_input_params(mu_neutral,mu_selected,recrate,nregions,sregions,recregions)
     if sample < 0:
@@ -241,5 +249,108 @@ def evolve_regions_sampler_fitness(GSLrng rng,
     rmgr = region_manager_wrapper()
     internal.make_region_manager(rmgr,nregions,sregions,recregions)
     cdef size_t listlen = len(nlist)
+    cdef const event_timeline * tptr = NULL
+    if timeline is not None:
+        tptr = timeline.get()
+    cdef vector[unique_ptr[stop_condition]] * sptr = NULL
+    if stop is not None:
+        sptr = &stop.vec
     evolve_regions_sampler_cpp(rng.thisptr,pops.pops,
-                               slist.vec,&nlist[0],listlen,mu_neutral,mu_selected,recrate,f,sample,rmgr.thisptr,deref(fitness_function.wfxn.get()))
+                               slist.vec,&nlist[0],listlen,mu_neutral,mu_selected,recrate,f,sample,rmgr.thisptr,deref(fitness_function.wfxn.get()),tptr,sptr)
+
+@cython.boundscheck(False)
+def evolve_regions_until(GSLrng rng,
+                         SpopVec pops,
+                         unsigned[:] nlist,
+                         double mu_neutral,
+                         double mu_selected,
+                         double recrate,
+                         list nregions,
+                         list sregions,
+                         list recregions,
+                         StopCondition restart,
+                         unsigned max_attempts = 1000,
+                         checkpoint_generation = None,
+                         double f = 0,
+                         double scaling = 2.0,
+                         const char * fitness = "multiplicative",
+                         EventTimeline timeline = None,
+                         StopCondition stop = None):
+    """
+    Evolve populations, starting each replicate over whenever a condition is met.
+
+    Each replicate is evolved to checkpoint_generation, and its state, including that of its random
+    number generator, is copied in memory.  When restart is met, the replicate is rolled back to that
+    copy and evolved again, with new random numbers, until an attempt runs to the end of nlist (or
+    stop is met) or max_attempts is reached.  The random numbers used by an attempt depend only on the
+    checkpoint and the attempt number.  This is useful for
+    conditioning on the fate of a mutation, e.g. restarting whenever a sweeping mutation is lost.
+
+    :param rng: a :class:`GSLrng`
+    :param pops: a :class:`SpopVec`
+    :param nlist: An array view of a NumPy array.  This represents the population sizes over time.  The length of this view is the length of the simulation in generations. The view must be of an array of 32 bit, unsigned integers.
+    :param mu_neutral: The mutation rate to variants not affecting fitness ("neutral" mutations).  The unit is per gamete, per generation.
+    :param mu_selected: The mutation rate to variants affecting fitness ("selected" mutations).  The unit is per gamete, per generation.
+    :param recrate: The recombination rate in the regions (per diploid, per generation)
+    :param nregions: A list specifying where neutral mutations occur
+    :param sregions: A list specifying where selected mutations occur
+    :param recregions: A list specifying how the genetic map varies along the region
+    :param restart: A :class:`StopCondition`.  An attempt that meets it is discarded.
+    :param max_attempts: The maximum number of attempts per replicate.
+    :param checkpoint_generation: (None) The generation at which to copy each replicate.  None means each replicate's current generation.  Must be before the end of nlist.
+    :param f: The selfing probabilty
+    :param scaling: For a single mutation, fitness is calculated as 1, 1+sh, and 1+scaling*s for genotypes AA, Aa, and aa, respectively.
+    :param fitness: The fitness model.  Must be either "multiplicative" or "additive".
+    :param timeline: (None) An :class:`EventTimeline` of changes to parameters during the simulation.
+    :param stop: (None) A :class:`StopCondition`.  An attempt that meets it ends successfully.
+
+    :return: A list of the number of attempts made for each replicate.  This is 0 for replicates for which stop is met before checkpoint_generation.
+
+    :raises: RuntimeError if parameters do not pass checks
+
+    .. note:: If the last attempt is also discarded, the replicate is left in the checkpointed state, and restart.get() reports the generation at which restart was met.
+
+    Example:
+
+    >>> import fwdpy
+    >>> import numpy as np
+    >>> rng = fwdpy.GSLrng(100)
+    >>> pops = fwdpy.SpopVec(1,1000)
+    >>> # A beneficial mutation on one chromosome
+    >>> hap = np.zeros((2000,1),dtype=np.uint8)
+    >>> hap[0,0] = 1
+    >>> keys = fwdpy.add_mutations(pops[0],[0.5],[0.1],[1.0],hap)
+    >>> popsizes = np.array([1000]*1000,dtype=np.uint32)
+    >>> attempts = fwdpy.evolve_regions_until(rng,pops,popsizes[0:],0.,0.,0.001,[],[],[fwdpy.Region(0,1,1)],
+    ...                                       fwdpy.TrackedMutationStop(1,0.5,"lost"),
+    ...                                       stop=fwdpy.TrackedMutationStop(1,0.5,"fixed"))
+    """
+    check_input_params(mu_neutral,mu_selected,recrate,nregions,sregions,recregions)
+    if f < 0.:
+        warnings.warn("f < 0 will be treated as 0")
+        f=0
+    cdef SpopFitness fitness_function
+    if fitness == b'multiplicative':
+        fitness_function = SpopMult(scaling)
+    elif fitness == b'additive':
+        fitness_function = SpopAdditive(scaling)
+    else:
+        raise RuntimeError("fitness must be either multiplicative or additive")
+    rmgr = region_manager_wrapper()
+    internal.make_region_manager(rmgr,nregions,sregions,recregions)
+    cdef size_t listlen = len(nlist)
+    cdef const event_timeline * tptr = NULL
+    if timeline is not None:
+        tptr = timeline.get()
+    cdef vector[unique_ptr[stop_condition]] * sptr = NULL
+    if stop is not None:
+        sptr = &stop.vec
+    cdef vector[unsigned] cgens
+    cdef size_t i = 0
+    for i in range(pops.pops.size()):
+        if checkpoint_generation is None:
+            cgens.push_back(pops.pops[i].get().generation)
+        else:
+            cgens.push_back(checkpoint_generation)
+    return evolve_regions_until_cpp(rng.thisptr,pops.pops,&nlist[0],listlen,mu_neutral,mu_selected,recrate,f,
+                                    rmgr.thisptr,deref(fitness_function.wfxn.get()),cgens,restart.vec,max_attempts,tptr,sptr)
@@ -4,13 +4,15 @@ from libcpp.string cimport string
 from libcpp.memory cimport shared_ptr,unique_ptr
 
 from libcpp.map cimport map
+from libcpp cimport bool as cpp_bool
+from libc.stdint cimport uint8_t,uint16_t,uint32_t,uint64_t,int64_t
 
 from fwdpy.internal.internal cimport *
-from fwdpy.fwdpp cimport popgenmut,gamete_base
+from fwdpy.fwdpp cimport popgenmut,gamete_base,sample_t
 from fwdpy.cpp cimport hash
 from libcpp.unordered_set cimport unordered_set
 from cython_gsl cimport gsl_rng
-from fwdpy.structs cimport selected_mut_data,selected_mut_data_tidy,qtrait_stats_cython,allele_age_data_t,haplotype_matrix,VAcum,popsample_details
+from fwdpy.structs cimport gamete_dedup_result,selected_mut_data,selected_mut_data_tidy,qtrait_stats_cython,allele_age_data_t,haplotype_matrix,VAcum,popsample_details,evolve_profile,windowed_stats_data,sfs_data,ld_data
 from fwdpy.fitness cimport singlepop_fitness
 
 ##Create hooks to C++ types
@@ -41,13 +43,15 @@ cdef extern from "types.hpp" namespace "fwdpy" nogil:
         mcont_t fixations
         ucont_t fixation_times
         lookup_t mut_lookup
+        evolve_profile profile
         unsigned gen()
         unsigned popsize()
         int sane()
         string serialize() const
         void deserialize(const string &)
         int tofile(const char *,bint)
-        void fromfile(const char *,size_t)
+        int64_t tofile_bgzf(const char *,bint,unsigned) except +
+        void fromfile(const char *,size_t,unsigned) except +
 
     cdef cppclass metapop_t:
         metapop_t(ucont_t)
@@ -67,7 +71,8 @@ cdef extern from "types.hpp" namespace "fwdpy" nogil:
         string serialize() const
         void deserialize(const string &)
         int tofile(const char *,bint)
-        void fromfile(const char *,size_t)
+        int64_t tofile_bgzf(const char *,bint,unsigned) except +
+        void fromfile(const char *,size_t,unsigned) except +
 
     cdef cppclass multilocus_t:
         multilocus_t(unsigned,unsigned)
@@ -88,7 +93,8 @@ cdef extern from "types.hpp" namespace "fwdpy" nogil:
         string serialize() const
         void deserialize(const string &)
         int tofile(const char *,bint)
-        void fromfile(const char *,size_t)
+        int64_t tofile_bgzf(const char *,bint,unsigned) except +
+        void fromfile(const char *,size_t,unsigned) except +
 
     # Types based around KTfwd::generalmut_vec
     ctypedef vector[generalmut_vec] mlist_gm_vec_t
@@ -110,7 +116,8 @@ cdef extern from "types.hpp" namespace "fwdpy" nogil:
         string serialize() const
         void deserialize(const string &)
         int tofile(const char *,bint)
-        void fromfile(const char *,size_t)
+        int64_t tofile_bgzf(const char *,bint,unsigned) except +
+        void fromfile(const char *,size_t,unsigned) except +
 
     cdef cppclass GSLrng_t:
         GSLrng_t(unsigned)
@@ -242,7 +249,7 @@ cdef extern from "sampler_base.hpp" namespace "fwdpy" nogil:
         void register_callback(void(*)(FINALT &,DATAT &))
                           
     void apply_sampler_cpp[T](const vector[shared_ptr[T]] & popvec,
-			      const vector[unique_ptr[sampler_base]] & samplers)
+			      const vector[unique_ptr[sampler_base]] & samplers) except +
 
 cdef extern from "sampler_no_sampling.hpp" namespace "fwdpy" nogil:
     cdef cppclass no_sampling(sampler_base):
@@ -258,7 +265,55 @@ cdef extern from "sampler_additive_variance.hpp" namespace "fwdpy" nogil:
         additive_variance()
         vector[VAcum] final()
 
+cdef extern from "packed_haplotype_matrix.hpp" namespace "fwdpy" nogil:
+    cdef cppclass packed_haplotype_matrix:
+        vector[uint64_t] n
+        vector[uint64_t] s
+        vector[double] np
+        vector[double] nf
+        vector[double] sp
+        vector[double] sf
+        vector[double] G
+        vector[double] E
+        vector[double] w
+        vector[double] esizes
+        vector[double] h
+        size_t nrow
+        size_t ncol_n
+        size_t ncol_s
+        size_t words_per_column
+    packed_haplotype_matrix make_packed_haplotype_matrix(const singlepop_t * pop, const vector[size_t] & diploids) except +
+    packed_haplotype_matrix make_packed_haplotype_matrix(const metapop_t * pop, const vector[size_t] & diploids,const size_t deme) except +
+    packed_haplotype_matrix make_packed_haplotype_matrix(const multilocus_t * pop, const vector[size_t] & diploids) except +
+
+cdef class PackedHapMatrix:
+    cdef unique_ptr[packed_haplotype_matrix] thisptr
+
+cdef class PackedBits:
+    cdef object owner
+    cdef vector[uint64_t] * bits
+    cdef Py_ssize_t shape[2]
+    cdef Py_ssize_t strides[2]
+
+cdef extern from "packed_sample.hpp" namespace "fwdpy" nogil:
+    cdef cppclass packed_sample:
+        vector[double] pos
+        vector[uint64_t] bits
+        unsigned nsam
+        size_t words_per_site
+        size_t size()
+        vector[unsigned] derived_counts()
+        sample_t to_strings()
+    ctypedef pair[packed_sample,packed_sample] packed_sep_sample_t
+    packed_sep_sample_t packed_sample_separate(const gsl_rng * r, const singlepop_t & pop, const unsigned nsam, const bint removeFixed) except +
+    vector[packed_sep_sample_t] packed_sample_separate(const gsl_rng * r, const multilocus_t & pop, const unsigned nsam, const bint removeFixed,
+            const vector[pair[double,double]] & locus_boundaries) except +
+
+cdef class PackedSample:
+    cdef packed_sample data
+
 ctypedef shared_ptr[vector[pair[sep_sample_t,popsample_details]]] popSampleData
+ctypedef shared_ptr[vector[pair[packed_sep_sample_t,popsample_details]]] packedPopSampleData
 
 cdef class PopSamples:
     cdef popSampleData thisptr
@@ -269,8 +324,27 @@ cdef extern from "sampler_sample_n.hpp" namespace "fwdpy" nogil:
         sample_n(unsigned, const gsl_rng * r,
                 const string & nfile,const string & sfile,
                 bint removeFixed, bint recordSamples, bint recordDetails,
-                const vector[pair[double,double]] & boundaries,const bint append)
+                const vector[pair[double,double]] & boundaries,const bint append,const bint packed,const bint binary)
         popSampleData final() const
+        void flush() except +
+        packedPopSampleData packed_final() const
+
+cdef extern from "sampler_windowed_stats.hpp" namespace "fwdpy" nogil:
+    cdef cppclass windowed_stats(sampler_base):
+        windowed_stats(const gsl_rng * r, const vector[pair[double,double]] & windows,
+                const unsigned nsam, const bint include_selected) except +
+        windowed_stats_data final() const
+
+cdef extern from "sampler_sfs.hpp" namespace "fwdpy" nogil:
+    cdef cppclass sfs_sampler(sampler_base):
+        sfs_sampler(const unsigned nsam, const bint by_label) except +
+        sfs_data final() const
+
+cdef extern from "sampler_ld.hpp" namespace "fwdpy" nogil:
+    cdef cppclass ld_sampler(sampler_base):
+        ld_sampler(const gsl_rng * r, const vector[double] & bin_edges, const unsigned nind,
+                const double minfreq, const bint selected_focal) except +
+        ld_data final() const
 
 #The following typedefs help us with the
 #frequency tracker API.
@@ -288,6 +362,10 @@ cdef extern from "sampler_selected_mut_tracker.hpp" namespace "fwdpy" nogil:
         selected_mut_tracker()
         freqTraj final() const
 
+cdef extern from "sampler_composite.hpp" namespace "fwdpy" nogil:
+    cdef cppclass composite_sampler(sampler_base):
+        composite_sampler(vector[sampler_base *] children)
+
 #Extension classes for temporal sampling
 cdef class TemporalSampler:
     """
@@ -304,7 +382,7 @@ cdef class QtraitStatsSampler(TemporalSampler):
     pass
 
 cdef class PopSampler(TemporalSampler):
-    pass
+    cdef bint packed
 
 cdef class VASampler(TemporalSampler):
     pass
@@ -312,6 +390,9 @@ cdef class VASampler(TemporalSampler):
 cdef class FreqSampler(TemporalSampler):
     pass
 
+cdef class CompositeSampler(TemporalSampler):
+    cdef list samplers
+
 
 
 
@@ -380,6 +461,65 @@ cdef extern from "allele_ages.hpp" namespace "fwdpy" nogil:
 
     freqTraj merge_trajectories_details( const freqTraj & traj1, const freqTraj & traj2 )
 
+cdef extern from "event_timeline.hpp" nogil:
+    cdef enum timeline_event_type "fwdpy::timeline_event_type":
+        EVENT_POPSIZE "fwdpy::timeline_event_type::popsize"
+        EVENT_MU_NEUTRAL "fwdpy::timeline_event_type::mu_neutral"
+        EVENT_MU_SELECTED "fwdpy::timeline_event_type::mu_selected"
+        EVENT_RECRATE "fwdpy::timeline_event_type::recrate"
+        EVENT_SELFING "fwdpy::timeline_event_type::selfing"
+        EVENT_SAMPLING_INTERVAL "fwdpy::timeline_event_type::sampling_interval"
+        EVENT_GAMETE_DEDUP_INTERVAL "fwdpy::timeline_event_type::gamete_dedup_interval"
+        EVENT_OPTIMUM "fwdpy::timeline_event_type::optimum"
+        EVENT_VS "fwdpy::timeline_event_type::VS"
+        EVENT_SIGMAE "fwdpy::timeline_event_type::sigmaE"
+
+    cdef cppclass event_timeline "fwdpy::event_timeline":
+        event_timeline()
+        void add(const unsigned generation, const timeline_event_type type, const double value) except +
+        size_t size()
+
+cdef extern from "gamete_dedup.hpp" namespace "fwdpy" nogil:
+    gamete_dedup_result dedup_gametes_cpp "fwdpy::dedup_gametes"(singlepop_t & pop)
+    gamete_dedup_result dedup_gametes_cpp "fwdpy::dedup_gametes"(multilocus_t & pop)
+    gamete_dedup_result dedup_gametes_cpp "fwdpy::dedup_gametes"(metapop_t & pop)
+
+cdef class EventTimeline(object):
+    cdef event_timeline tl
+    cdef const event_timeline * get(self)
+
+cdef extern from "stop_condition.hpp" namespace "fwdpy" nogil:
+    cdef cppclass stop_condition:
+        unsigned generation
+        bint stopped()
+    void clear_stop_conditions(vector[unique_ptr[stop_condition]] & v)
+    cdef cppclass tracked_mutation_stop(stop_condition):
+        tracked_mutation_stop(const double pos, const bint on_fixation, const bint on_loss) except +
+    cdef cppclass optimum_stop(stop_condition):
+        optimum_stop(const double optimum, const double epsilon) except +
+    cdef cppclass no_selected_sites_stop(stop_condition):
+        no_selected_sites_stop()
+    #To make a stop condition from a predicate written in Cython,
+    #push a custom_stop_condition on to StopCondition.vec
+    cdef cppclass custom_stop_condition(stop_condition):
+        custom_stop_condition(cpp_bool(*)(const singlepop_t *, const unsigned) nogil)
+
+cdef class StopCondition:
+    """
+    Base class for containers of conditions that end evolution early,
+    one per replicate.
+    """
+    cdef vector[unique_ptr[stop_condition]] vec
+
+cdef class TrackedMutationStop(StopCondition):
+    pass
+
+cdef class OptimumStop(StopCondition):
+    pass
+
+cdef class NoSelectedSitesStop(StopCondition):
+    pass
+
 ctypedef unsigned uint
 cdef extern from "evolve_regions_sampler.hpp" namespace "fwdpy" nogil:
     void evolve_regions_sampler_cpp( GSLrng_t * rng,
@@ -393,7 +533,24 @@ cdef extern from "evolve_regions_sampler.hpp" namespace "fwdpy" nogil:
 				     const double f,
 				     const int sample,
 				     const region_manager * rm,
-				     const singlepop_fitness & fitness) except +
+				     const singlepop_fitness & fitness,
+				     const event_timeline * timeline,
+				     vector[unique_ptr[stop_condition]] * stops) except +
+    vector[unsigned] evolve_regions_until_cpp(GSLrng_t * rng,
+                                              vector[shared_ptr[singlepop_t]] & pops,
+                                              const unsigned * Nvector,
+                                              const size_t Nvector_length,
+                                              const double mu_neutral,
+                                              const double mu_selected,
+                                              const double littler,
+                                              const double f,
+                                              const region_manager * rm,
+                                              const singlepop_fitness & fitness,
+                                              const vector[unsigned] & checkpoint_generations,
+                                              vector[unique_ptr[stop_condition]] & restarts,
+                                              const unsigned max_attempts,
+                                              const event_timeline * timeline,
+                                              vector[unique_ptr[stop_condition]] * stops) except +
 
 
 cdef extern from "sampling_wrappers.hpp" namespace "fwdpy" nogil:
@@ -410,6 +567,30 @@ cdef extern from "haplotype_matrix.hpp" namespace "fwdpy" nogil:
     haplotype_matrix make_haplotype_matrix(const multilocus_t * pop, const vector[size_t] & diploids) except +
     map[string,vector[size_t]] make_genotype_matrix(const haplotype_matrix & hm)
 
+cdef extern from "columnar_views.hpp" namespace "fwdpy" nogil:
+    cdef cppclass mutation_columns:
+        vector[double] pos,s,h
+        vector[unsigned] n,g
+        vector[char] neutral
+        vector[uint16_t] label
+        vector[size_t] key
+    cdef cppclass gamete_columns:
+        vector[unsigned] n
+        vector[size_t] neutral_offsets,selected_offsets
+        vector[uint32_t] neutral,selected
+        vector[size_t] key
+    cdef cppclass diploid_columns:
+        vector[uint32_t] first,second
+        vector[double] g,e,w
+        size_t nloci
+    cdef cppclass columnar_view:
+        mutation_columns mutations
+        gamete_columns gametes
+        diploid_columns diploids
+    columnar_view make_columnar_view(const singlepop_t * pop) except +
+    columnar_view make_columnar_view(const metapop_t * pop, const size_t deme) except +
+    columnar_view make_columnar_view(const multilocus_t * pop) except +
+
 cdef extern from "fwdpy_add_mutations.hpp" namespace "fwdpy" nogil:
     size_t add_mutation_cpp(singlepop_t * pop,
                             const vector[size_t] & indlist,
@@ -417,3 +598,18 @@ cdef extern from "fwdpy_add_mutations.hpp" namespace "fwdpy" nogil:
 			    const double pos,
 			    const double s,
 			    const double h) except +
+    vector[size_t] add_mutations_cpp(singlepop_t * pop,
+                                     const vector[double] & pos,
+                                     const vector[double] & s,
+                                     const vector[double] & h,
+                                     const uint8_t * haplotypes) except +
+    vector[size_t] add_mutations_cpp(multilocus_t * pop,
+                                     const vector[double] & pos,
+                                     const vector[double] & s,
+                                     const vector[double] & h,
+                                     const uint8_t * haplotypes,
+                                     const vector[pair[double,double]] & locus_boundaries) except +
+    size_t init_from_ms_cpp(singlepop_t * pop, const string & filename, const size_t rep,
+                            const double beg, const double end) except +
+    size_t init_from_ms_cpp(multilocus_t * pop, const string & filename, const size_t rep,
+                            const vector[pair[double,double]] & locus_boundaries) except +
@@ -8,6 +8,8 @@ import pandas
 
 include "classes.pyx"
 include "sampling.pyx"
+include "event_timeline.pyx"
+include "stop_conditions.pyx"
 include "evolve_regions.pyx"
 include "regions.pyx"
 include "copy.pyx"
@@ -17,6 +19,7 @@ include "debug.pyx"
 include "ages.pyx"
 include "temporal_samplers.pyx"
 include "add_mutations.pyx"
+include "dedup_gametes.pyx"
 include "GenoMatrixSampler.pyx"
 def pkg_version():
     """
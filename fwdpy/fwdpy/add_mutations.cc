@@ -1,6 +1,15 @@
 #include "fwdpy_add_mutations.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
 #include <fwdpp/sugar/add_mutation.hpp>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace fwdpy
 {
@@ -24,4 +33,472 @@ namespace fwdpy
         pop->mut_lookup.insert(pop->mutations[key].pos);
         return key;
     }
+
+    namespace
+    {
+        constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+        struct key_list_hash
+        {
+            std::size_t
+            operator()(const std::vector<std::size_t> &v) const noexcept
+            {
+                std::size_t h = v.size();
+                for (const auto k : v)
+                    h ^= std::hash<std::size_t>()(k) + 0x9e3779b9 + (h << 6)
+                         + (h >> 2);
+                return h;
+            }
+        };
+
+        template <typename pop_t>
+        void
+        check_input(const pop_t *pop, const std::vector<double> &pos,
+                    const std::vector<double> &s,
+                    const std::vector<double> &h,
+                    const std::uint8_t *haplotypes,
+                    std::vector<unsigned> &counts)
+        // Throw before pop is modified if the input is not valid
+        {
+            if (s.size() != pos.size() || h.size() != pos.size())
+                throw std::invalid_argument(
+                    "pos, s, and h must be the same length");
+            std::vector<double> sorted(pos);
+            std::sort(sorted.begin(), sorted.end());
+            if (std::adjacent_find(sorted.begin(), sorted.end())
+                != sorted.end())
+                throw std::runtime_error(
+                    "attempt to create two mutations at the same position");
+            for (const auto p : pos)
+                {
+                    if (pop->mut_lookup.find(p) != pop->mut_lookup.end())
+                        throw std::runtime_error(
+                            "attempt to create a mutation at position that "
+                            "already exists");
+                }
+            const std::size_t nrows = 2 * pop->diploids.size();
+            counts.assign(pos.size(), 0);
+            for (std::size_t row = 0; row < nrows; ++row)
+                {
+                    const auto x = haplotypes + row * pos.size();
+                    for (std::size_t c = 0; c < pos.size(); ++c)
+                        {
+                            if (x[c] > 1)
+                                throw std::invalid_argument(
+                                    "haplotypes must contain only 0 and 1");
+                            counts[c] += x[c];
+                        }
+                }
+            if (std::find(counts.begin(), counts.end(), 0u) != counts.end())
+                throw std::invalid_argument(
+                    "each new mutation must be present on at least one "
+                    "haplotype");
+        }
+
+        template <typename pop_t>
+        std::vector<std::size_t>
+        add_new_mutations(pop_t *pop, const std::vector<double> &pos,
+                          const std::vector<double> &s,
+                          const std::vector<double> &h,
+                          const std::vector<unsigned> &counts)
+        //! \return The key of each new mutation
+        {
+            std::vector<std::size_t> keys;
+            for (std::size_t c = 0; c < pos.size(); ++c)
+                {
+                    keys.push_back(pop->mutations.size());
+                    pop->mutations.emplace_back(pos[c], s[c], h[c],
+                                                pop->generation);
+                    pop->mcounts.push_back(counts[c]);
+                    pop->mut_lookup.insert(pos[c]);
+                }
+            return keys;
+        }
+
+        template <typename pop_t, typename haplotype_slot>
+        void
+        assign_gametes(pop_t *pop, const std::uint8_t *haplotypes,
+                       const std::size_t ncol,
+                       const std::vector<std::size_t> &columns,
+                       const std::vector<std::size_t> &keys,
+                       const haplotype_slot &slot)
+        /*!
+          Add the derived alleles in columns (sorted by position) to the
+          gametes of every haplotype.  slot(row) returns a reference to the
+          gamete index of haplotype row.
+
+          All haplotypes that start in the same gamete and receive the
+          same new mutations share one new gamete.  New gametes are placed
+          in extinct slots of pop->gametes when possible.
+        */
+        {
+            const std::size_t nrows = 2 * pop->diploids.size();
+            std::vector<std::size_t> target(nrows, none);
+            std::vector<typename pop_t::gamete_t> pending;
+            std::unordered_map<std::vector<std::size_t>, std::size_t,
+                               key_list_hash>
+                pending_index;
+            std::vector<std::size_t> id;
+            std::vector<KTfwd::uint_t> neutral, selected, merged;
+            const auto by_position
+                = [pop](const KTfwd::uint_t a, const KTfwd::uint_t b) {
+                      return pop->mutations[a].pos < pop->mutations[b].pos;
+                  };
+            for (std::size_t row = 0; row < nrows; ++row)
+                {
+                    const auto x = haplotypes + row * ncol;
+                    const std::size_t old = slot(row);
+                    id.assign(1, old);
+                    for (const auto c : columns)
+                        {
+                            if (x[c])
+                                id.push_back(keys[c]);
+                        }
+                    if (id.size() == 1)
+                        continue;
+                    auto itr = pending_index.find(id);
+                    if (itr == pending_index.end())
+                        {
+                            neutral.clear();
+                            selected.clear();
+                            for (std::size_t i = 1; i < id.size(); ++i)
+                                {
+                                    if (pop->mutations[id[i]].neutral)
+                                        neutral.push_back(
+                                            KTfwd::uint_t(id[i]));
+                                    else
+                                        selected.push_back(
+                                            KTfwd::uint_t(id[i]));
+                                }
+                            auto g = pop->gametes[old];
+                            g.n = 0;
+                            merged.clear();
+                            std::merge(g.mutations.begin(),
+                                       g.mutations.end(), neutral.begin(),
+                                       neutral.end(),
+                                       std::back_inserter(merged),
+                                       by_position);
+                            g.mutations.assign(merged.begin(), merged.end());
+                            merged.clear();
+                            std::merge(g.smutations.begin(),
+                                       g.smutations.end(), selected.begin(),
+                                       selected.end(),
+                                       std::back_inserter(merged),
+                                       by_position);
+                            g.smutations.assign(merged.begin(),
+                                                merged.end());
+                            itr = pending_index
+                                      .emplace(id, pending.size())
+                                      .first;
+                            pending.emplace_back(std::move(g));
+                        }
+                    target[row] = itr->second;
+                    pending[itr->second].n++;
+                    pop->gametes[old].n--;
+                }
+
+            std::vector<std::size_t> placed(pending.size());
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < pending.size(); ++i)
+                {
+                    while (next < pop->gametes.size()
+                           && pop->gametes[next].n)
+                        ++next;
+                    if (next < pop->gametes.size())
+                        {
+                            pop->gametes[next] = std::move(pending[i]);
+                            placed[i] = next++;
+                        }
+                    else
+                        {
+                            placed[i] = pop->gametes.size();
+                            pop->gametes.emplace_back(std::move(pending[i]));
+                            next = pop->gametes.size();
+                        }
+                }
+            for (std::size_t row = 0; row < nrows; ++row)
+                {
+                    if (target[row] != none)
+                        slot(row) = placed[target[row]];
+                }
+        }
+
+        std::vector<std::size_t>
+        columns_by_position(const std::vector<double> &pos)
+        {
+            std::vector<std::size_t> rv(pos.size());
+            for (std::size_t i = 0; i < rv.size(); ++i)
+                rv[i] = i;
+            std::sort(rv.begin(), rv.end(),
+                      [&pos](const std::size_t a, const std::size_t b) {
+                          return pos[a] < pos[b];
+                      });
+            return rv;
+        }
+    }
+
+    std::vector<std::size_t>
+    add_mutations_cpp(singlepop_t *pop, const std::vector<double> &pos,
+                      const std::vector<double> &s,
+                      const std::vector<double> &h,
+                      const std::uint8_t *haplotypes)
+    /*!
+      Add pos.size() mutations at once.  haplotypes is a row-major
+      2N x pos.size() matrix of 0/1 values.  Rows 2i and 2i+1 are the first
+      and second gametes of diploid i.  Derived alleles are added to the
+      existing contents of each gamete.
+
+      \return The key of each new mutation, in input order
+    */
+    {
+        std::vector<unsigned> counts;
+        check_input(pop, pos, s, h, haplotypes, counts);
+        const auto keys = add_new_mutations(pop, pos, s, h, counts);
+        assign_gametes(pop, haplotypes, pos.size(), columns_by_position(pos),
+                       keys, [pop](const std::size_t row) -> std::size_t & {
+                           auto &dip = pop->diploids[row / 2];
+                           return (row % 2) ? dip.second : dip.first;
+                       });
+        return keys;
+    }
+
+    std::vector<std::size_t>
+    add_mutations_cpp(
+        multilocus_t *pop, const std::vector<double> &pos,
+        const std::vector<double> &s, const std::vector<double> &h,
+        const std::uint8_t *haplotypes,
+        const std::vector<std::pair<double, double>> &locus_boundaries)
+    /*!
+      As for fwdpy::singlepop_t.  Each mutation is added to the locus whose
+      half-open interval in locus_boundaries contains its position.
+    */
+    {
+        if (!pop->diploids.empty()
+            && locus_boundaries.size() != pop->diploids.front().size())
+            throw std::invalid_argument(
+                "number of locus boundaries must equal number of loci");
+        std::vector<std::vector<std::size_t>> columns(
+            locus_boundaries.size());
+        for (const auto c : columns_by_position(pos))
+            {
+                std::size_t locus = 0;
+                while (locus < locus_boundaries.size()
+                       && !(pos[c] >= locus_boundaries[locus].first
+                            && pos[c] < locus_boundaries[locus].second))
+                    ++locus;
+                if (locus == locus_boundaries.size())
+                    throw std::invalid_argument(
+                        "mutation position is not within any locus");
+                columns[locus].push_back(c);
+            }
+        std::vector<unsigned> counts;
+        check_input(pop, pos, s, h, haplotypes, counts);
+        const auto keys = add_new_mutations(pop, pos, s, h, counts);
+        for (std::size_t locus = 0; locus < columns.size(); ++locus)
+            {
+                assign_gametes(
+                    pop, haplotypes, pos.size(), columns[locus], keys,
+                    [pop, locus](const std::size_t row) -> std::size_t & {
+                        auto &dip = pop->diploids[row / 2][locus];
+                        return (row % 2) ? dip.second : dip.first;
+                    });
+            }
+        return keys;
+    }
+
+    namespace
+    {
+        struct ms_block
+        {
+            std::vector<double> pos;
+            std::vector<std::string> haplotypes;
+        };
+
+        std::vector<ms_block>
+        read_ms(const std::string &filename, const std::size_t rep,
+                const std::size_t nblocks)
+        /*!
+          Read nblocks consecutive replicates from ms output, starting with
+          replicate rep (counting from 0).  Each replicate starts with a
+          line beginning with "//", followed by "segsites: S", "positions:
+          ..." when S > 0, and one line of S 0/1 characters per haplotype.
+        */
+        {
+            std::ifstream in(filename.c_str());
+            if (!in)
+                throw std::runtime_error("could not open " + filename);
+            std::vector<ms_block> rv;
+            std::string line;
+            std::size_t seen = 0;
+            bool have_header = false;
+            while (rv.size() < nblocks
+                   && (have_header || std::getline(in, line)))
+                {
+                    have_header = false;
+                    if (line.compare(0, 2, "//") != 0 || seen++ < rep)
+                        continue;
+                    ms_block b;
+                    std::string label;
+                    std::size_t S = 0;
+                    if (!std::getline(in, line)
+                        || !(std::istringstream(line) >> label >> S)
+                        || label != "segsites:")
+                        throw std::runtime_error(
+                            "ms replicate does not start with segsites");
+                    if (S)
+                        {
+                            std::getline(in, line);
+                            std::istringstream pline(line);
+                            pline >> label;
+                            if (label != "positions:")
+                                throw std::runtime_error(
+                                    "ms replicate has no positions line");
+                            double x;
+                            while (pline >> x)
+                                b.pos.push_back(x);
+                            if (b.pos.size() != S)
+                                throw std::runtime_error(
+                                    "number of ms positions does not match "
+                                    "segsites");
+                            while (std::getline(in, line))
+                                {
+                                    if (line.compare(0, 2, "//") == 0)
+                                        {
+                                            have_header = true;
+                                            break;
+                                        }
+                                    while (!line.empty()
+                                           && std::isspace(
+                                                  (unsigned char)line.back()))
+                                        line.pop_back();
+                                    if (line.empty())
+                                        break;
+                                    if (line.size() != S
+                                        || line.find_first_not_of("01")
+                                               != std::string::npos)
+                                        throw std::runtime_error(
+                                            "ms haplotype is not a string "
+                                            "of segsites 0/1 characters");
+                                    b.haplotypes.emplace_back(
+                                        std::move(line));
+                                }
+                        }
+                    rv.emplace_back(std::move(b));
+                }
+            if (rv.size() < nblocks)
+                throw std::runtime_error(
+                    filename + " has too few ms replicates");
+            return rv;
+        }
+
+        void
+        append_ms_block(const ms_block &b, const double beg, const double end,
+                        const std::size_t nhaps, std::vector<double> &pos,
+                        std::vector<std::vector<std::uint8_t>> &columns)
+        /*!
+          Map ms positions from [0,1) onto [beg,end).  Positions that
+          coincide after rounding in the ms output are moved apart by the
+          smallest representable amount.  Sites with no derived alleles
+          are skipped.
+        */
+        {
+            if (!(end > beg))
+                throw std::invalid_argument("end must be greater than beg");
+            if (!b.pos.empty() && b.haplotypes.size() != nhaps)
+                throw std::invalid_argument(
+                    "number of ms haplotypes must be twice the number of "
+                    "diploids");
+            for (std::size_t j = 0; j < b.pos.size(); ++j)
+                {
+                    std::vector<std::uint8_t> c(nhaps);
+                    for (std::size_t r = 0; r < nhaps; ++r)
+                        c[r] = std::uint8_t(b.haplotypes[r][j] == '1');
+                    if (std::find(c.begin(), c.end(), 1) == c.end())
+                        continue;
+                    double x = beg + b.pos[j] * (end - beg);
+                    if (!pos.empty() && pos.back() >= beg && x <= pos.back())
+                        x = std::nextafter(pos.back(), end);
+                    pos.push_back(std::min(x, std::nextafter(end, beg)));
+                    columns.emplace_back(std::move(c));
+                }
+        }
+
+        std::vector<std::uint8_t>
+        to_rows(const std::vector<std::vector<std::uint8_t>> &columns,
+                const std::size_t nhaps)
+        {
+            std::vector<std::uint8_t> rv(nhaps * columns.size());
+            for (std::size_t j = 0; j < columns.size(); ++j)
+                for (std::size_t r = 0; r < nhaps; ++r)
+                    rv[r * columns.size() + j] = columns[j][r];
+            return rv;
+        }
+
+        template <typename pop_t>
+        void
+        check_monomorphic(const pop_t *pop)
+        {
+            if (!pop->mutations.empty())
+                throw std::runtime_error(
+                    "population must not contain any mutations");
+        }
+    }
+
+    std::size_t
+    init_from_ms_cpp(singlepop_t *pop, const std::string &filename,
+                     const std::size_t rep, const double beg,
+                     const double end)
+    /*!
+      Add the variation in replicate rep of an ms output file to a
+      population with no mutations.  Haplotypes 2i and 2i+1 become the
+      gametes of diploid i.  All mutations are neutral.
+
+      \return The number of mutations added
+    */
+    {
+        check_monomorphic(pop);
+        const std::size_t nhaps = 2 * pop->diploids.size();
+        std::vector<double> pos;
+        std::vector<std::vector<std::uint8_t>> columns;
+        append_ms_block(read_ms(filename, rep, 1).front(), beg, end, nhaps,
+                        pos, columns);
+        if (pos.empty())
+            return 0;
+        const auto hap = to_rows(columns, nhaps);
+        return add_mutations_cpp(pop, pos, std::vector<double>(pos.size(), 0.),
+                                 std::vector<double>(pos.size(), 1.),
+                                 hap.data())
+            .size();
+    }
+
+    std::size_t
+    init_from_ms_cpp(
+        multilocus_t *pop, const std::string &filename, const std::size_t rep,
+        const std::vector<std::pair<double, double>> &locus_boundaries)
+    /*!
+      As for fwdpy::singlepop_t.  Replicates rep, rep + 1, ... are used for
+      the first, second, ... locus, and each is mapped onto the locus'
+      boundaries.
+    */
+    {
+        check_monomorphic(pop);
+        if (!pop->diploids.empty()
+            && locus_boundaries.size() != pop->diploids.front().size())
+            throw std::invalid_argument(
+                "number of locus boundaries must equal number of loci");
+        const std::size_t nhaps = 2 * pop->diploids.size();
+        const auto blocks = read_ms(filename, rep, locus_boundaries.size());
+        std::vector<double> pos;
+        std::vector<std::vector<std::uint8_t>> columns;
+        for (std::size_t l = 0; l < blocks.size(); ++l)
+            append_ms_block(blocks[l], locus_boundaries[l].first,
+                            locus_boundaries[l].second, nhaps, pos, columns);
+        if (pos.empty())
+            return 0;
+        const auto hap = to_rows(columns, nhaps);
+        return add_mutations_cpp(pop, pos, std::vector<double>(pos.size(), 0.),
+                                 std::vector<double>(pos.size(), 1.),
+                                 hap.data(), locus_boundaries)
+            .size();
+    }
 }
@@ -11,15 +11,81 @@
 #include <type_traits>
 #include <vector>
 
+#include "checkpoint.hpp"
 #include "evolve_regions_sampler.hpp"
 #include "fwdpy_fitness.hpp"
+#include "gamete_dedup.hpp"
+#include "generation_profiler.hpp"
+#include "gsl_rng_ptr.hpp"
+#include "philox_rng.hpp"
 #include "reserve.hpp"
 #include "sampler_base.hpp"
+#include "sampler_no_sampling.hpp"
+#include "stop_condition.hpp"
 #include "types.hpp"
 #include "wf_rules.hpp"
 
 using namespace std;
 
+namespace
+{
+    using namespace fwdpy;
+
+    void
+    check_evolve_inputs(const std::size_t npops, const double mu_neutral,
+                        const double mu_selected, const double littler,
+                        const double f, const int sample,
+                        const event_timeline *timeline,
+                        const std::vector<std::unique_ptr<stop_condition>>
+                            *stops)
+    // Throw exceptions here b4 getting into any threaded nonsense.
+    {
+        if (mu_neutral < 0. || mu_selected < 0. || littler < 0.)
+            {
+                throw std::runtime_error("mutation and recombination rates "
+                                         "must all be non-negative.");
+            }
+        if (f < 0. || f > 1.)
+            throw std::runtime_error("selfing probabilty must be 0<=f<=1.");
+        if (sample < 0)
+            throw std::runtime_error("sampling interval must be non-negative");
+        if (timeline != nullptr && timeline->has_trait_events())
+            throw std::runtime_error(
+                "trait parameter events require a quantitative trait model");
+        if (stops != nullptr && stops->size() != npops)
+            throw std::runtime_error("length of stop conditions != length of "
+                                     "population container");
+    }
+
+    struct restart_or_stop : public stop_condition
+    /*
+      Met when either condition is.  Each records its own generation,
+      so callers can tell which one ended an attempt.
+    */
+    {
+        stop_condition *restart, *stop;
+        restart_or_stop(stop_condition *restart_, stop_condition *stop_)
+            : stop_condition(), restart(restart_), stop(stop_)
+        {
+        }
+        virtual void
+        reset()
+        {
+            stop_condition::reset();
+            restart->reset();
+            if (stop != nullptr)
+                stop->reset();
+        }
+        virtual bool
+        done(const singlepop_t *pop)
+        {
+            if (restart->check(pop))
+                return true;
+            return stop != nullptr && stop->check(pop);
+        }
+    };
+}
+
 namespace fwdpy
 {
     void
@@ -30,20 +96,23 @@ namespace fwdpy
         std::unique_ptr<singlepop_fitness> &fitness, const int interval,
         KTfwd::extensions::discrete_mut_model &&__m,
         KTfwd::extensions::discrete_rec_model &&__recmap, sampler_base &s,
-        wf_rules rules)
+        wf_rules rules, const event_timeline *timeline, stop_condition *stop)
     {
         const size_t simlen = Nvector_len;
         auto x = std::max_element(Nvector, Nvector + Nvector_len);
         assert(x != Nvector + Nvector_len);
         reserve_space(pop->gametes, pop->mutations, *x, neutral + selected);
-        const double mu_tot = neutral + selected;
+        timeline_parameters params(neutral, selected, recrate, f, interval);
+        timeline_cursor events(timeline);
         gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
         gsl_rng_set(rng, seed);
         KTfwd::extensions::discrete_mut_model m(std::move(__m));
         KTfwd::extensions::discrete_rec_model recmap(std::move(__recmap));
+        generation_profiler profiler(pop->profile);
         // Recombination policy: more complex than the standard case...
-        const auto recpos = KTfwd::extensions::bind_drm(
-            recmap, pop->gametes, pop->mutations, rng, recrate);
+        auto recpos = profiler.wrap_recombination(KTfwd::extensions::bind_drm(
+            recmap, pop->gametes, pop->mutations, rng, recrate));
+        const auto ff = profiler.wrap_fitness(fitness->fitness_function);
 
         wf_rules local_rules(std::move(rules));
         /*
@@ -53,26 +122,56 @@ namespace fwdpy
           evolve again.
         */
         // fitness->update(pop);
+        if (stop != nullptr)
+            stop->reset();
         for (size_t g = 0; g < simlen; ++g, ++pop->generation)
             {
-                const unsigned nextN = *(Nvector + g);
+                if (stop != nullptr && stop->check(pop))
+                    break;
+                // Trait events were rejected by the caller.
+                events.apply(pop->generation,
+                             [&params](const timeline_event &e) {
+                                 params.apply(e);
+                             });
+                if (params.recrate_changed)
+                    {
+                        recpos = profiler.wrap_recombination(
+                            KTfwd::extensions::bind_drm(
+                                recmap, pop->gametes, pop->mutations, rng,
+                                params.recrate));
+                        params.recrate_changed = false;
+                    }
+                const unsigned nextN = params.nextN(*(Nvector + g));
+                profiler.before_generation(*pop);
+                profiler.start();
                 KTfwd::experimental::sample_diploid(
                     rng, pop->gametes, pop->diploids, pop->mutations,
-                    pop->mcounts, pop->N, nextN, mu_tot,
-                    KTfwd::extensions::bind_dmm(m, pop->mutations,
-                                                pop->mut_lookup, rng, neutral,
-                                                selected, pop->generation),
-                    recpos, fitness->fitness_function, pop->neutral,
-                    pop->selected, f, local_rules);
+                    pop->mcounts, pop->N, nextN, params.mu_tot(),
+                    KTfwd::extensions::bind_dmm(
+                        m, pop->mutations, pop->mut_lookup, rng,
+                        params.neutral, params.selected, pop->generation),
+                    recpos, ff, pop->neutral, pop->selected, params.f,
+                    local_rules);
+                profiler.stop(generation_phase::sample_diploid);
+                profiler.after_generation(*pop);
                 pop->N = nextN;
-                if (interval && pop->generation + 1
-                    && (pop->generation + 1) % interval == 0.)
+                if (params.interval && pop->generation + 1
+                    && (pop->generation + 1) % params.interval == 0.)
                     {
+                        profiler.start();
                         s(pop, pop->generation + 1);
+                        profiler.stop(generation_phase::sampler);
                     }
+                profiler.start();
                 KTfwd::update_mutations(
                     pop->mutations, pop->fixations, pop->fixation_times,
                     pop->mut_lookup, pop->mcounts, pop->generation, 2 * nextN);
+                profiler.stop(generation_phase::update_mutations);
+                if (params.dedup_due(pop->generation + 1))
+                    {
+                        const auto d = dedup_gametes(*pop);
+                        pop->profile.add_dedup(d.before, d.after);
+                    }
                 // Allow fitness model to update any data that it may need
                 // fitness->update(pop);
                 assert(KTfwd::check_sum(pop->gametes, 2 * nextN));
@@ -82,6 +181,8 @@ namespace fwdpy
         //    {
         //        s(pop, pop->generation);
         //    }
+        if (stop != nullptr && !stop->stopped())
+            stop->check(pop);
         // Update population's size variable to be the current pop size
         pop->N = unsigned(pop->diploids.size());
         // cleanup
@@ -97,19 +198,12 @@ namespace fwdpy
         const unsigned *Nvector, const size_t Nvector_length,
         const double mu_neutral, const double mu_selected,
         const double littler, const double f, const int sample,
-        const internal::region_manager *rm, const singlepop_fitness &fitness)
+        const internal::region_manager *rm, const singlepop_fitness &fitness,
+        const event_timeline *timeline,
+        std::vector<std::unique_ptr<stop_condition>> *stops)
     {
-        // check inputs--this is point of failure.  Throw excceptions here b4
-        // getting into any threaded nonsense.
-        if (mu_neutral < 0. || mu_selected < 0. || littler < 0.)
-            {
-                throw std::runtime_error("mutation and recombination rates "
-                                         "must all be non-negative.");
-            }
-        if (f < 0. || f > 1.)
-            throw std::runtime_error("selfing probabilty must be 0<=f<=1.");
-        if (sample < 0)
-            throw std::runtime_error("sampling interval must be non-negative");
+        check_evolve_inputs(pops.size(), mu_neutral, mu_selected, littler, f,
+                            sample, timeline, stops);
         std::vector<std::thread> threads;
         wf_rules rules;
         std::vector<std::unique_ptr<singlepop_fitness>> fitnesses;
@@ -130,9 +224,117 @@ namespace fwdpy
                         rm->callbacks),
                     KTfwd::extensions::discrete_rec_model(rm->rb, rm->rw,
                                                           rm->rw),
-                    std::ref(*samplers[i]), rules));
+                    std::ref(*samplers[i]), rules, timeline,
+                    (stops != nullptr) ? (*stops)[i].get() : nullptr));
+            }
+        for (auto &t : threads)
+            t.join();
+        flush_samplers(samplers);
+    }
+
+    void
+    evolve_regions_until_cpp_details(
+        singlepop_t *pop, const unsigned long seed, const unsigned *Nvector,
+        const size_t Nvector_len, const double neutral, const double selected,
+        const double recrate, const double f,
+        std::unique_ptr<singlepop_fitness> &fitness,
+        const internal::region_manager *rm, const event_timeline *timeline,
+        const unsigned checkpoint_generation, stop_condition &restart,
+        stop_condition *stop, const unsigned max_attempts,
+        unsigned &attempts)
+    {
+        const auto evolve = [&](const unsigned long s, const unsigned *N,
+                                const size_t len, stop_condition *c) {
+            no_sampling ns;
+            evolve_regions_sampler_cpp_details(
+                pop, s, N, len, neutral, selected, recrate, f, fitness, 0,
+                KTfwd::extensions::discrete_mut_model(
+                    rm->nb, rm->ne, rm->nw, rm->sb, rm->se, rm->sw,
+                    rm->callbacks),
+                KTfwd::extensions::discrete_rec_model(rm->rb, rm->rw, rm->rw),
+                ns, wf_rules(), timeline, c);
+        };
+        gsl_rng_ptr_t rng(gsl_rng_alloc(gsl_rng_mt19937));
+        gsl_rng_set(rng.get(), seed);
+        attempts = 0;
+        const size_t before = checkpoint_generation - pop->generation;
+        if (before)
+            {
+                evolve(gsl_rng_get(rng.get()), Nvector, before, stop);
+                if (stop != nullptr && stop->stopped())
+                    return;
+            }
+        const singlepop_checkpoint checkpoint(*pop, rng.get());
+        // Each attempt's seed comes from its own stream, so that it
+        // depends only on the checkpointed state and the attempt number.
+        gsl_rng_ptr_t attempt_rng(gsl_rng_alloc(philox::gsl_rng_philox4x32()));
+        restart_or_stop condition(&restart, stop);
+        for (attempts = 1;; ++attempts)
+            {
+                philox::set_stream(attempt_rng.get(), gsl_rng_get(rng.get()),
+                                   attempts, checkpoint_generation, 0);
+                evolve(gsl_rng_get(attempt_rng.get()), Nvector + before,
+                       Nvector_len - before, &condition);
+                if (!restart.stopped())
+                    break;
+                checkpoint.restore(*pop, rng.get());
+                if (attempts == max_attempts)
+                    break;
+            }
+    }
+
+    std::vector<unsigned>
+    evolve_regions_until_cpp(
+        GSLrng_t *rng, std::vector<std::shared_ptr<singlepop_t>> &pops,
+        const unsigned *Nvector, const size_t Nvector_length,
+        const double mu_neutral, const double mu_selected,
+        const double littler, const double f,
+        const internal::region_manager *rm, const singlepop_fitness &fitness,
+        const std::vector<unsigned> &checkpoint_generations,
+        std::vector<std::unique_ptr<stop_condition>> &restarts,
+        const unsigned max_attempts, const event_timeline *timeline,
+        std::vector<std::unique_ptr<stop_condition>> *stops)
+    {
+        check_evolve_inputs(pops.size(), mu_neutral, mu_selected, littler, f,
+                            0, timeline, stops);
+        if (restarts.size() != pops.size())
+            throw std::runtime_error("length of restart conditions != length "
+                                     "of population container");
+        if (!max_attempts)
+            throw std::runtime_error("max_attempts must be > 0");
+        if (checkpoint_generations.size() != pops.size())
+            throw std::runtime_error("length of checkpoint generations != "
+                                     "length of population container");
+        for (std::size_t i = 0; i < pops.size(); ++i)
+            {
+                if (checkpoint_generations[i] < pops[i]->generation
+                    || checkpoint_generations[i] - pops[i]->generation
+                           >= Nvector_length)
+                    throw std::runtime_error(
+                        "checkpoint generation must be >= the current "
+                        "generation and before the end of the simulation");
+            }
+        std::vector<unsigned> attempts(pops.size(), 0);
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<singlepop_fitness>> fitnesses;
+        for (std::size_t i = 0; i < pops.size(); ++i)
+            {
+                fitnesses.emplace_back(
+                    std::unique_ptr<singlepop_fitness>(fitness.clone()));
+            }
+        for (std::size_t i = 0; i < pops.size(); ++i)
+            {
+                threads.emplace_back(std::thread(
+                    evolve_regions_until_cpp_details, pops[i].get(),
+                    gsl_rng_get(rng->get()), Nvector, Nvector_length,
+                    mu_neutral, mu_selected, littler, f,
+                    std::ref(fitnesses[i]), rm, timeline,
+                    checkpoint_generations[i], std::ref(*restarts[i]),
+                    (stops != nullptr) ? (*stops)[i].get() : nullptr,
+                    max_attempts, std::ref(attempts[i])));
             }
         for (auto &t : threads)
             t.join();
+        return attempts;
     }
 }
@@ -8,4 +8,6 @@ cdef extern from "fwdpyio_serialize.hpp" namespace "fwdpy::serialize" nogil:
     vector[shared_ptr[metapop_t]] deserialize_metapop(const vector[string] & strings)
     string serialize_multilocus(const multilocus_t * pop)
     vector[shared_ptr[multilocus_t]] deserialize_multilocus(const vector[string] & strings)
-
+    vector[shared_ptr[singlepop_t]] fromfile_singlepop(const vector[string] & filenames, const vector[size_t] & offsets, const unsigned nthreads) except +
+    vector[shared_ptr[metapop_t]] fromfile_metapop(const vector[string] & filenames, const vector[size_t] & offsets, const unsigned nthreads) except +
+    vector[shared_ptr[multilocus_t]] fromfile_multilocus(const vector[string] & filenames, const vector[size_t] & offsets, const unsigned nthreads) except +
@@ -48,6 +48,20 @@ cdef void gzwrite_multilocus(const multilocus_t * pop, const unsigned generation
     rv=pop.tofile(s.c_str(),True)
     data.push_back(data_t(generation,rv))
 
+#The same, writing BGZF.  Replicates are already written
+#concurrently, so each one is compressed using a single thread.
+cdef void bgzwrite_singlepop(const singlepop_t * pop, const unsigned generation, gzfinal_t & data, string & s) nogil:
+    rv=pop.tofile_bgzf(s.c_str(),True,1)
+    data.push_back(data_t(generation,rv))
+
+cdef void bgzwrite_metapop(const metapop_t * pop, const unsigned generation, gzfinal_t & data, string & s) nogil:
+    rv=pop.tofile_bgzf(s.c_str(),True,1)
+    data.push_back(data_t(generation,rv))
+
+cdef void bgzwrite_multilocus(const multilocus_t * pop, const unsigned generation, gzfinal_t & data, string & s) nogil:
+    rv=pop.tofile_bgzf(s.c_str(),True,1)
+    data.push_back(data_t(generation,rv))
+
 #This is our cython extension class.
 #The __cinit__ function is the important one,
 #as it must set up the file names, and initialize 
@@ -59,12 +73,13 @@ cdef class gzSerializer(TemporalSampler):
 
     ..note:: This is a good way to fill up a hard drive.  Use with caution.
     """
-    def __cinit__(self,unsigned n,string basename):
+    def __cinit__(self,unsigned n,string basename,bint bgzf = False):
         """
         Constructor.
 
         :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
         :param basename: A prefix for file names.  For a length n, output file names will be basename.i.gz where 0<=i<n.
+        :param bgzf: (False) If True, write BGZF.  Such files can be read in parallel by :func:`fwdpy.fwdpyio.fwdpyio.read_snapshots`.
         """
         bn=basename
         cdef string temp_string
@@ -75,6 +90,12 @@ cdef class gzSerializer(TemporalSampler):
             #We open and close the output file...
             gz=gzopen(temp_string.c_str(),"wb")
             gzclose(gz)
+            if bgzf:
+                self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[gzserializer_t](new
+                    gzserializer_t(&bgzwrite_singlepop,temp_string)))
+                (<gzserializer_t*>self.vec[i].get()).register_callback(&bgzwrite_metapop)
+                (<gzserializer_t*>self.vec[i].get()).register_callback(&bgzwrite_multilocus)
+                continue
             #Push back an object with gwrite_singlepop registered
             #as a callback
             self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[gzserializer_t](new
@@ -209,3 +230,78 @@ def deserialize_mlocus(list strings):
     rv.reset(temp)
     return rv
 
+def write_snapshot(PopType pop, filename, bint append = False, unsigned nthreads = 0):
+    """
+    Write a population to a BGZF file, compressing blocks of the output in parallel.
+
+    :param pop: A :class:`fwdpy.fwdpy.PopType`
+    :param filename: The output file name
+    :param append: (False) If True, append to filename.  Otherwise, overwrite it.
+    :param nthreads: (0) Number of threads to use.  0 means use all available hardware threads.
+
+    :return: The number of uncompressed bytes written.  When appending several populations to a file,
+        the running sum of these values gives each population's offset for :func:`read_snapshots`.
+
+    .. note:: BGZF is valid gzip, so the output may be read by gunzip, zlib, etc.
+    """
+    cdef string fn = filename
+    cdef int64_t rv
+    if isinstance(pop,Spop):
+        with nogil:
+            rv = (<Spop>pop).pop.get().tofile_bgzf(fn.c_str(),append,nthreads)
+    elif isinstance(pop,MetaPop):
+        with nogil:
+            rv = (<MetaPop>pop).mpop.get().tofile_bgzf(fn.c_str(),append,nthreads)
+    elif isinstance(pop,MlocusPop):
+        with nogil:
+            rv = (<MlocusPop>pop).pop.get().tofile_bgzf(fn.c_str(),append,nthreads)
+    else:
+        raise RuntimeError("fwdpyio.write_snapshot: unsupported PopType "+str(type(pop)))
+    return rv
+
+def read_snapshots(list filenames, pop_type, offsets = None, unsigned nthreads = 0):
+    """
+    Read populations from files.
+
+    :param filenames: A list of file names, one per population
+    :param pop_type: One of 'single', 'meta', or 'mlocus'
+    :param offsets: (None) A list of offsets, one per file, such as those returned by
+        :func:`fwdpy.fwdpyio.fwdpyio.gzSerializer.get`.  If None, the first population in each file is read.
+    :param nthreads: (0) Number of threads used to decompress each file.  0 means use all available hardware threads.
+
+    :return: A :class:`fwdpy.fwdpy.SpopVec`, :class:`fwdpy.fwdpy.MetaPopVec`, or :class:`fwdpy.fwdpy.MlocusPopVec`
+
+    BGZF files, written by :func:`write_snapshot` or by :class:`gzSerializer` with bgzf=True, are decompressed in parallel.
+    Other gzip files are read using a single thread.
+    """
+    cdef vector[string] fns = filenames
+    cdef vector[size_t] offs
+    if offsets is None:
+        offs.resize(fns.size(),0)
+    else:
+        offs = offsets
+    cdef vector[shared_ptr[singlepop_t]] s
+    cdef vector[shared_ptr[metapop_t]] m
+    cdef vector[shared_ptr[multilocus_t]] ml
+    cdef SpopVec sv
+    cdef MetaPopVec mv
+    cdef MlocusPopVec mlv
+    if pop_type == 'single':
+        with nogil:
+            s = fromfile_singlepop(fns,offs,nthreads)
+        sv = SpopVec(0,0)
+        sv.reset(s)
+        return sv
+    elif pop_type == 'meta':
+        with nogil:
+            m = fromfile_metapop(fns,offs,nthreads)
+        mv = MetaPopVec(0,[0]*1)
+        mv.reset(m)
+        return mv
+    elif pop_type == 'mlocus':
+        with nogil:
+            ml = fromfile_multilocus(fns,offs,nthreads)
+        mlv = MlocusPopVec(0,0,0)
+        mlv.reset(ml)
+        return mlv
+    raise ValueError("pop_type must be one of 'single', 'meta', or 'mlocus'")
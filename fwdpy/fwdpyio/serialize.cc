@@ -42,5 +42,31 @@ namespace fwdpy
         {
             return deserialize_details<multilocus_t>()(strings, 0u, 0u);
         }
+
+        vector<shared_ptr<singlepop_t>>
+        fromfile_singlepop(const vector<string> &filenames,
+                           const vector<size_t> &offsets,
+                           const unsigned nthreads)
+        {
+            return fromfile_details<singlepop_t>()(filenames, offsets,
+                                                   nthreads, 0u);
+        }
+
+        vector<shared_ptr<metapop_t>>
+        fromfile_metapop(const vector<string> &filenames,
+                         const vector<size_t> &offsets, const unsigned nthreads)
+        {
+            return fromfile_details<metapop_t>()(filenames, offsets, nthreads,
+                                                 std::vector<unsigned>(0u));
+        }
+
+        vector<shared_ptr<multilocus_t>>
+        fromfile_multilocus(const vector<string> &filenames,
+                            const vector<size_t> &offsets,
+                            const unsigned nthreads)
+        {
+            return fromfile_details<multilocus_t>()(filenames, offsets,
+                                                    nthreads, 0u, 0u);
+        }
     }
 }
@@ -17,6 +17,8 @@ cdef extern from "gsl_data_matrix.hpp" namespace "fwdpy::gsl_data_matrix" nogil:
     void write_geno_matrix(const geno_matrix *m, const uint generation,
                       cppstring stub, const int repid,
                       const bint keep_origin)
+    void write_geno_matrix_plink(const geno_matrix *m, const uint generation,
+                      cppstring stub, const int repid) except +
     void emplace_move(vector[pair[uint,unique_ptr[geno_matrix]]] & v,pair[uint,unique_ptr[geno_matrix]] & p)
 
 
@@ -1,5 +1,7 @@
 from libcpp.vector cimport vector
-from fwdpy.fwdpy cimport singlepop_t
+from libcpp.string cimport string as cppstring
+from libcpp.memory cimport shared_ptr
+from fwdpy.fwdpy cimport singlepop_t,multilocus_t
 
 cdef extern from "gwas_genotype_matrix.hpp" namespace "fwdpy::gwas" nogil:
     cdef struct genotype_matrix:
@@ -18,3 +20,18 @@ cdef extern from "gwas_genotype_matrix.hpp" namespace "fwdpy::gwas" nogil:
         
         
         
+
+cdef extern from "plink.hpp" namespace "fwdpy::plink" nogil:
+    size_t write_plink[POPTYPE](const POPTYPE * pop, const cppstring & stub) except +
+
+cdef extern from "gwas_scan.hpp" namespace "fwdpy::gwas" nogil:
+    cdef struct scan_result:
+        vector[double] pos
+        vector[double] freq
+        vector[double] esize
+        vector[double] beta
+        vector[double] se
+        vector[double] pvalue
+        vector[int] neutral
+
+    vector[scan_result] scan[POPTYPE](const vector[shared_ptr[POPTYPE]] & pops, const double minfreq) except +
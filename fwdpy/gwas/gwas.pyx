@@ -1,4 +1,6 @@
-from fwdpy.fwdpy cimport SpopVec,Spop,singlepop_t
+from fwdpy.fwdpy cimport SpopVec,MlocusPopVec,Spop,MlocusPop,singlepop_t,multilocus_t
+import numpy as np
+import pandas as pd
 
 def genotype_matrices(SpopVec pops):
     rv=[]
@@ -6,3 +8,61 @@ def genotype_matrices(SpopVec pops):
         temp=make_geno_matrix(pops.pops[i].get(),True)
         rv.append(temp)
     return rv
+
+def to_plink(pop,stub):
+    """
+    Write the genotypes of every individual in a population in PLINK binary format.
+
+    :param pop: A :class:`fwdpy.fwdpy.Spop` or :class:`fwdpy.fwdpy.MlocusPop`
+    :param stub: Output files are stub.bed, stub.bim, and stub.fam
+
+    :return: The number of variants written
+
+    Neutral and selected variants segregating in the population are written in order of position.
+    The derived allele is A1 (coded 'D'), and the phenotype in the .fam file is G+E.
+    fwdpy positions are not integers, so the .bim file gives the position as the
+    variant ID and the variant's rank as its base-pair coordinate.
+    """
+    cdef cppstring s = stub
+    cdef size_t rv
+    if isinstance(pop,Spop):
+        with nogil:
+            rv = write_plink((<Spop>pop).pop.get(),s)
+    elif isinstance(pop,MlocusPop):
+        with nogil:
+            rv = write_plink((<MlocusPop>pop).pop.get(),s)
+    else:
+        raise ValueError("pop must be Spop or MlocusPop")
+    return rv
+
+def association_scan(pops,double minfreq = 0.0):
+    """
+    Regress G+E on the number of derived alleles at each segregating site.
+
+    :param pops: A :class:`fwdpy.fwdpy.SpopVec` or :class:`fwdpy.fwdpy.MlocusPopVec`
+    :param minfreq: (0.0) Skip sites whose minor allele frequency in the population is less than this.
+
+    :return: A list of pandas.DataFrame objects, one per population.
+
+    Each DataFrame has one row per site, in order of position, with columns pos, freq,
+    esize, neutral, beta, se, and pvalue.  beta and se are the ordinary least-squares
+    estimate and standard error of the effect of each derived allele, and pvalue is
+    from a two-sided t test with N-2 degrees of freedom.  All individuals are used.
+    Populations are processed in parallel, and only these summaries are returned to Python.
+    """
+    cdef vector[scan_result] rv
+    if isinstance(pops,SpopVec):
+        with nogil:
+            rv = scan((<SpopVec>pops).pops,minfreq)
+    elif isinstance(pops,MlocusPopVec):
+        with nogil:
+            rv = scan((<MlocusPopVec>pops).pops,minfreq)
+    else:
+        raise ValueError("pops must be SpopVec or MlocusPopVec")
+    dfs=[]
+    for i in range(rv.size()):
+        dfs.append(pd.DataFrame({'pos':np.array(rv[i].pos),'freq':np.array(rv[i].freq),
+                                 'esize':np.array(rv[i].esize),'neutral':np.array(rv[i].neutral,dtype=bool),
+                                 'beta':np.array(rv[i].beta),'se':np.array(rv[i].se),'pvalue':np.array(rv[i].pvalue)},
+                                columns=['pos','freq','esize','neutral','beta','se','pvalue']))
+    return dfs
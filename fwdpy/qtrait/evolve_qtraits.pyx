@@ -37,7 +37,8 @@ def evolve_regions_qtrait(GSLrng rng,
                           double sigmaE,
                           double optimum = 0.,
                           double f = 0.,
-                          double VS=1,):
+                          double VS=1,
+                          unsigned nthreads = 1):
     """
     Evolve a quantitative trait with variable mutation, fitness effects, and recombination rates.
 
@@ -55,8 +56,11 @@ def evolve_regions_qtrait(GSLrng rng,
     :param optimum: The optimum trait value. **Default = 0.0**
     :param f: The selfing probabilty. **Default = 0.0**
     :param VS: The total variance in selection intensity. **Default = 1.0**
+    :param nthreads: The number of threads used to generate the offspring of each replicate. **Default = 1**
 
     :raises: RuntimeError if parameters do not pass checks
+
+    .. note:: When nthreads > 1, each replicate uses nthreads threads, in addition to the one thread per replicate.  Results depend on the seed but not on the value of nthreads (as long as it is > 1).  They differ from those obtained with nthreads = 1, which uses a different algorithm.
     """
     pops = SpopVec(npops,N)
     donothing = NothingSampler(npops)
@@ -64,7 +68,7 @@ def evolve_regions_qtrait(GSLrng rng,
     evolve_regions_qtrait_sampler_fitness(rng,pops,donothing,fitness,nlist,
                                           mu_neutral,mu_selected,recrate,
                                           nregions,sregions,recregions,
-                                          len(nlist),sigmaE,optimum,f,VS)
+                                          len(nlist),sigmaE,optimum,f,VS,nthreads)
                                           
     return pops
 
@@ -80,13 +84,14 @@ def evolve_regions_qtrait_more(GSLrng rng,
                                double sigmaE,
                                double optimum = 0.,
                                double f = 0.,
-                               double VS=1,):
+                               double VS=1,
+                               unsigned nthreads = 1):
     donothing = NothingSampler(len(pops))
     fitness = SpopAdditiveTrait()
     evolve_regions_qtrait_sampler_fitness(rng,pops,donothing,fitness,nlist,
                                           mu_neutral,mu_selected,recrate,
                                           nregions,sregions,recregions,
-                                          len(nlist),sigmaE,optimum,f,VS)
+                                          len(nlist),sigmaE,optimum,f,VS,nthreads)
 
 @cython.boundscheck(False)
 def evolve_regions_qtrait_sampler(GSLrng rng,
@@ -103,12 +108,16 @@ def evolve_regions_qtrait_sampler(GSLrng rng,
                                   double sigmaE,
                                   double optimum = 0.0,
                                   double f = 0,
-                                  double VS = 1.0):
+                                  double VS = 1.0,
+                                  unsigned nthreads = 1,
+                                  EventTimeline timeline = None,
+                                  StopCondition stop = None):
     fitness = SpopAdditiveTrait()
     evolve_regions_qtrait_sampler_fitness(rng,pops,slist,fitness,nlist,
                                           mu_neutral,mu_selected,recrate,
                                           nregions,sregions,recregions,
-                                          sample,sigmaE,optimum,f,VS)
+                                          sample,sigmaE,optimum,f,VS,nthreads,
+                                          timeline,stop)
     
 @cython.boundscheck(False)
 def evolve_regions_qtrait_sampler_fitness(GSLrng rng,
@@ -126,17 +135,28 @@ def evolve_regions_qtrait_sampler_fitness(GSLrng rng,
                                           double sigmaE,
                                           double optimum = 0.0,
                                           double f = 0,
-                                          double VS = 1.0):
+                                          double VS = 1.0,
+                                          unsigned nthreads = 1,
+                                          EventTimeline timeline = None,
+                                          StopCondition stop = None):
     fwdpy.check_input_params(mu_neutral,mu_selected,recrate,nregions,sregions,recregions)
     if isinstance(fitness_function,SpopGBRTrait):
         check_gbr_sdist(sregions)
     if sample < 0:
         raise RuntimeError("sample must be >= 0")
+    if nthreads < 1:
+        raise RuntimeError("nthreads must be >= 1")
     if f < 0.:
         warnings.warn("f < 0 will be treated as 0")
         f=0
     rmgr = region_manager_wrapper()
     internal.make_region_manager(rmgr,nregions,sregions,recregions)
     cdef size_t listlen = len(nlist)
+    cdef const event_timeline * tptr = NULL
+    if timeline is not None:
+        tptr = timeline.get()
+    cdef vector[unique_ptr[stop_condition]] * sptr = NULL
+    if stop is not None:
+        sptr = &stop.vec
     evolve_regions_qtrait_cpp(rng.thisptr,pops.pops,
-                              slist.vec,&nlist[0],listlen,mu_neutral,mu_selected,recrate,f,sigmaE,optimum,VS,sample,rmgr.thisptr,deref(fitness_function.wfxn.get()))
+                              slist.vec,&nlist[0],listlen,mu_neutral,mu_selected,recrate,f,sigmaE,optimum,VS,sample,rmgr.thisptr,deref(fitness_function.wfxn.get()),nthreads,tptr,sptr)
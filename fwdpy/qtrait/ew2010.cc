@@ -7,9 +7,12 @@
 #include <cmath>
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_statistics_double.h>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -18,49 +21,257 @@ namespace fwdpy
 {
     namespace qtrait
     {
+        namespace
+        {
+            ew_mut_details
+            draw_effect(GSLrng_t *rng, const KTfwd::popgenmut &m,
+                        const unsigned count, const double fourN,
+                        const double tau, const double sigma)
+            {
+                double d = (gsl_rng_uniform(rng->get()) < 0.5) ? -1. : 1.;
+                double power = pow(fourN * fabs(m.s), tau);
+                if (m.s < 0.)
+                    power *= -1.;
+                return ew_mut_details(
+                    m.s, d * power * (1. + gsl_ran_gaussian_ziggurat(
+                                               rng->get(), sigma)),
+                    2. * double(count) / fourN);
+            }
+
+            template <typename F>
+            void
+            run_in_chunks(const std::size_t n, unsigned nthreads, const F &f)
+            // Call f(beg,end) for contiguous ranges covering [0,n)
+            {
+                if (!nthreads)
+                    nthreads = max(1u, thread::hardware_concurrency());
+                nthreads = unsigned(min<std::size_t>(nthreads, n));
+                if (nthreads <= 1)
+                    {
+                        f(std::size_t(0), n);
+                        return;
+                    }
+                const std::size_t chunk = (n + nthreads - 1) / nthreads;
+                vector<thread> threads;
+                for (std::size_t beg = 0; beg < n; beg += chunk)
+                    threads.emplace_back(f, beg, min(n, beg + chunk));
+                for (auto &t : threads)
+                    t.join();
+            }
+        }
+
         map<double, ew_mut_details>
         ew2010_assign_effects(GSLrng_t *rng, const fwdpy::singlepop_t *pop,
                               const double tau, const double sigma)
         {
             const double fourN = 4. * double(pop->diploids.size());
             map<double, ew_mut_details> rv;
-            // for( auto itr = pop->mutations.cbegin() ; itr !=
-            // pop->mutations.cend() ; ++itr )
             for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
                 {
-                    if (pop->mcounts[i])
+                    if (pop->mcounts[i] && !pop->mutations[i].neutral)
+                        {
+                            if (!rv.emplace(pop->mutations[i].pos,
+                                            draw_effect(rng, pop->mutations[i],
+                                                        pop->mcounts[i], fourN,
+                                                        tau, sigma))
+                                     .second)
+                                {
+                                    throw runtime_error(
+                                        "multiple mutations at same "
+                                        "position");
+                                }
+                        }
+                }
+            return rv;
+        }
+
+        ew_effects
+        ew2010_assign_effects_dense(GSLrng_t *rng,
+                                    const fwdpy::singlepop_t *pop,
+                                    const double tau, const double sigma)
+        /*!
+          Draws the same effects, in the same order, as
+          ew2010_assign_effects.  Mutations at the same position are
+          allowed.
+        */
+        {
+            const double fourN = 4. * double(pop->diploids.size());
+            const double nan = numeric_limits<double>::quiet_NaN();
+            ew_effects rv;
+            rv.s.assign(pop->mutations.size(), nan);
+            rv.e.assign(pop->mutations.size(), nan);
+            rv.p.assign(pop->mutations.size(), nan);
+            for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
+                {
+                    if (pop->mcounts[i] && !pop->mutations[i].neutral)
+                        {
+                            const auto d
+                                = draw_effect(rng, pop->mutations[i],
+                                              pop->mcounts[i], fourN, tau,
+                                              sigma);
+                            rv.s[i] = d.s;
+                            rv.e[i] = d.e;
+                            rv.p[i] = d.p;
+                        }
+                }
+            return rv;
+        }
+
+        vector<double>
+        ew2010_traits_dense(const fwdpy::singlepop_t *pop,
+                            const ew_effects &effects, const unsigned nthreads)
+        /*!
+          The sum of effects on each extant gamete is computed once, and
+          each diploid's trait value is the sum for its two gametes.  Both
+          steps are divided among nthreads threads.  If nthreads is 0, the
+          number of hardware threads is used.
+        */
+        {
+            if (effects.e.size() != pop->mutations.size())
+                throw runtime_error(
+                    "number of effects does not match number of mutations");
+            vector<double> gamete_sums(pop->gametes.size(), 0.);
+            vector<char> unknown(pop->gametes.size(), 0);
+            run_in_chunks(pop->gametes.size(), nthreads,
+                          [pop, &effects, &gamete_sums, &unknown](
+                              const std::size_t beg, const std::size_t end) {
+                              for (std::size_t g = beg; g < end; ++g)
+                                  {
+                                      if (!pop->gametes[g].n)
+                                          continue;
+                                      double sum = 0.;
+                                      for (const auto k :
+                                           pop->gametes[g].smutations)
+                                          sum += effects.e[k];
+                                      gamete_sums[g] = sum;
+                                      unknown[g] = std::isnan(sum);
+                                  }
+                          });
+            if (find(unknown.begin(), unknown.end(), 1) != unknown.end())
+                throw runtime_error(
+                    "diploid contains a mutation without an effect");
+            vector<double> rv(pop->diploids.size());
+            run_in_chunks(pop->diploids.size(), nthreads,
+                          [pop, &gamete_sums, &rv](const std::size_t beg,
+                                                   const std::size_t end) {
+                              for (std::size_t i = beg; i < end; ++i)
+                                  rv[i] = gamete_sums[pop->diploids[i].first]
+                                          + gamete_sums[pop->diploids[i]
+                                                            .second];
+                          });
+            return rv;
+        }
+
+        ew_grid
+        ew2010_traits_grid(GSLrng_t *rng, const fwdpy::singlepop_t *pop,
+                           const std::vector<double> &tau,
+                           const std::vector<double> &sigma,
+                           const bool keep_traits, const unsigned nthreads)
+        /*!
+          Each selected mutation gets one random sign, d, and one standard
+          normal deviate, z, which are shared by all combinations.  The
+          effect for combination k is d*(4N|s|)^tau[k]*(1 + sigma[k]*z),
+          with the sign of s, as in ew2010_assign_effects.  The effects form
+          an M x K matrix for the M selected mutations.  Sums over each
+          gamete's selected mutations are computed for all K columns at
+          once, and each diploid's traits are the sums for its two
+          gametes.
+        */
+        {
+            if (tau.size() != sigma.size())
+                throw invalid_argument("tau and sigma must be the same length");
+            for (std::size_t k = 0; k < tau.size(); ++k)
+                {
+                    if (tau[k] < 0. || sigma[k] < 0.)
+                        throw invalid_argument(
+                            "tau and sigma cannot be < 0.");
+                }
+            const std::size_t K = tau.size();
+            const std::size_t N = pop->diploids.size();
+            const double fourN = 4. * double(N);
+
+            // Column of each selected key in the effects matrix
+            constexpr std::size_t no_column
+                = numeric_limits<std::size_t>::max();
+            vector<std::size_t> column(pop->mutations.size(), no_column);
+            vector<double> effects;
+            std::size_t M = 0;
+            for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
+                {
+                    if (!pop->mcounts[i] || pop->mutations[i].neutral)
+                        continue;
+                    const double s = pop->mutations[i].s;
+                    const double d
+                        = (gsl_rng_uniform(rng->get()) < 0.5) ? -1. : 1.;
+                    const double z = gsl_ran_gaussian_ziggurat(rng->get(), 1.);
+                    for (std::size_t k = 0; k < K; ++k)
+                        {
+                            double power = pow(fourN * fabs(s), tau[k]);
+                            if (s < 0.)
+                                power *= -1.;
+                            effects.push_back(d * power
+                                              * (1. + sigma[k] * z));
+                        }
+                    column[i] = M++;
+                }
+
+            vector<double> gamete_sums(pop->gametes.size() * K, 0.);
+            vector<char> unknown(pop->gametes.size(), 0);
+            run_in_chunks(
+                pop->gametes.size(), nthreads,
+                [pop, K, &column, &effects, &gamete_sums, &unknown](
+                    const std::size_t beg, const std::size_t end) {
+                    for (std::size_t g = beg; g < end; ++g)
                         {
-                            if (!pop->mutations[i].neutral)
+                            if (!pop->gametes[g].n)
+                                continue;
+                            double *sums = gamete_sums.data() + g * K;
+                            for (const auto key : pop->gametes[g].smutations)
                                 {
-                                    if (rv.find(pop->mutations[i].pos)
-                                        != rv.end())
+                                    if (column[key] == no_column)
                                         {
-                                            throw runtime_error(
-                                                "multiple mutations at same "
-                                                "position");
+                                            unknown[g] = 1;
+                                            break;
                                         }
-                                    double d
-                                        = (gsl_rng_uniform(rng->get()) < 0.5)
-                                              ? -1.
-                                              : 1.;
-                                    double power = pow(
-                                        fourN * fabs(pop->mutations[i].s),
-                                        tau);
-                                    if (pop->mutations[i].s < 0.)
-                                        power *= -1.;
-                                    rv.insert(std::make_pair(
-                                        pop->mutations[i].pos,
-                                        ew_mut_details(
-                                            pop->mutations[i].s,
-                                            d * power
-                                                * (1.
-                                                   + gsl_ran_gaussian_ziggurat(
-                                                         rng->get(), sigma)),
-                                            2. * double(pop->mcounts[i])
-                                                / fourN)));
+                                    const double *e
+                                        = effects.data() + column[key] * K;
+                                    for (std::size_t k = 0; k < K; ++k)
+                                        sums[k] += e[k];
                                 }
                         }
+                });
+            if (find(unknown.begin(), unknown.end(), 1) != unknown.end())
+                throw runtime_error("gamete contains an extinct mutation");
+
+            vector<double> traits(N * K), w(N);
+            run_in_chunks(N, nthreads, [pop, K, &gamete_sums, &traits, &w](
+                                           const std::size_t beg,
+                                           const std::size_t end) {
+                for (std::size_t i = beg; i < end; ++i)
+                    {
+                        const auto &dip = pop->diploids[i];
+                        const double *a = gamete_sums.data() + dip.first * K;
+                        const double *b = gamete_sums.data() + dip.second * K;
+                        double *t = traits.data() + i * K;
+                        for (std::size_t k = 0; k < K; ++k)
+                            t[k] = a[k] + b[k];
+                        w[i] = dip.w;
+                    }
+            });
+
+            ew_grid rv;
+            rv.tau = tau;
+            rv.sigma = sigma;
+            for (std::size_t k = 0; k < K; ++k)
+                {
+                    rv.mean.push_back(gsl_stats_mean(traits.data() + k, K, N));
+                    rv.variance.push_back(
+                        gsl_stats_variance(traits.data() + k, K, N));
+                    rv.corr_w.push_back(gsl_stats_correlation(
+                        traits.data() + k, K, w.data(), 1, N));
                 }
+            if (keep_traits)
+                rv.traits.swap(traits);
             return rv;
         }
 
@@ -97,6 +308,7 @@ namespace fwdpy
                                 }
                             sum += effects_itr->second.e;
                         }
+                    rv.push_back(sum);
                 }
             return rv;
             /*
@@ -89,3 +89,109 @@ def ew2010_traits(Spop pop,list effects):
             tstruct.p = i[j]['p']
             temp.insert( pair[double,ew_mut_details](j,tstruct) )
     return ew2010_traits_cpp(pop.pop.get(),temp)
+
+cdef double_vector_to_array(const vector[double] & v):
+    rv = np.empty(v.size(),dtype=np.float64)
+    cdef double[::1] dest = rv
+    if v.size() > 0:
+        memcpy(&dest[0],v.data(),v.size()*sizeof(double))
+    return rv
+
+cdef class EW2010Effects(object):
+    """
+    Effects of mutations on a trait under the model of Eyre-Walker (2010),
+    stored in arrays indexed by the mutation's position in the population's container of mutations.
+
+    Create instances with :func:`ew2010_effects_dense`.  Elements for neutral or extinct mutations are NaN.
+    """
+    cdef ew_effects data
+    property s:
+        """Selection coefficients"""
+        def __get__(self):
+            return double_vector_to_array(self.data.s)
+    property e:
+        """Effects on trait value"""
+        def __get__(self):
+            return double_vector_to_array(self.data.e)
+    property p:
+        """Mutation frequencies"""
+        def __get__(self):
+            return double_vector_to_array(self.data.p)
+    def __len__(self):
+        return self.data.e.size()
+
+def ew2010_effects_dense(GSLrng rng, Spop pop, double tau, double sigma):
+    """
+    Assign effects to all selected mutations, as in :func:`ew2010_effects`.
+
+    :param rng: A :class:`fwdpy.fwdpy.GSLrng`
+    :param pop: A :class:`fwdpy.fwdpy.Spop`
+    :param tau: The coupling of trait value to fitness effect of mutation
+    :param sigma: The standard deviation for Gaussian noise applied to trait value.
+
+    :rtype: :class:`EW2010Effects`
+
+    Given the same random number generator state, the effects are the same as those from :func:`ew2010_effects`.
+    """
+    if tau < 0.:
+        raise RuntimeError("tau cannot be < 0.")
+    if sigma < 0.:
+        raise RuntimeError("sigma cannot be < 0.")
+    rv = EW2010Effects()
+    cdef ew_effects * e = &(<EW2010Effects>rv).data
+    with nogil:
+        e[0] = ew2010_assign_effects_dense(rng.thisptr,pop.pop.get(),tau,sigma)
+    return rv
+
+def ew2010_traits_dense(Spop pop, EW2010Effects effects, unsigned nthreads = 0):
+    """
+    Trait values of every diploid, as in :func:`ew2010_traits`.
+
+    :param pop: A :class:`fwdpy.fwdpy.Spop`
+    :param effects: A :class:`EW2010Effects` for pop, from :func:`ew2010_effects_dense`
+    :param nthreads: (0) The number of threads to use.  If 0, the number of hardware threads is used.
+
+    :rtype: A 1D NumPy array of trait values
+
+    Effects are summed once per gamete, and each diploid's value is the sum over its two gametes.
+    """
+    cdef vector[double] rv
+    with nogil:
+        rv = ew2010_traits_dense(pop.pop.get(),effects.data,nthreads)
+    return double_vector_to_array(rv)
+
+def ew2010_traits_grid(GSLrng rng, Spop pop, taus, sigmas, unsigned nthreads = 0, bint traits = False):
+    """
+    Evaluate the model of Eyre-Walker (2010) for every combination of tau and sigma in one pass over the population.
+
+    :param rng: A :class:`fwdpy.fwdpy.GSLrng`
+    :param pop: A :class:`fwdpy.fwdpy.Spop`
+    :param taus: A list of values of tau
+    :param sigmas: A list of values of sigma
+    :param nthreads: (0) The number of threads to use.  If 0, the number of hardware threads is used.
+    :param traits: (False) If True, also return the trait values.
+
+    :return: A pandas.DataFrame with one row per (tau, sigma) combination, and columns tau, sigma,
+        mean, variance, and corr_w (the correlation of trait value with fitness).  If traits is True, a tuple of
+        that DataFrame and an N x K NumPy array of trait values, with one column per row of the DataFrame.
+
+    Random numbers are shared across combinations: each selected mutation gets one random sign and one
+    standard normal deviate, z, and its effect for a given (tau, sigma) is as in :func:`ew2010_effects`,
+    with noise term sigma*z.  Differences among combinations are therefore not due to sampling noise
+    in the effects.
+    """
+    cdef vector[double] t,s
+    for tau in taus:
+        for sigma in sigmas:
+            t.push_back(tau)
+            s.push_back(sigma)
+    cdef ew_grid g
+    with nogil:
+        g = ew2010_traits_grid(rng.thisptr,pop.pop.get(),t,s,traits,nthreads)
+    df = pd.DataFrame({'tau':double_vector_to_array(g.tau),'sigma':double_vector_to_array(g.sigma),
+                       'mean':double_vector_to_array(g.mean),'variance':double_vector_to_array(g.variance),
+                       'corr_w':double_vector_to_array(g.corr_w)},
+                      columns=['tau','sigma','mean','variance','corr_w'])
+    if traits:
+        return (df,double_vector_to_array(g.traits).reshape(pop.popsize(),t.size()))
+    return df
@@ -1,6 +1,6 @@
 from fwdpy.fwdpp cimport popgenmut,gamete_base
 from fwdpy.fitness cimport SpopFitness
-from fwdpy.fwdpy cimport singlepop_t,sampler_base,singlepop_fitness,GSLrng_t
+from fwdpy.fwdpy cimport singlepop_t,sampler_base,singlepop_fitness,GSLrng_t,event_timeline,stop_condition
 from fwdpy.internal.internal cimport shwrappervec,region_manager
 from libcpp.vector cimport vector
 from libcpp.memory cimport shared_ptr,unique_ptr
@@ -28,4 +28,7 @@ cdef extern from "qtrait_evolve.hpp" namespace "fwdpy::qtrait" nogil:
 				   const double VS,
 				   const int interval,
 				   const region_manager * rm,
-				   const singlepop_fitness & fitness) except +
+				   const singlepop_fitness & fitness,
+				   const unsigned nthreads,
+				   const event_timeline * timeline,
+				   vector[unique_ptr[stop_condition]] * stops) except +
@@ -8,7 +8,10 @@ from libcpp.utility cimport pair
 from fwdpy.fwdpy cimport *
 from fwdpy.fitness cimport *
 from libc.math cimport sqrt
+from libc.string cimport memcpy
 import fwdpy.internal as internal
+import numpy as np
+import pandas as pd
 
 cdef inline double geomean(double a,double b) nogil:
     return sqrt(a*b)
@@ -51,6 +54,14 @@ cdef extern from "qtrait_pleiotropic.hpp" namespace "fwdpy::qtrait" nogil:
         
     map[double,ew_mut_details] ew2010_assign_effects(GSLrng_t * rng, const singlepop_t * pop, const double tau, const double sigma) except +
     vector[double] ew2010_traits_cpp(const singlepop_t * pop, const map[double,ew_mut_details] & effects) except +
+    cdef cppclass ew_effects:
+        vector[double] s,e,p
+    ew_effects ew2010_assign_effects_dense(GSLrng_t * rng, const singlepop_t * pop, const double tau, const double sigma) except +
+    vector[double] ew2010_traits_dense(const singlepop_t * pop, const ew_effects & effects, const unsigned nthreads) except +
+    cdef cppclass ew_grid:
+        vector[double] tau,sigma,mean,variance,corr_w,traits
+    ew_grid ew2010_traits_grid(GSLrng_t * rng, const singlepop_t * pop, const vector[double] & tau, const vector[double] & sigma,
+                               const bint keep_traits, const unsigned nthreads) except +
 
 include "evolve_qtraits.pyx"
 include "ew2010.pyx"
@@ -45,7 +45,9 @@ namespace fwdpy
             const double f, const double sigmaE, const double optimum,
             const double VS, const int interval,
             const internal::region_manager *rm,
-            const singlepop_fitness &fitness)
+            const singlepop_fitness &fitness, const unsigned nthreads,
+            const event_timeline *timeline,
+            std::vector<std::unique_ptr<stop_condition>> *stops)
         {
             if (neutral < 0. || selected < 0. || recrate < 0.)
                 {
@@ -58,12 +60,21 @@ namespace fwdpy
                     throw std::runtime_error("length of samplers != length of "
                                              "population container");
                 }
+            if (stops != nullptr && stops->size() != pops.size())
+                {
+                    throw std::runtime_error("length of stop conditions != "
+                                             "length of population container");
+                }
             if (f < 0. || f > 1.)
                 throw std::runtime_error(
                     "selfing probabilty must be 0<=f<=1.");
             if (interval < 0)
                 throw std::runtime_error(
                     "sampling interval must be non-negative");
+            if (!nthreads)
+                throw std::runtime_error(
+                    "number of threads per replicate must be > 0");
+            check_timeline<qtrait_model_rules>(timeline);
             std::vector<std::thread> threads;
             qtrait_model_rules rules(
                 sigmaE, optimum, VS,
@@ -74,6 +85,11 @@ namespace fwdpy
                     fitnesses.emplace_back(
                         std::unique_ptr<singlepop_fitness>(fitness.clone()));
                 }
+            // Replicates share the seed of the Philox streams used when
+            // nthreads > 1, and are told apart by their index.  It is only
+            // drawn when used, so that the other seeds do not change.
+            const unsigned long stream_seed
+                = (nthreads > 1) ? gsl_rng_get(rng->get()) : 0;
             for (std::size_t i = 0; i < pops.size(); ++i)
                 {
                     threads.emplace_back(std::thread(
@@ -86,10 +102,13 @@ namespace fwdpy
                             rm->callbacks),
                         KTfwd::extensions::discrete_rec_model(rm->rb, rm->rw,
                                                               rm->rw),
-                        std::ref(*samplers[i]), rules));
+                        std::ref(*samplers[i]), rules, nthreads, stream_seed,
+                        unsigned(i), timeline,
+                        (stops != nullptr) ? (*stops)[i].get() : nullptr));
                 }
             for (auto &t : threads)
                 t.join();
+            flush_samplers(samplers);
         }
     } // ns qtrait
 } // ns fwdpy
@@ -92,6 +92,7 @@ namespace fwdpy
                 {
                     t.join();
                 }
+            flush_samplers(samplers);
         }
 
         void
@@ -143,6 +144,7 @@ namespace fwdpy
                 {
                     t.join();
                 }
+            flush_samplers(samplers);
         }
     }
 }
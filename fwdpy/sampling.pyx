@@ -1,5 +1,6 @@
 from cython.operator cimport dereference as deref
 from fwdpy.fwdpp cimport sep_sample_t,sample_t,gsl_rng
+from cpython.buffer cimport PyBUF_WRITABLE
 import numpy as np
 import pandas as pd
 
@@ -267,6 +268,236 @@ def hapmatrix(p,const vector[size_t] & diploids, deme = None):
     else:
         raise RuntimeError("object type not understood")
 
+cdef class PackedHapMatrix:
+    """
+    A haplotype matrix stored at one bit per allele.
+
+    Rows are haplotypes and columns are mutations, sorted by position.
+    Rows 2i and 2i+1 are the two haplotypes of the i-th individual.
+    Fixed mutations are not included.
+
+    The bits are stored column-major in 64-bit words: column j is row j of
+    the 2d array returned by :func:`neutral` or :func:`selected`, and
+    haplotype i is bit i%64 of word i/64 of that row.  Those arrays share
+    memory with this object.  Use :func:`unpack` to get a 0/1 matrix.
+
+    Instances are returned by :func:`fwdpy.fwdpy.packed_hapmatrix`.
+    """
+    def __cinit__(self):
+        self.thisptr.reset(new packed_haplotype_matrix())
+    def neutral(self):
+        """
+        :return: The bits for neutral mutations as a 2d numpy array of dtype uint64 and shape (ncol_n, words_per_column).  No copy is made.
+        """
+        cdef packed_haplotype_matrix * hm = self.thisptr.get()
+        return np.asarray(make_packed_bits(self,&hm.n,hm.ncol_n,hm.words_per_column))
+    def selected(self):
+        """
+        :return: The bits for selected mutations as a 2d numpy array of dtype uint64 and shape (ncol_s, words_per_column).  No copy is made.
+        """
+        cdef packed_haplotype_matrix * hm = self.thisptr.get()
+        return np.asarray(make_packed_bits(self,&hm.s,hm.ncol_s,hm.words_per_column))
+    def unpack(self,bint selected = False):
+        """
+        :param selected: (False) If True, unpack selected mutations.  Otherwise, unpack neutral mutations.
+
+        :return: A 2d numpy array of dtype uint8 and shape (nrow, ncol) with 0 = ancestral and 1 = derived.
+        """
+        return unpack_bits(self.selected() if selected else self.neutral(),self.thisptr.get().nrow)
+    def details(self):
+        """
+        :return: A dict with the number of rows and columns, the positions and frequencies of each column, and
+        the genetic value (G), random value (E), and fitness (w) of each individual.  For selected mutations,
+        effect sizes (esizes) and dominance (h) are included.
+        """
+        cdef packed_haplotype_matrix * hm = self.thisptr.get()
+        return {'nrow':hm.nrow,'ncol_n':hm.ncol_n,'ncol_s':hm.ncol_s,
+                'words_per_column':hm.words_per_column,
+                'np':hm.np,'nf':hm.nf,'sp':hm.sp,'sf':hm.sf,
+                'G':hm.G,'E':hm.E,'w':hm.w,'esizes':hm.esizes,'h':hm.h}
+
+cdef class PackedBits:
+    """
+    Exposes a bit matrix owned by another object via the buffer protocol.
+    Holds a reference to the owner, so the memory stays valid while any view exists.
+    """
+    def __getbuffer__(self, Py_buffer * buffer, int flags):
+        if flags & PyBUF_WRITABLE:
+            raise BufferError("PackedBits is read-only")
+        buffer.buf = <char *>self.bits.data()
+        buffer.format = 'Q'
+        buffer.internal = NULL
+        buffer.itemsize = sizeof(uint64_t)
+        buffer.len = self.bits.size()*sizeof(uint64_t)
+        buffer.ndim = 2
+        buffer.obj = self
+        buffer.readonly = 1
+        buffer.shape = self.shape
+        buffer.strides = self.strides
+        buffer.suboffsets = NULL
+    def __releasebuffer__(self, Py_buffer * buffer):
+        pass
+
+cdef PackedBits make_packed_bits(object owner,vector[uint64_t] * bits,size_t nrow,size_t words_per_row):
+    """
+    Create a 2d (nrow x words_per_row) view of bits, which must be owned by owner.
+    """
+    rv = PackedBits()
+    rv.owner = owner
+    rv.bits = bits
+    rv.shape[0] = nrow
+    rv.shape[1] = words_per_row
+    rv.strides[0] = words_per_row*sizeof(uint64_t)
+    rv.strides[1] = sizeof(uint64_t)
+    return rv
+
+def unpack_bits(words,size_t n):
+    """
+    Unpack a 2d array of 64-bit words, as returned by :func:`fwdpy.fwdpy.PackedHapMatrix.neutral`,
+    into a 0/1 matrix with n rows and one column per row of words.
+    """
+    #Bit j of word w is row 64*w + j.  Viewing little-endian words as bytes keeps that order.
+    bytes_ = np.ascontiguousarray(words,dtype='<u8').view(np.uint8)
+    return np.unpackbits(bytes_,axis=1,bitorder='little')[:,:n].T
+
+cdef PackedHapMatrix packed_hapmatrix_single(const singlepop_t * pop,const vector[size_t] & diploids):
+    rv = PackedHapMatrix()
+    cdef packed_haplotype_matrix * hm = rv.thisptr.get()
+    with nogil:
+        hm[0] = make_packed_haplotype_matrix(pop,diploids)
+    return rv
+
+cdef PackedHapMatrix packed_hapmatrix_mloc(const multilocus_t * pop,const vector[size_t] & diploids):
+    rv = PackedHapMatrix()
+    cdef packed_haplotype_matrix * hm = rv.thisptr.get()
+    with nogil:
+        hm[0] = make_packed_haplotype_matrix(pop,diploids)
+    return rv
+
+cdef PackedHapMatrix packed_hapmatrix_meta(const metapop_t * pop,const vector[size_t] & diploids,const size_t deme):
+    rv = PackedHapMatrix()
+    cdef packed_haplotype_matrix * hm = rv.thisptr.get()
+    with nogil:
+        hm[0] = make_packed_haplotype_matrix(pop,diploids,deme)
+    return rv
+
+def packed_hapmatrix(p,diploids = None, deme = None):
+    """
+    Obtain a bit-packed haplotype matrix from a population object.
+
+    :param p: A population object or vector of such objects
+    :param diploids: (None) Indexes of individuals to include in matrix.  If None, the whole population (or deme) is used.
+    :param deme: Deme index (only needed if p represents a meta-population)
+
+    :return: A :class:`fwdpy.fwdpy.PackedHapMatrix`, or a list of them if p is a vector of populations.
+
+    This function contains the same information as :func:`fwdpy.fwdpy.hapmatrix`, but
+    uses 1 bit per allele and is much faster for large samples.
+
+    Example:
+
+    >>> import fwdpy
+    >>> import numpy as np
+    >>> rng = fwdpy.GSLrng(100)
+    >>> popsizes = np.array([1000]*1000,dtype=np.uint32)
+    >>> pop = fwdpy.evolve_regions(rng,1,1000,popsizes[0:],0.01,0.,0.001,[fwdpy.Region(0,1,1)],[],[fwdpy.Region(0,1,1)])
+    >>> m = fwdpy.packed_hapmatrix(pop[0])
+    >>> genotypes = m.unpack()
+    """
+    if isinstance(p,Spop):
+        return packed_hapmatrix_single((<Spop>p).pop.get(),
+            range(p.popsize()) if diploids is None else diploids)
+    elif isinstance(p,MlocusPop):
+        return packed_hapmatrix_mloc((<MlocusPop>p).pop.get(),
+            range(p.popsize()) if diploids is None else diploids)
+    elif isinstance(p,SpopVec) or isinstance(p,MlocusPopVec):
+        return [packed_hapmatrix(i,diploids) for i in p]
+    elif isinstance(p,MetaPop):
+        if deme is None:
+            raise RuntimeError("deme cannot be None")
+        return packed_hapmatrix_meta((<MetaPop>p).mpop.get(),
+            range(p.popsizes()[deme]) if diploids is None else diploids,deme)
+    elif isinstance(p,MetaPopVec):
+        return [packed_hapmatrix(i,diploids,deme) for i in p]
+    else:
+        raise RuntimeError("object type not understood")
+
+cdef class PackedSample:
+    """
+    A sample of chromosomes stored as positions plus a bit matrix.
+
+    Compared to the '0'/'1' strings returned by :func:`fwdpy.fwdpy.get_samples`, this
+    type needs 1 bit instead of 1 byte per chromosome per site.  The bit layout
+    is that of :class:`fwdpy.fwdpy.PackedHapMatrix`, with one row of words per site.
+
+    Instances are returned by :func:`fwdpy.fwdpy.get_packed_samples` and by :class:`fwdpy.fwdpy.PopSampler`.
+    """
+    def __len__(self):
+        return self.data.size()
+    def nsam(self):
+        """
+        :return: The number of chromosomes in the sample
+        """
+        return self.data.nsam
+    def positions(self):
+        """
+        :return: Positions of each site, as a numpy array
+        """
+        return np.array(self.data.pos)
+    def derived_counts(self):
+        """
+        :return: Number of derived alleles at each site, as a numpy array
+        """
+        return np.array(self.data.derived_counts(),dtype=np.uint32)
+    def bits(self):
+        """
+        :return: The bits as a 2d numpy array of dtype uint64 with one row per site.  No copy is made.
+        """
+        return np.asarray(make_packed_bits(self,&self.data.bits,self.data.size(),self.data.words_per_site))
+    def genotypes(self):
+        """
+        :return: A 2d numpy array of dtype uint8 and shape (nsam, number of sites) with 0 = ancestral and 1 = derived.
+        """
+        return unpack_bits(self.bits(),self.data.nsam)
+    def as_strings(self):
+        """
+        :return: The sample in the format returned by :func:`fwdpy.fwdpy.get_samples`: a list of (position, genotypes) tuples.
+        """
+        return self.data.to_strings()
+
+cdef PackedSample wrap_packed_sample(const packed_sample & s):
+    rv = PackedSample()
+    rv.data = s
+    return rv
+
+def get_packed_samples(GSLrng rng, PopType pop, unsigned nsam, bint removeFixed = True, locusBoundaries = None):
+    """
+    Take a sample from a population, stored as a :class:`fwdpy.fwdpy.PackedSample`.
+
+    :param rng: a :class:`GSLrng`
+    :param pop: A :class:`fwdpy.fwdpy.Spop` or :class:`fwdpy.fwdpy.MlocusPop`
+    :param nsam: The sample size to take.
+    :param removeFixed: if True, only polymorphic sites are retained
+    :param locusBoundaries: A list of (beg,end) tuples for each locus.  Required if pop is a :class:`fwdpy.fwdpy.MlocusPop`.
+
+    :return: A tuple of :class:`fwdpy.fwdpy.PackedSample` for neutral and selected mutations, respectively.  For a
+    multi-locus population, a list of such tuples, one per locus.
+
+    Individuals are sampled as for :func:`fwdpy.fwdpy.get_samples`, but the '0'/'1' strings are never built.  Odd values of nsam are allowed.
+    """
+    cdef packed_sep_sample_t s
+    cdef vector[packed_sep_sample_t] ms
+    if isinstance(pop,Spop):
+        s = packed_sample_separate(rng.thisptr.get(),deref((<Spop>pop).pop.get()),nsam,removeFixed)
+        return (wrap_packed_sample(s.first),wrap_packed_sample(s.second))
+    elif isinstance(pop,MlocusPop):
+        if locusBoundaries is None:
+            raise RuntimeError("locusBoundaries cannot be None for a multi-locus population")
+        ms = packed_sample_separate(rng.thisptr.get(),deref((<MlocusPop>pop).pop.get()),nsam,removeFixed,locusBoundaries)
+        return [(wrap_packed_sample(i.first),wrap_packed_sample(i.second)) for i in ms]
+    else:
+        raise ValueError("get_packed_samples: unsupported type of popcontainer")
+
 def genomatrix(const haplotype_matrix & m):
     """
     Generate a "genotype matrix" from a haplotype matrix
@@ -0,0 +1,74 @@
+cdef class StopCondition:
+    def __dealloc__(self):
+        clear_stop_conditions(self.vec)
+    def __len__(self):
+        return self.vec.size()
+    def get(self):
+        """
+        Retrieve the generation at which each replicate stopped.
+
+        :return: A list.  Elements are None for replicates that evolved to the end of nlist without meeting the condition.
+        """
+        rv = []
+        cdef size_t i=0
+        for i in range(self.vec.size()):
+            if self.vec[i].get().stopped():
+                rv.append(self.vec[i].get().generation)
+            else:
+                rv.append(None)
+        return rv
+
+cdef class TrackedMutationStop(StopCondition):
+    """
+    A :class:`fwdpy.fwdpy.StopCondition` met when a mutation fixes or is lost.
+
+    The mutation must be present when evolution starts, for example after a call to :func:`fwdpy.fwdpy.add_mutations`.
+    """
+    def __cinit__(self, unsigned n, double pos, when = "either"):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        :param pos: The position of the mutation
+        :param when: One of "fixed", "lost", or "either"
+
+        :raises: ValueError if when is not valid
+        """
+        if when not in ("fixed","lost","either"):
+            raise ValueError("when must be 'fixed', 'lost', or 'either'")
+        cdef bint on_fixation = when != "lost"
+        cdef bint on_loss = when != "fixed"
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[stop_condition]>unique_ptr[tracked_mutation_stop](new tracked_mutation_stop(pos,on_fixation,on_loss)))
+
+cdef class OptimumStop(StopCondition):
+    """
+    A :class:`fwdpy.fwdpy.StopCondition` met when the mean trait value is within epsilon of an optimum.
+
+    .. note:: Only meaningful for the quantitative trait simulations in :mod:`fwdpy.qtrait`.
+    """
+    def __cinit__(self, unsigned n, double optimum, double epsilon):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        :param optimum: The optimum trait value
+        :param epsilon: The tolerance
+
+        :raises: ValueError if epsilon < 0 or either value is not finite
+        """
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[stop_condition]>unique_ptr[optimum_stop](new optimum_stop(optimum,epsilon)))
+
+cdef class NoSelectedSitesStop(StopCondition):
+    """
+    A :class:`fwdpy.fwdpy.StopCondition` met when no selected mutation is segregating.
+    """
+    def __cinit__(self, unsigned n):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        """
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[stop_condition]>unique_ptr[no_selected_sites_stop](new no_selected_sites_stop()))
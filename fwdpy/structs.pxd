@@ -42,6 +42,38 @@ cdef extern from "sampler_additive_variance.hpp" namespace "fwdpy" nogil:
         unsigned generation
         unsigned N
 
+cdef extern from "sampler_windowed_stats.hpp" namespace "fwdpy" nogil:
+    cdef struct windowed_stats_data:
+        vector[unsigned] generation
+        vector[double] left
+        vector[double] right
+        vector[unsigned] S
+        vector[double] pi
+        vector[double] thetaW
+        vector[double] tajd
+        vector[double] thetaH
+        vector[double] H
+        vector[double] hapdiv
+        vector[unsigned] nhaps
+
+cdef extern from "sampler_sfs.hpp" namespace "fwdpy" nogil:
+    cdef struct sfs_data:
+        vector[unsigned] generation
+        vector[int] label
+        vector[int] neutral
+        vector[double] sfs
+        unsigned nsam
+
+cdef extern from "sampler_ld.hpp" namespace "fwdpy" nogil:
+    cdef struct ld_data:
+        vector[unsigned] generation
+        vector[double] bin_left
+        vector[double] bin_right
+        vector[unsigned long long] npairs
+        vector[double] mean_D
+        vector[double] mean_rsq
+        vector[double] mean_Dprime
+
 cdef extern from "allele_ages.hpp" namespace "fwdpy" nogil:
     cdef struct allele_age_data_t:
         double esize
@@ -66,3 +98,15 @@ cdef extern from "haplotype_matrix.hpp" namespace "fwdpy" nogil:
         size_t nrow
         size_t ncol_n
         size_t ncol_s
+
+cdef extern from "evolve_profile.hpp" namespace "fwdpy" nogil:
+    cdef struct evolve_profile:
+        bint enabled
+        unsigned long long generations
+        double sample_diploid, update_mutations, fitness, sampler
+        unsigned long long new_mutations, crossovers, recycled_mutations, recycled_gametes, gametes_allocated, sampler_calls, merged_gametes
+        unsigned long long gametes_before_dedup, gametes_after_dedup
+
+cdef extern from "gamete_dedup.hpp" namespace "fwdpy" nogil:
+    cdef struct gamete_dedup_result:
+        unsigned long long before, after
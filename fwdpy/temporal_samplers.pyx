@@ -81,7 +81,7 @@ cdef class PopSampler(TemporalSampler):
     A :class:`fwdpy.fwdpy.TemporalSampler` that takes a sample of size :math:`n \leq N` from the population.
     """
     def __cinit__(self, unsigned n, unsigned nsam,GSLrng
-            rng,removeFixed=True,neutral_file=None,selected_file=None,boundaries=None,append=False,recordSamples=True,recordDetails=True):
+            rng,removeFixed=True,neutral_file=None,selected_file=None,boundaries=None,append=False,recordSamples=True,recordDetails=True,packed=False,binary=False):
         """
         Constructor
         
@@ -93,10 +93,17 @@ cdef class PopSampler(TemporalSampler):
         :param selected_file: (None) File name prefix where selected data will be written in "ms" format.
         :param boundaries: (None) For a multi-locus simulation, this must be a list of tuples specifying the positional boundaries of each locus
         :param append: (False) Whether or not to append to output files, or over-write them.
+        :param packed: (False) If True, samples are stored as :class:`fwdpy.fwdpy.PackedSample`, using 1 bit per chromosome per site.
+        :param binary: (False) If True, files are written in a binary format rather than "ms" format.  See :func:`fwdpy.fwdpy.read_binary_samples`.
 
         ..note:: For each of the i threads, the ouput file names will be selected_file.i.gz, etc.
+
+        ..note:: Files are kept open and compressed on a background thread.  They are complete when the evolve
+            function or :func:`fwdpy.fwdpy.apply_sampler` returns.  Errors opening or writing files are raised
+            as RuntimeError at that point.
         """
         cdef cppstring sfile,nfile
+        self.packed=packed
         cdef vector[pair[double,double]] locus_boundaries
         if boundaries is not None:
             locus_boundaries=boundaries
@@ -110,16 +117,69 @@ cdef class PopSampler(TemporalSampler):
                 temp=neutral_file+'.'+str(i)+'.gz'
                 nfile=temp
             self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[sample_n](new
-                sample_n(nsam,rng.thisptr.get(),nfile,sfile,removeFixed,recordSamples,recordDetails,locus_boundaries,append)))
+                sample_n(nsam,rng.thisptr.get(),nfile,sfile,removeFixed,recordSamples,recordDetails,locus_boundaries,append,packed,binary)))
+    def flush(self):
+        """
+        Wait for all output to be written and close the output files.
+        They are re-opened in append mode if more samples are taken.
+        """
+        cdef size_t i=0
+        for i in range(self.vec.size()):
+            (<sample_n*>(self.vec[i].get())).flush()
     def get(self):
+        """
+        Retrieve the data from the sampler.
+
+        :return: A list of :class:`fwdpy.fwdpy.PopSamples`, one per replicate.  If the sampler was
+        constructed with packed=True, a list of lists is returned instead.  Each inner list has
+        one (neutral, selected, details) tuple per sample, where neutral and selected are
+        :class:`fwdpy.fwdpy.PackedSample`.
+        """
         rv=[]
         cdef size_t i=0
+        cdef size_t j=0
+        cdef packedPopSampleData pd
+        if self.packed:
+            for i in range(self.vec.size()):
+                pd = (<sample_n*>(self.vec[i].get())).packed_final()
+                ri=[]
+                for j in range(pd.get().size()):
+                    ri.append((wrap_packed_sample(deref(pd.get())[j].first.first),
+                        wrap_packed_sample(deref(pd.get())[j].first.second),
+                        deref(pd.get())[j].second))
+                rv.append(ri)
+            return rv
         for i in range(self.vec.size()):
             p=PopSamples()
             p.assign(<popSampleData>((<sample_n*>(self.vec[i].get())).final()))
             rv.append(p)
         return rv
 
+def read_binary_samples(filename):
+    """
+    Read samples written by a :class:`fwdpy.fwdpy.PopSampler` constructed with binary=True.
+
+    :param filename: The name of a file written by the sampler
+
+    :return: A list of (positions, genotypes) tuples, one per sample, where genotypes is a 2d numpy array of
+    dtype uint8 and shape (sample size, number of sites).
+    """
+    import gzip
+    with gzip.open(filename,'rb') as f:
+        data = f.read()
+    rv=[]
+    offset=0
+    while offset < len(data):
+        nsites,nsam = [int(i) for i in np.frombuffer(data,dtype=np.uint32,count=2,offset=offset)]
+        offset += 8
+        pos = np.frombuffer(data,dtype=np.float64,count=nsites,offset=offset)
+        offset += 8*nsites
+        words_per_site = (nsam+63)//64
+        words = np.frombuffer(data,dtype=np.uint64,count=nsites*words_per_site,offset=offset)
+        offset += 8*nsites*words_per_site
+        rv.append((pos.copy(),unpack_bits(words.reshape(nsites,words_per_site),nsam)))
+    return rv
+
 cdef class VASampler(TemporalSampler):
     """
     A :class:`fwdpy.fwdpy.TemporalSampler` that estimates the relationship between mutation frequency and total additive
@@ -211,6 +271,201 @@ cdef class FreqSampler(TemporalSampler):
                 rv.append(t)
             return rv
 
+cdef class WindowStatsSampler(TemporalSampler):
+    """
+    A :class:`fwdpy.fwdpy.TemporalSampler` that calculates summary statistics in windows.
+
+    The statistics are calculated directly from the population, without generating
+    "ms"-style samples, using either the entire population or a random sample of chromosomes.
+    """
+    def __cinit__(self,unsigned n,windows,GSLrng rng,unsigned nsam = 0,bint include_selected = False):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        :param windows: A list of non-overlapping tuples (left,right), each representing the half-open window [left,right).
+        :param rng: A :class:`fwdpy.fwdpy.GSLrng`.  Only used if nsam > 0.
+        :param nsam: (0) The number of chromosomes to sample without replacement.  If 0, the entire population is used.
+        :param include_selected: (False) If True, selected mutations are included.  Otherwise, only neutral mutations are used.
+
+        :raises: ValueError if windows overlap or nsam == 1.
+        """
+        cdef vector[pair[double,double]] w = windows
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[windowed_stats](new windowed_stats(rng.thisptr.get(),w,nsam,include_selected)))
+    def get(self):
+        """
+        Retrieve the data from the sampler.
+
+        :return: A list with one dict per replicate.  The keys are generation, left, right, S, pi, thetaW, tajd,
+        thetaH, H (Fay and Wu's unnormalized H, pi - thetaH), hapdiv (haplotype diversity), and nhaps (number of
+        distinct haplotypes).  Each value is a numpy array with one element per window per sampling time.
+
+        .. note:: Statistics are totals for each window, not per-site values.  tajd is NaN for windows with no segregating sites.
+        """
+        rv=[]
+        cdef windowed_stats_data d
+        cdef size_t i=0
+        for i in range(self.vec.size()):
+            d=(<windowed_stats*>(self.vec[i].get())).final()
+            stats=d
+            rv.append({k:np.array(v) for k,v in stats.items()})
+        return rv
+
+def get_windowed_stats(GSLrng rng,PopVec pops,windows,unsigned nsam = 0,bint include_selected = False):
+    """
+    Calculate summary statistics in windows for each population in a container.
+
+    Populations are processed in parallel.
+
+    :param rng: A :class:`fwdpy.fwdpy.GSLrng`.  Only used if nsam > 0.
+    :param pops: A :class:`fwdpy.fwdpy.SpopVec` or :class:`fwdpy.fwdpy.MlocusPopVec`
+    :param windows: A list of non-overlapping tuples (left,right), each representing the half-open window [left,right).
+    :param nsam: (0) The number of chromosomes to sample without replacement.  If 0, the entire population is used.
+    :param include_selected: (False) If True, selected mutations are included.  Otherwise, only neutral mutations are used.
+
+    :return: See :func:`fwdpy.fwdpy.WindowStatsSampler.get`
+
+    Example:
+
+    >>> import fwdpy
+    >>> import numpy as np
+    >>> rng = fwdpy.GSLrng(100)
+    >>> popsizes = np.array([1000]*1000,dtype=np.uint32)
+    >>> pops = fwdpy.evolve_regions(rng,4,1000,popsizes[0:],0.01,0.,0.001,[fwdpy.Region(0,1,1)],[],[fwdpy.Region(0,1,1)])
+    >>> stats = fwdpy.get_windowed_stats(rng,pops,[(i/10.,(i+1)/10.) for i in range(10)])
+    """
+    sampler = WindowStatsSampler(len(pops),windows,rng,nsam,include_selected)
+    apply_sampler(pops,sampler)
+    return sampler.get()
+
+cdef class SFSSampler(TemporalSampler):
+    """
+    A :class:`fwdpy.fwdpy.TemporalSampler` that records the expected site frequency spectrum (SFS) of a sample.
+
+    Mutation counts in the entire population are projected down to a sample of nsam chromosomes
+    via the hypergeometric distribution.  No samples are taken, and the result has no sampling noise.
+    """
+    def __cinit__(self,unsigned n,unsigned nsam,bint by_label = False):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        :param nsam: The sample size (number of chromosomes).
+        :param by_label: (False) If True, a separate SFS is recorded for each mutation label.
+
+        :raises: ValueError if nsam == 0.
+        """
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[sfs_sampler](new sfs_sampler(nsam,by_label)))
+    def get(self):
+        """
+        Retrieve the data from the sampler.
+
+        :return: A list with one dict per replicate.  'generation', 'label', and 'neutral' are 1d numpy arrays,
+        and 'sfs' is a 2d numpy array with one row per element of those arrays.  Column j of 'sfs' is the expected
+        number of sites with j derived copies in the sample, for j = 0 to nsam.  Each sampling time contributes a
+        row for neutral and a row for selected mutations, for each label.  'label' is -1 unless by_label was True.
+        """
+        rv=[]
+        cdef sfs_data d
+        cdef size_t i=0
+        for i in range(self.vec.size()):
+            d=(<sfs_sampler*>(self.vec[i].get())).final()
+            rv.append({'generation':np.array(d.generation),
+                       'label':np.array(d.label),
+                       'neutral':np.array(d.neutral,dtype=bool),
+                       'sfs':np.array(d.sfs).reshape(d.generation.size(),d.nsam+1)})
+        return rv
+
+cdef class LDSampler(TemporalSampler):
+    """
+    A :class:`fwdpy.fwdpy.TemporalSampler` that records linkage disequilibrium (LD) as a function of distance.
+
+    Pairwise D, :math:`r^2`, and D' are averaged over all pairs of sites within each distance bin.
+    """
+    def __cinit__(self,unsigned n,bin_edges,GSLrng rng,unsigned nind = 0,double minfreq = 0.,bint selected_focal = False):
+        """
+        Constructor
+
+        :param n: A length.  Must correspond to number of simulations that will be run simultaneously.
+        :param bin_edges: Increasing list of distances.  Bin i is [bin_edges[i],bin_edges[i+1]).
+        :param rng: A :class:`fwdpy.fwdpy.GSLrng`.  Only used if nind > 0.
+        :param nind: (0) Number of individuals to sample without replacement.  If 0, the entire population is used.
+        :param minfreq: (0) Sites with minor allele frequency less than minfreq are skipped.
+        :param selected_focal: (False) If True, only pairs involving at least one selected site are used.
+
+        :raises: ValueError if bin_edges has fewer than two elements or is not strictly increasing, or if minfreq is not in [0,0.5).
+        """
+        cdef vector[double] edges = bin_edges
+        for i in range(n):
+            self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[ld_sampler](new ld_sampler(rng.thisptr.get(),edges,nind,minfreq,selected_focal)))
+    def get(self):
+        """
+        Retrieve the data from the sampler.
+
+        :return: A list with one dict per replicate.  The keys are generation, bin_left, bin_right, npairs, mean_D,
+        mean_rsq, and mean_Dprime.  Each value is a numpy array with one element per distance bin per sampling time.
+
+        .. note:: D is calculated with respect to derived alleles.  Means are NaN for bins with no pairs of sites.
+        """
+        rv=[]
+        cdef ld_data d
+        cdef size_t i=0
+        for i in range(self.vec.size()):
+            d=(<ld_sampler*>(self.vec[i].get())).final()
+            stats=d
+            rv.append({k:np.array(v) for k,v in stats.items()})
+        return rv
+
+cdef class CompositeSampler(TemporalSampler):
+    """
+    A :class:`fwdpy.fwdpy.TemporalSampler` that applies several other samplers during the same simulation.
+
+    Samplers that can do so share data gathered in one traversal of the population per sampling event.
+    These are :class:`fwdpy.fwdpy.QtraitStatsSampler`, :class:`fwdpy.fwdpy.FreqSampler`, and
+    :class:`fwdpy.fwdpy.VASampler`.  Other samplers are applied as usual.
+
+    Example:
+
+    >>> import fwdpy as fp
+    >>> stats = fp.QtraitStatsSampler(4,0.0)
+    >>> freqs = fp.FreqSampler(4)
+    >>> s = fp.CompositeSampler([stats,freqs])
+    >>> #Pass s to an evolve function, then get data from each child:
+    >>> qstats,traj = s.get()
+    """
+    def __cinit__(self,samplers):
+        """
+        Constructor
+
+        :param samplers: A list of :class:`fwdpy.fwdpy.TemporalSampler`, all of the same length.
+
+        .. note:: The child samplers are not copied.  Data are retrieved from them, or via :func:`get`, as usual.
+        """
+        cdef size_t i
+        cdef vector[sampler_base *] children
+        self.samplers = list(samplers)
+        if len(self.samplers) == 0:
+            raise ValueError("at least one sampler is required")
+        for s in self.samplers:
+            if not isinstance(s,TemporalSampler):
+                raise ValueError("all samplers must be TemporalSampler types")
+            if (<TemporalSampler>s).size() != (<TemporalSampler>self.samplers[0]).size():
+                raise ValueError("all samplers must be the same length")
+        for i in range((<TemporalSampler>self.samplers[0]).size()):
+            children.clear()
+            for s in self.samplers:
+                children.push_back((<TemporalSampler>s).vec[i].get())
+            self.vec.push_back(<unique_ptr[sampler_base]>unique_ptr[composite_sampler](new composite_sampler(children)))
+    def get(self):
+        """
+        Retrieve the data from the sampler.
+
+        :return: A list containing the output of get() for each child sampler, in order.
+        """
+        return [s.get() for s in self.samplers]
+
 def apply_sampler(PopVec pops,TemporalSampler sampler):
     """
     Apply a temporal sampler to a container of populations.
@@ -0,0 +1,103 @@
+import unittest
+import fwdpy
+import numpy as np
+import os,tempfile
+
+N=100
+
+class test_add_mutations(unittest.TestCase):
+    def testMatchesAddMutation(self):
+        rng = np.random.RandomState(101)
+        pos = [0.4,0.1,0.3,0.2]
+        s = [0.0,-0.1,0.0,0.25]
+        hap = (rng.uniform(size=(2*N,len(pos)))<0.3).astype(np.uint8)
+        hap[0,:]=1
+        a = fwdpy.SpopVec(1,N)
+        b = fwdpy.SpopVec(1,N)
+        keys = fwdpy.add_mutations(a[0],pos,s,[1.0]*len(pos),hap)
+        self.assertEqual([fwdpy.view_mutations(a[0])[k]['pos'] for k in keys],pos)
+        for j in range(len(pos)):
+            rows = np.where(hap[:,j])[0]
+            fwdpy.add_mutation(b[0],list(rows//2),list(rows%2),pos[j],s[j],1.0)
+        va = fwdpy.view_diploids(a[0],list(range(N)))
+        vb = fwdpy.view_diploids(b[0],list(range(N)))
+        for i,j in zip(va,vb):
+            for c in ['chrom0','chrom1']:
+                for t in ['neutral','selected']:
+                    self.assertEqual(sorted(m['pos'] for m in i[c][t]),sorted(m['pos'] for m in j[c][t]))
+        n = dict((m['pos'],m['n']) for m in fwdpy.view_mutations(a[0]))
+        for j,p in enumerate(pos):
+            self.assertEqual(n[p],hap[:,j].sum())
+    def testDeduplicates(self):
+        a = fwdpy.SpopVec(1,N)
+        hap = np.ones((2*N,2),dtype=np.uint8)
+        fwdpy.add_mutations(a[0],[0.1,0.2],[0.0,0.0],[1.0,1.0],hap)
+        self.assertEqual(len(fwdpy.view_columnar(a[0])['gametes']['n']),1)
+    def testErrors(self):
+        a = fwdpy.SpopVec(1,N)
+        hap = np.ones((2*N,1),dtype=np.uint8)
+        fwdpy.add_mutations(a[0],[0.1],[0.0],[1.0],hap)
+        with self.assertRaises(RuntimeError):
+            fwdpy.add_mutations(a[0],[0.1],[0.0],[1.0],hap)
+        with self.assertRaises(ValueError):
+            fwdpy.add_mutations(a[0],[0.2],[0.0],[1.0],np.zeros((2*N,1),dtype=np.uint8))
+        with self.assertRaises(ValueError):
+            fwdpy.add_mutations(a[0],[0.2],[0.0],[1.0],np.ones((N,1),dtype=np.uint8))
+        self.assertEqual(len(fwdpy.view_mutations(a[0])),1)
+
+MS = """ms 4 2 -t 5
+1 2 3
+
+//
+segsites: 3
+positions: 0.1 0.1 0.5
+100
+010
+111
+001
+
+//
+segsites: 2
+positions: 0.2 0.9
+10
+10
+00
+01
+"""
+
+class test_init_from_ms(unittest.TestCase):
+    def setUp(self):
+        fd,self.fn = tempfile.mkstemp()
+        with os.fdopen(fd,'w') as f:
+            f.write(MS)
+    def tearDown(self):
+        os.remove(self.fn)
+    def testSpop(self):
+        p = fwdpy.SpopVec(1,2)
+        self.assertEqual(fwdpy.init_from_ms(p[0],self.fn,rep=1,beg=10.,end=20.),2)
+        m = fwdpy.view_mutations(p[0])
+        self.assertEqual(sorted(i['pos'] for i in m),[12.,19.])
+        self.assertEqual(sorted(i['n'] for i in m),[1,2])
+        self.assertTrue(all(i['neutral'] for i in m))
+        d = fwdpy.view_diploids(p[0],[0,1])
+        self.assertEqual([i['pos'] for i in d[1]['chrom1']['neutral']],[19.])
+    def testDuplicatePositions(self):
+        p = fwdpy.SpopVec(1,2)
+        fwdpy.init_from_ms(p[0],self.fn)
+        self.assertEqual(len(set(i['pos'] for i in fwdpy.view_mutations(p[0]))),3)
+    def testMlocus(self):
+        p = fwdpy.MlocusPopVec(1,2,2)
+        self.assertEqual(fwdpy.init_from_ms(p[0],self.fn,locus_boundaries=[(0,1),(1,2)]),5)
+    def testErrors(self):
+        p = fwdpy.SpopVec(1,3)
+        with self.assertRaises(ValueError):
+            fwdpy.init_from_ms(p[0],self.fn)
+        p = fwdpy.SpopVec(1,2)
+        with self.assertRaises(RuntimeError):
+            fwdpy.init_from_ms(p[0],self.fn,rep=2)
+        fwdpy.init_from_ms(p[0],self.fn)
+        with self.assertRaises(RuntimeError):
+            fwdpy.init_from_ms(p[0],self.fn)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -32,5 +32,165 @@ class EvolveRegions(unittest.TestCase):
         with self.assertRaises(RuntimeError):
             pops = fwdpy.evolve_regions(rng,1,1000,popsizes[0:],0.001,0.001,np.inf,nregions,sregions,rregions)
 
+class EvolveProfile(unittest.TestCase):
+    """
+    Timings and counters are only filled in by builds with profiling enabled
+    """
+    def test_profile(self):
+        pops = fwdpy.evolve_regions(rng,1,1000,popsizes[0:],0.001,0.0001,0.001,nregions,sregions,rregions)
+        p = pops[0].profile()
+        if p['enabled']:
+            self.assertEqual(p['generations'],len(popsizes))
+            self.assertTrue(p['new_mutations'] > 0)
+            self.assertTrue(p['fitness'] <= p['sample_diploid'])
+        else:
+            self.assertEqual(p['generations'],0)
+            self.assertEqual(p['sample_diploid'],0.)
+
+class EvolveTimeline(unittest.TestCase):
+    """
+    Events in an EventTimeline are applied during evolution
+    """
+    def test_popsize(self):
+        pops = fwdpy.SpopVec(1,1000)
+        t = fwdpy.EventTimeline()
+        t.popsize(3,500)
+        fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(1),popsizes[0:],
+                                     0.001,0.0001,0.001,nregions,sregions,rregions,0,
+                                     timeline=t)
+        self.assertEqual(pops[0].popsize(),500)
+        self.assertEqual(pops[0].gen(),len(popsizes))
+    def test_invalidEvents(self):
+        t = fwdpy.EventTimeline()
+        with self.assertRaises(ValueError):
+            t.popsize(1,0)
+        with self.assertRaises(ValueError):
+            t.selfing(1,1.5)
+        with self.assertRaises(ValueError):
+            t.recombination_rate(1,-1.0)
+        self.assertEqual(len(t),0)
+    def test_traitEventsNeedTraitModel(self):
+        pops = fwdpy.SpopVec(1,1000)
+        t = fwdpy.EventTimeline()
+        t.optimum(1,0.5)
+        with self.assertRaises(RuntimeError):
+            fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(1),popsizes[0:],
+                                         0.001,0.0001,0.001,nregions,sregions,rregions,0,
+                                         timeline=t)
+
+class EvolveStopConditions(unittest.TestCase):
+    """
+    Replicates stop evolving when their stop condition is met
+    """
+    def test_noSelectedSites(self):
+        pops = fwdpy.SpopVec(2,1000)
+        stop = fwdpy.NoSelectedSitesStop(2)
+        fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(2),popsizes[0:],
+                                     0.001,0.,0.001,nregions,sregions,rregions,0,
+                                     stop=stop)
+        self.assertEqual(stop.get(),[0,0])
+        self.assertEqual([p.gen() for p in pops],[0,0])
+    def test_trackedMutation(self):
+        pops = fwdpy.SpopVec(1,10)
+        hap = np.ones((20,1),dtype=np.uint8)
+        fwdpy.add_mutations(pops[0],[0.5],[0.],[1.],hap)
+        stop = fwdpy.TrackedMutationStop(1,0.5,"lost")
+        fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(1),popsizes[0:],
+                                     0.,0.,0.001,nregions,sregions,rregions,0,
+                                     stop=stop)
+        self.assertEqual(stop.get(),[None])
+        self.assertEqual(pops[0].gen(),len(popsizes))
+    def test_wrongLength(self):
+        pops = fwdpy.SpopVec(2,1000)
+        with self.assertRaises(RuntimeError):
+            fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(2),popsizes[0:],
+                                         0.001,0.,0.001,nregions,sregions,rregions,0,
+                                         stop=fwdpy.NoSelectedSitesStop(1))
+
+class EvolveUntil(unittest.TestCase):
+    """
+    Replicates are rolled back and evolved again when the restart condition is met
+    """
+    def test_maxAttempts(self):
+        pops = fwdpy.SpopVec(1,100)
+        restart = fwdpy.NoSelectedSitesStop(1)
+        attempts = fwdpy.evolve_regions_until(rng,pops,popsizes[0:],0.001,0.,0.001,
+                                              nregions,sregions,rregions,restart,max_attempts=3)
+        self.assertEqual(attempts,[3])
+        self.assertEqual(restart.get(),[0])
+        self.assertEqual(pops[0].gen(),0)
+    def test_noRestart(self):
+        pops = fwdpy.SpopVec(1,10)
+        hap = np.ones((20,1),dtype=np.uint8)
+        fwdpy.add_mutations(pops[0],[0.5],[0.],[1.],hap)
+        attempts = fwdpy.evolve_regions_until(rng,pops,popsizes[0:],0.,0.,0.001,
+                                              nregions,sregions,rregions,
+                                              fwdpy.TrackedMutationStop(1,0.5,"lost"))
+        self.assertEqual(attempts,[1])
+        self.assertEqual(pops[0].gen(),len(popsizes))
+    def test_rollback(self):
+        N = 100
+        nlist = np.array([N]*10,dtype=np.uint32)
+        pops = fwdpy.SpopVec(1,N)
+        fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(1),nlist[0:],
+                                     0.01,0.,0.001,nregions,[],rregions,0)
+        #A mutation that is lethal to heterozygotes is lost after one generation
+        hap = np.zeros((2*N,1),dtype=np.uint8)
+        hap[0,0] = 1
+        fwdpy.add_mutations(pops[0],[0.25],[-1.],[1.],hap)
+        gen = pops[0].gen()
+        mutations = fwdpy.view_mutations(pops[0])
+        gametes = fwdpy.view_gametes(pops[0])
+        restart = fwdpy.TrackedMutationStop(1,0.25,"lost")
+        attempts = fwdpy.evolve_regions_until(rng,pops,nlist[0:],0.01,0.,0.001,
+                                              nregions,[],rregions,restart,max_attempts=3)
+        self.assertEqual(attempts,[3])
+        self.assertEqual(restart.get(),[gen+1])
+        self.assertEqual(pops[0].gen(),gen)
+        self.assertEqual(fwdpy.view_mutations(pops[0]),mutations)
+        self.assertEqual(fwdpy.view_gametes(pops[0]),gametes)
+        self.assertEqual(fwdpy.check_popdata(pops[0]),{'check_sum':True,'popdata_sane':True})
+    def test_checkpointGeneration(self):
+        nlist = np.array([100]*10,dtype=np.uint32)
+        pops = fwdpy.SpopVec(1,100)
+        restart = fwdpy.NoSelectedSitesStop(1)
+        attempts = fwdpy.evolve_regions_until(rng,pops,nlist[0:],0.01,0.,0.001,
+                                              nregions,[],rregions,restart,max_attempts=2,
+                                              checkpoint_generation=3)
+        self.assertEqual(attempts,[2])
+        self.assertEqual(restart.get(),[3])
+        self.assertEqual(pops[0].gen(),3)
+    def test_checkpointGenerationOutOfRange(self):
+        pops = fwdpy.SpopVec(1,100)
+        with self.assertRaises(RuntimeError):
+            fwdpy.evolve_regions_until(rng,pops,popsizes[0:],0.001,0.,0.001,
+                                       nregions,[],rregions,fwdpy.NoSelectedSitesStop(1),
+                                       checkpoint_generation=len(popsizes))
+
+class DedupGametes(unittest.TestCase):
+    """
+    Merging identical gametes leaves the population in a valid state
+    """
+    def test_dedup(self):
+        pops = fwdpy.evolve_regions(rng,1,1000,popsizes[0:],0.001,0.0001,0.,nregions,sregions,rregions)
+        d = fwdpy.dedup_gametes(pops[0])
+        self.assertTrue(d['after'] <= d['before'])
+        self.assertEqual(fwdpy.check_popdata(pops[0]),{'check_sum':True,'popdata_sane':True})
+        d = fwdpy.dedup_gametes(pops[0])
+        self.assertEqual(d['after'],d['before'])
+    def test_dedupDuringEvolution(self):
+        pops = fwdpy.SpopVec(1,1000)
+        t = fwdpy.EventTimeline()
+        t.gamete_dedup_interval(0,1)
+        fwdpy.evolve_regions_sampler(rng,pops,fwdpy.NothingSampler(1),popsizes[0:],
+                                     0.001,0.0001,0.,nregions,sregions,rregions,0,
+                                     timeline=t)
+        self.assertEqual(fwdpy.check_popdata(pops[0]),{'check_sum':True,'popdata_sane':True})
+        d = fwdpy.dedup_gametes(pops[0])
+        self.assertEqual(d['after'],d['before'])
+        p = pops[0].profile()
+        self.assertTrue(p['gametes_before_dedup'] > 0)
+        self.assertEqual(p['merged_gametes'],p['gametes_before_dedup']-p['gametes_after_dedup'])
+
 if __name__ == '__main__':
     unittest.main()
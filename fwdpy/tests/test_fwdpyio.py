@@ -0,0 +1,48 @@
+import unittest
+import fwdpy
+import fwdpy.fwdpyio as fpio
+import numpy as np
+import gzip,os,tempfile
+
+nregions = [fwdpy.Region(0,1,1),fwdpy.Region(2,3,1)]
+sregions = [fwdpy.ExpS(1,2,1,-0.1),fwdpy.ExpS(1,2,0.01,0.001)]
+rregions = [fwdpy.Region(0,3,1)]
+rng = fwdpy.GSLrng(100)
+N=1000
+NGENS=100
+popsizes = np.array([N],dtype=np.uint32)
+popsizes=np.tile(popsizes,NGENS)
+pops = fwdpy.evolve_regions(rng,2,N,popsizes[0:],0.001,0.0001,0.001,nregions,sregions,rregions)
+
+class test_snapshots(unittest.TestCase):
+    def testRoundTrip(self):
+        d = tempfile.mkdtemp()
+        fn = os.path.join(d,'pop.gz')
+        ##Two populations in one file, using several threads
+        n0 = fpio.write_snapshot(pops[0],fn,False,4)
+        n1 = fpio.write_snapshot(pops[1],fn,True,4)
+        ##The file is valid gzip
+        with gzip.open(fn,'rb') as f:
+            self.assertEqual(len(f.read()),n0+n1)
+        p = fpio.read_snapshots([fn,fn],'single',[0,n0],3)
+        self.assertEqual(fpio.serialize(p[0]),fpio.serialize(pops[0]))
+        self.assertEqual(fpio.serialize(p[1]),fpio.serialize(pops[1]))
+    def testSerializerOffsets(self):
+        """
+        BGZF and plain gzip output of gzSerializer must give the same populations
+        """
+        d = tempfile.mkdtemp()
+        for bgzf in (False,True):
+            base = os.path.join(d,'bgzf' if bgzf else 'gz')
+            s = fpio.gzSerializer(len(pops),base,bgzf)
+            fwdpy.apply_sampler(pops,s)
+            fwdpy.apply_sampler(pops,s)
+            offsets = s.get()
+            for i in range(len(pops)):
+                fn = base+'.'+str(i)+'.gz'
+                for gen,offset in offsets[i]:
+                    p = fpio.read_snapshots([fn],'single',[offset])
+                    self.assertEqual(fpio.serialize(p[0]),fpio.serialize(pops[i]))
+
+if __name__ == '__main__':
+    unittest.main()
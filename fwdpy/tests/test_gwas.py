@@ -0,0 +1,45 @@
+import unittest
+import fwdpy
+import fwdpy.gwas as gwas
+import numpy as np
+
+nregions = [fwdpy.Region(0,1,1),fwdpy.Region(2,3,1)]
+sregions = [fwdpy.ExpS(1,2,1,-0.1),fwdpy.ExpS(1,2,0.01,0.001)]
+rregions = [fwdpy.Region(0,3,1)]
+rng = fwdpy.GSLrng(100)
+N=1000
+NGENS=100
+popsizes = np.array([N],dtype=np.uint32)
+popsizes=np.tile(popsizes,NGENS)
+pops = fwdpy.evolve_regions(rng,2,N,popsizes[0:],0.001,0.0001,0.001,nregions,sregions,rregions)
+
+class test_association_scan(unittest.TestCase):
+    def testMatchesLstsq(self):
+        scans = gwas.association_scan(pops)
+        self.assertEqual(len(scans),len(pops))
+        for g,s in zip(gwas.genotype_matrices(pops),scans):
+            y = np.array(g['G'])+np.array(g['E'])
+            pos = np.concatenate((g['npos'],g['cpos']))
+            geno = np.concatenate((np.array(g['neutral']).reshape(N,g['n_neutral']),
+                                   np.array(g['causative']).reshape(N,g['n_causative'])),axis=1)
+            order = np.argsort(pos,kind='mergesort')
+            self.assertTrue((s.pos.values==pos[order]).all())
+            for j,col in enumerate(order):
+                x = geno[:,col]
+                if x.var() == 0.:
+                    self.assertTrue(np.isnan(s.beta.values[j]))
+                    continue
+                X = np.column_stack((np.ones(N),x))
+                coef,rss = np.linalg.lstsq(X,y)[0:2]
+                se = np.sqrt(rss[0]/(N-2)/((x-x.mean())**2).sum())
+                self.assertAlmostEqual(s.beta.values[j],coef[1])
+                self.assertAlmostEqual(s.se.values[j],se)
+    def testMinFreq(self):
+        s = gwas.association_scan(pops,0.05)[0]
+        self.assertTrue((np.minimum(s.freq,1.-s.freq)>=0.05).all())
+    def testBadMinFreq(self):
+        with self.assertRaises(ValueError):
+            gwas.association_scan(pops,0.6)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,59 @@
+import unittest
+import fwdpy
+import fwdpy.gwas as gwas
+from fwdpy.GenoMatrixSampler import GenoMatrixSampler
+import numpy as np
+import os,tempfile
+
+nregions = [fwdpy.Region(0,1,1),fwdpy.Region(2,3,1)]
+sregions = [fwdpy.ExpS(1,2,1,-0.1),fwdpy.ExpS(1,2,0.01,0.001)]
+rregions = [fwdpy.Region(0,3,1)]
+rng = fwdpy.GSLrng(100)
+N=1001
+NGENS=100
+popsizes = np.array([N],dtype=np.uint32)
+popsizes=np.tile(popsizes,NGENS)
+pops = fwdpy.evolve_regions(rng,1,N,popsizes[0:],0.001,0.0001,0.001,nregions,sregions,rregions)
+
+def read_bed(stub,nind):
+    """
+    Decode a .bed file into an nind x nvariants matrix of derived allele counts
+    """
+    b = np.fromfile(stub+'.bed',dtype=np.uint8)
+    assert list(b[:3]) == [0x6c,0x1b,0x01]
+    nbytes = (nind+3)//4
+    b = b[3:].reshape(-1,nbytes)
+    codes = np.zeros((b.shape[0],4*nbytes),dtype=np.uint8)
+    for i in range(4):
+        codes[:,i::4] = (b>>(2*i))&3
+    counts = np.array([2,-1,1,0])[codes[:,:nind]]
+    return counts.T
+
+class test_plink(unittest.TestCase):
+    def testMatchesGenotypeMatrix(self):
+        d = tempfile.mkdtemp()
+        stub = os.path.join(d,'pop')
+        nvariants = gwas.to_plink(pops[0],stub)
+        g = gwas.genotype_matrices(pops)[0]
+        pos = np.concatenate((g['npos'],g['cpos']))
+        geno = np.concatenate((np.array(g['neutral']).reshape(N,g['n_neutral']),
+                               np.array(g['causative']).reshape(N,g['n_causative'])),axis=1)
+        order = np.argsort(pos,kind='mergesort')
+        self.assertEqual(nvariants,len(pos))
+        self.assertTrue((read_bed(stub,N)==geno[:,order]).all())
+        bim = [l.split() for l in open(stub+'.bim')]
+        self.assertEqual([float(i[1]) for i in bim],list(pos[order]))
+        fam = [l.split() for l in open(stub+'.fam')]
+        self.assertEqual(len(fam),N)
+    def testGenoMatrixSampler(self):
+        d = tempfile.mkdtemp()
+        stub = os.path.join(d,'gm')
+        s = GenoMatrixSampler(len(pops))
+        fwdpy.apply_sampler(pops,s)
+        s.toplink(stub)
+        gen,m = s.get()[0]
+        counts = read_bed(stub+'.generation'+str(gen)+'.rep0',N)
+        self.assertTrue((counts==m[:,1:]).all())
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,6 +1,7 @@
 try:
     import fwdpy.qtrait
     import fwdpy.fitness
+    import fwdpy.fwdpyio as fpio
     import unittest
     import array
     #Some basic setup
@@ -32,7 +33,59 @@ try:
         def testUniformHi(self):
             with self.assertRaises(RuntimeError):
                 fwdpy.qtrait.evolve_regions_qtrait_sampler_fitness(rng,pops,n,f,nlist[0:],0,0.001,0.,[],[fwdpy.UniformS(0,1,1,-0.2,-0.1)],[],1,0.025)
-                
+
+    class ParallelOffspring(unittest.TestCase):
+        """
+        With nthreads > 1, output must not depend on the number of threads.
+        """
+        def testThreadCountIndependence(self):
+            nl = array.array('I',[2500]*20)
+            nregions = [fwdpy.Region(0,1,1)]
+            sregions = [fwdpy.GaussianS(0,1,1,0.25)]
+            recregions = [fwdpy.Region(0,1,1)]
+            results = []
+            for nthreads in [2,3]:
+                r = fwdpy.GSLrng(42)
+                p = fwdpy.qtrait.evolve_regions_qtrait(r,1,2500,nl[0:],0.01,0.001,0.5,
+                                                       nregions,sregions,recregions,
+                                                       0.1,nthreads=nthreads)
+                results.append(fpio.serialize(p[0]))
+            self.assertEqual(results[0],results[1])
+        def testZeroThreads(self):
+            with self.assertRaises(RuntimeError):
+                fwdpy.qtrait.evolve_regions_qtrait_sampler_fitness(rng,pops,n,fwdpy.qtrait.SpopAdditiveTrait(),nlist[0:],0,0.001,0.,[],[fwdpy.GaussianS(0,1,1,0.25)],[],1,0.025,nthreads=0)
+
+
+    class EW2010Dense(unittest.TestCase):
+        """
+        Dense effects and traits must match the position-keyed versions.
+        """
+        def testMatchesMap(self):
+            import numpy as np
+            nl = np.array([1000]*100,dtype=np.uint32)
+            p = fwdpy.evolve_regions(fwdpy.GSLrng(5),1,1000,nl[0:],0.001,0.001,0.001,
+                                     [fwdpy.Region(0,1,1)],[fwdpy.ExpS(0,1,1,-0.01)],[fwdpy.Region(0,1,1)])
+            e1 = fwdpy.qtrait.ew2010_effects(fwdpy.GSLrng(7),p[0],0.5,1.0)
+            e2 = fwdpy.qtrait.ew2010_effects_dense(fwdpy.GSLrng(7),p[0],0.5,1.0)
+            self.assertEqual(len(e1),np.count_nonzero(~np.isnan(e2.e)))
+            t1 = np.array(fwdpy.qtrait.ew2010_traits(p[0],e1))
+            for nthreads in [0,1,4]:
+                t2 = fwdpy.qtrait.ew2010_traits_dense(p[0],e2,nthreads)
+                self.assertEqual(len(t1),1000)
+                self.assertTrue(np.allclose(t1,t2))
+        def testGrid(self):
+            import numpy as np
+            nl = np.array([1000]*100,dtype=np.uint32)
+            p = fwdpy.evolve_regions(fwdpy.GSLrng(5),1,1000,nl[0:],0.001,0.001,0.001,
+                                     [fwdpy.Region(0,1,1)],[fwdpy.ExpS(0,1,1,-0.01)],[fwdpy.Region(0,1,1)])
+            df,t = fwdpy.qtrait.ew2010_traits_grid(fwdpy.GSLrng(7),p[0],[0.,0.5,1.],[0.,1.],traits=True)
+            self.assertEqual(len(df),6)
+            self.assertEqual(t.shape,(1000,6))
+            self.assertTrue(np.allclose(df['mean'],t.mean(axis=0)))
+            self.assertTrue(np.allclose(df['variance'],t.var(axis=0,ddof=1)))
+            #Random numbers are shared, so a grid point does not depend on the others
+            df1 = fwdpy.qtrait.ew2010_traits_grid(fwdpy.GSLrng(7),p[0],[0.5],[0.])
+            self.assertTrue(np.allclose(df1['mean'],df['mean'][2]))
 except ImportError:
     pass
 
@@ -64,6 +64,48 @@ class test_sample_details(unittest.TestCase):
                     EP=mmi['n']/float(2000) #"expected" frequency
                     self.assertEqual(EP,details[i]['p'][j])
 
+class test_DetailsMatchLinearSearch(unittest.TestCase):
+    """
+    Sample details must match a linear search of the fixations and then the
+    mutations, as done by find_variant.  Quantitative trait simulations keep
+    selected fixations in the population, so that some positions are shared
+    by a fixation and a segregating mutation.
+    """
+    @classmethod
+    def setUpClass(cls):
+        import fwdpy.qtrait as qt
+        cls.N = 100
+        qnlist = np.array([cls.N]*20*cls.N,dtype=np.uint32)
+        cls.pops = qt.evolve_regions_qtrait(rng,2,cls.N,qnlist[0:],0.,0.01,0.01,
+                                            [],[fp.GaussianS(0,1,1,0.05)],[fp.Region(0,1,1)],0.5)
+    def linear_search(self,pop,pos):
+        for m in fp.view_fixations(pop):
+            if m['pos'] == pos:
+                return (m['s'],m['h'],m['g'],m['label'],1.0,m['ftime']-m['g']+1)
+        for m in fp.view_mutations(pop):
+            if m['pos'] == pos:
+                return (m['s'],m['h'],m['g'],m['label'],m['n']/(2.0*self.N),4294967295)
+        self.fail("position not found")
+    def check(self,pop,selected,details):
+        for i,site in enumerate(selected):
+            self.assertEqual((details['s'][i],details['h'][i],details['origin'][i],details['label'][i],
+                              details['p'][i],details['ftime'][i]),
+                             self.linear_search(pop,site[0]))
+    def test_SharedPositions(self):
+        for pop in self.pops:
+            fixed = set(m['pos'] for m in fp.view_fixations(pop))
+            self.assertTrue(any(m['pos'] in fixed for m in fp.view_mutations(pop)))
+    def test_GetSampleDetails(self):
+        for pop in self.pops:
+            sample = fp.get_samples(rng,pop,20,removeFixed=False)
+            self.check(pop,sample[1],fp.get_sample_details(sample[1],pop))
+    def test_PopSampler(self):
+        sampler = fp.PopSampler(len(self.pops),20,rng,removeFixed=False,recordDetails=True)
+        fp.apply_sampler(self.pops,sampler)
+        for pop,r in zip(self.pops,sampler.get()):
+            for sample,details in r.data():
+                self.check(pop,sample[1],details)
+
 class test_Fixations(unittest.TestCase):
     def test_CountFixationsInSample1(self):
         """
@@ -141,5 +183,243 @@ class test_Fixations(unittest.TestCase):
             for j in i:
                 self.assertTrue(j[1].count(b'1')<100)
                 
+class test_PackedHapMatrix(unittest.TestCase):
+    def test_MatchesHapMatrix(self):
+        """
+        The packed matrix must contain the same genotypes
+        as the index-based representation.
+        """
+        diploids = list(range(0,N,7))
+        for pop in pops:
+            h = fp.hapmatrix(pop,diploids)
+            m = fp.packed_hapmatrix(pop,diploids)
+            d = m.details()
+            self.assertEqual(d['nrow'],h['nrow'])
+            self.assertEqual(d['ncol_n'],h['ncol_n'])
+            self.assertEqual(d['ncol_s'],h['ncol_s'])
+            self.assertEqual(list(d['np']),list(h['np']))
+            self.assertEqual(list(d['sp']),list(h['sp']))
+            for bits,idx,ncol in ((m.unpack(),h['n'],h['ncol_n']),
+                                  (m.unpack(True),h['s'],h['ncol_s'])):
+                dense = np.zeros(h['nrow']*ncol,dtype=np.uint8)
+                dense[list(idx)]=1
+                self.assertTrue(np.array_equal(bits,dense.reshape(h['nrow'],ncol)))
+    def test_ZeroCopy(self):
+        m = fp.packed_hapmatrix(pops[0])
+        d = m.details()
+        n = m.neutral()
+        self.assertEqual(d['nrow'],2*N)
+        self.assertEqual(n.dtype,np.uint64)
+        self.assertEqual(n.shape,(d['ncol_n'],d['words_per_column']))
+        self.assertFalse(n.flags.writeable)
+        self.assertFalse(n.flags.owndata)
+        ##Each column's derived allele count equals its frequency times 2N
+        counts = m.unpack().sum(axis=0)
+        self.assertTrue(np.allclose(counts,np.array(d['nf'])*2*N))
+
+class test_PackedSample(unittest.TestCase):
+    def test_MatchesStrings(self):
+        """
+        Derived allele counts and unpacked genotypes
+        must agree with the string representation.
+        """
+        for pop in pops:
+            for nsam in (50,101):
+                for s in fp.get_packed_samples(rng,pop,nsam):
+                    self.assertEqual(s.nsam(),nsam)
+                    strings = s.as_strings()
+                    self.assertEqual(len(strings),len(s))
+                    self.assertEqual([i[0] for i in strings],list(s.positions()))
+                    counts = [i[1].count(b'1') for i in strings]
+                    self.assertEqual(counts,list(s.derived_counts()))
+                    self.assertEqual(counts,list(s.genotypes().sum(axis=0)))
+                    ##removeFixed = True
+                    self.assertTrue(all(0 < i < nsam for i in counts))
+    def test_PopSampler(self):
+        popsizes = np.array([N]*10,dtype=np.uint32)
+        p = fp.SpopVec(2,N)
+        sampler = fp.PopSampler(len(p),50,rng,packed=True)
+        fp.evolve_regions_sampler(rng,p,sampler,popsizes[0:],0.005,0.01,0.005,nregions,sregions,recregions,5)
+        for r in sampler.get():
+            self.assertTrue(len(r)>0)
+            for neutral,selected,details in r:
+                self.assertEqual(len(details['dcount']),len(selected))
+                self.assertEqual(list(details['dcount']),list(selected.derived_counts()))
+    def test_BinaryFile(self):
+        """
+        Samples written in binary format must match those recorded in memory.
+        """
+        import os,tempfile
+        d = tempfile.mkdtemp()
+        prefix = os.path.join(d,'neutral')
+        sampler = fp.PopSampler(len(pops),20,rng,neutral_file=prefix,binary=True)
+        fp.apply_sampler(pops,sampler)
+        fp.apply_sampler(pops,sampler)
+        for i,p in enumerate(sampler.get()):
+            recorded = [j[0][0] for j in p.data()]
+            written = fp.read_binary_samples(prefix+'.'+str(i)+'.gz')
+            self.assertEqual(len(recorded),len(written))
+            for r,(pos,geno) in zip(recorded,written):
+                self.assertEqual([j[0] for j in r],list(pos))
+                self.assertEqual([j[1].count(b'1') for j in r],list(geno.sum(axis=0)))
+    def test_UnwritableFile(self):
+        """
+        Errors writing output are raised on the calling thread.
+        """
+        import os,tempfile
+        prefix = os.path.join(tempfile.mkdtemp(),'missing','neutral')
+        sampler = fp.PopSampler(len(pops),20,rng,neutral_file=prefix,append=True)
+        with self.assertRaises(RuntimeError):
+            fp.apply_sampler(pops,sampler)
+        p = fp.SpopVec(2,N)
+        sampler = fp.PopSampler(len(p),20,rng,neutral_file=prefix,append=True)
+        with self.assertRaises(RuntimeError):
+            fp.evolve_regions_sampler(rng,p,sampler,nlist[0:10],0.005,0.01,0.005,nregions,sregions,recregions,5)
+
+class test_WindowedStats(unittest.TestCase):
+    def test_WholePopulationMatchesView(self):
+        """
+        S and pi from the entire population must match
+        what we get from the mutation views.
+        """
+        windows = [(0,0.5),(0.5,1)]
+        stats = fp.get_windowed_stats(rng,pops,windows)
+        self.assertEqual(len(stats),len(pops))
+        n = 2*N
+        for i in range(len(pops)):
+            self.assertEqual(list(stats[i]['generation']),[pops[i].gen()]*len(windows))
+            for w in range(len(windows)):
+                seg = [m for m in mviews[i] if m['neutral'] and 0 < m['n'] < n and windows[w][0] <= m['pos'] < windows[w][1]]
+                self.assertEqual(stats[i]['S'][w],len(seg))
+                pi = sum([2.*m['n']*(n-m['n'])/(n*(n-1.)) for m in seg])
+                self.assertAlmostEqual(stats[i]['pi'][w],pi)
+                self.assertTrue(0. <= stats[i]['hapdiv'][w] <= 1.)
+    def test_Sample(self):
+        windows = [(0,0.5),(0.5,1)]
+        whole = fp.get_windowed_stats(rng,pops,windows)
+        sampled = fp.get_windowed_stats(rng,pops,windows,nsam=50)
+        for i,j in zip(whole,sampled):
+            self.assertTrue(all(j['S'] <= i['S']))
+            self.assertTrue(all(j['nhaps'] <= 50))
+    def test_OverlappingWindows(self):
+        with self.assertRaises(ValueError):
+            fp.WindowStatsSampler(1,[(0,0.6),(0.5,1)],rng)
+
+class test_SFSSampler(unittest.TestCase):
+    def test_ProjectionSums(self):
+        """
+        Each mutation contributes probabilities summing to one,
+        so each SFS sums to the number of mutations of that type.
+        """
+        nsam = 20
+        sampler = fp.SFSSampler(len(pops),nsam)
+        fp.apply_sampler(pops,sampler)
+        for i,d in zip(range(len(pops)),sampler.get()):
+            self.assertEqual(d['sfs'].shape,(2,nsam+1))
+            for row in range(2):
+                n = len([m for m in mviews[i] if m['neutral'] == d['neutral'][row]])
+                self.assertAlmostEqual(d['sfs'][row].sum(),n,places=6)
+    def test_SampleSizeZero(self):
+        with self.assertRaises(ValueError):
+            fp.SFSSampler(1,0)
+
+class test_LDSampler(unittest.TestCase):
+    def test_MatchesHapMatrix(self):
+        """
+        Compare to r^2 calculated from the
+        unpacked haplotype matrix
+        """
+        edges = [0.,0.1,0.5]
+        sampler = fp.LDSampler(len(pops),edges,rng,minfreq=0.05)
+        fp.apply_sampler(pops,sampler)
+        for pop,d in zip(pops,sampler.get()):
+            m = fp.packed_hapmatrix(pop)
+            pos = np.array(m.details()['np'])
+            h = m.unpack().astype(np.float64)
+            p = h.mean(axis=0)
+            keep = np.minimum(p,1.-p) >= 0.05
+            pos,h,p = pos[keep],h[:,keep],p[keep]
+            for b in range(len(edges)-1):
+                rsq = []
+                for i in range(len(pos)):
+                    for j in range(i+1,len(pos)):
+                        if edges[b] <= abs(pos[j]-pos[i]) < edges[b+1]:
+                            D = (h[:,i]*h[:,j]).mean()-p[i]*p[j]
+                            rsq.append(D**2/(p[i]*(1-p[i])*p[j]*(1-p[j])))
+                self.assertEqual(d['npairs'][b],len(rsq))
+                if len(rsq) > 0:
+                    self.assertAlmostEqual(d['mean_rsq'][b],np.mean(rsq))
+    def test_BadEdges(self):
+        with self.assertRaises(ValueError):
+            fp.LDSampler(1,[0.5,0.1],rng)
+
+class test_QtraitStatsMlocus(unittest.TestCase):
+    def test_UnloadedFraction(self):
+        """
+        Each diploid is counted once over all loci, and fixations are not deleterious.
+        """
+        p = fp.MlocusPopVec(1,4,2)
+        hap = np.zeros((8,3),dtype=np.uint8)
+        hap[0,0] = 1 #Individual 0, locus 0
+        hap[2,1] = 1 #Individual 1, locus 1
+        hap[:,2] = 1 #Fixed, locus 0
+        fp.add_mutations(p[0],[0.5,1.5,0.25],[-0.1,-0.1,-0.1],[1.,1.,1.],hap,
+                         locus_boundaries=[(0,1),(1,2)])
+        qs = fp.QtraitStatsSampler(len(p),0.0)
+        fp.apply_sampler(p,qs)
+        f0 = [i['value'] for i in qs.get()[0] if i['stat'] == b'f0']
+        self.assertEqual(f0,[0.5])
+
+class test_CompositeSampler(unittest.TestCase):
+    def test_MatchesSeparateSamplers(self):
+        qs = fp.QtraitStatsSampler(len(pops),0.0)
+        fs = fp.FreqSampler(len(pops))
+        ss = fp.SFSSampler(len(pops),20)
+        fp.apply_sampler(pops,qs)
+        fp.apply_sampler(pops,fs)
+        fp.apply_sampler(pops,ss)
+        c = fp.CompositeSampler([fp.QtraitStatsSampler(len(pops),0.0),
+                                 fp.FreqSampler(len(pops)),
+                                 fp.SFSSampler(len(pops),20)])
+        fp.apply_sampler(pops,c)
+        cq,cf,cs = c.get()
+        for a,b in zip(qs.get(),cq):
+            self.assertTrue(pd.DataFrame(a).equals(pd.DataFrame(b)))
+        for a,b in zip(fs.get(),cf):
+            self.assertEqual(a.data(),b.data())
+        for a,b in zip(ss.get(),cs):
+            self.assertTrue((a['sfs']==b['sfs']).all())
+    def test_MlocusMatchesSeparateSamplers(self):
+        mpops = fp.MlocusPopVec(2,50,2)
+        r = np.random.RandomState(42)
+        for p in mpops:
+            hap = (r.uniform(size=(100,20)) < 0.2).astype(np.uint8)
+            hap[0,:] = 1
+            pos = list(r.uniform(0,2,20))
+            fp.add_mutations(p,pos,list(r.normal(0,0.1,20)),[1.]*20,hap,
+                             locus_boundaries=[(0,1),(1,2)])
+        qs = fp.QtraitStatsSampler(len(mpops),0.0)
+        fs = fp.FreqSampler(len(mpops))
+        ss = fp.SFSSampler(len(mpops),20)
+        fp.apply_sampler(mpops,qs)
+        fp.apply_sampler(mpops,fs)
+        fp.apply_sampler(mpops,ss)
+        c = fp.CompositeSampler([fp.QtraitStatsSampler(len(mpops),0.0),
+                                 fp.FreqSampler(len(mpops)),
+                                 fp.SFSSampler(len(mpops),20)])
+        fp.apply_sampler(mpops,c)
+        cq,cf,cs = c.get()
+        for a,b in zip(qs.get(),cq):
+            self.assertTrue(pd.DataFrame(a).equals(pd.DataFrame(b)))
+        for a,b in zip(fs.get(),cf):
+            self.assertEqual(a.data(),b.data())
+        for a,b in zip(ss.get(),cs):
+            self.assertTrue((a['sfs']==b['sfs']).all())
+    def test_BadLengths(self):
+        with self.assertRaises(ValueError):
+            fp.CompositeSampler([fp.FreqSampler(1),fp.FreqSampler(2)])
+        with self.assertRaises(ValueError):
+            fp.CompositeSampler([])
+
 if __name__ == '__main__':
     unittest.main()
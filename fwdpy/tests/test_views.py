@@ -32,6 +32,48 @@ class test_singlepop_views(unittest.TestCase):
             fwdpy.view_diploids(pops[0],[pops[0].popsize()])
     def testFixationViews(self):
         temp = fwdpy.view_fixations(pops[0])
+class test_columnar_views(unittest.TestCase):
+    def testMutations(self):
+        v = fwdpy.view_columnar(pops[0])
+        muts = fwdpy.view_mutations(pops[0])
+        self.assertEqual(len(v['mutations']),len(muts))
+        self.assertEqual(sorted(v['mutations']['pos']),sorted([m['pos'] for m in muts]))
+        self.assertEqual(v['mutations']['n'].sum(),sum([m['n'] for m in muts]))
+    def testGametes(self):
+        v = fwdpy.view_columnar(pops[0])
+        g = v['gametes']
+        gams = fwdpy.view_gametes(pops[0])
+        self.assertEqual(g['n'].sum(),2000)
+        self.assertEqual(len(g['n']),len(gams))
+        pos = v['mutations']['pos']
+        for i,gam in enumerate(gams):
+            n = pos[g['neutral'][g['neutral_offsets'][i]:g['neutral_offsets'][i+1]]]
+            s = pos[g['selected'][g['selected_offsets'][i]:g['selected_offsets'][i+1]]]
+            self.assertEqual(list(n),[m['pos'] for m in gam['neutral']])
+            self.assertEqual(list(s),[m['pos'] for m in gam['selected']])
+    def testDiploids(self):
+        v = fwdpy.view_columnar(pops[0])
+        d = v['diploids']
+        self.assertEqual(len(d),pops[0].popsize())
+        dips = fwdpy.view_diploids(pops[0],[0,1,2])
+        g = v['gametes']
+        pos = v['mutations']['pos']
+        for i in range(3):
+            self.assertEqual(d['g'][i],dips[i]['g'])
+            gam = d['first'][i]
+            s = pos[g['selected'][g['selected_offsets'][gam]:g['selected_offsets'][gam+1]]]
+            self.assertEqual(list(s),[m['pos'] for m in dips[i]['chrom0']['selected']])
+    def testPopVec(self):
+        self.assertEqual(len(fwdpy.view_columnar(pops)),len(pops))
+    def testMetaPopVec(self):
+        m = fwdpy.MetaPopVec(2,[100,50])
+        v = fwdpy.view_columnar(m,deme=1)
+        self.assertEqual(len(v),2)
+        for i in v:
+            self.assertEqual(len(i['diploids']),50)
+        with self.assertRaises(RuntimeError):
+            fwdpy.view_columnar(m)
+
 #class test_metapop_views(unittest.TestCase):
 #    def testNumGametes(self):
 #        gams = fwdpy.view_gametes(mpops[0],0) 
@@ -1,6 +1,7 @@
 from cython.operator import dereference as deref,postincrement as inc
 from cython.parallel import parallel, prange
 from libcpp.limits cimport numeric_limits
+from libc.string cimport memcpy
 import pandas as pd
 
 cdef extern from "<algorithm>" namespace "std":
@@ -434,6 +435,116 @@ def view_diploids(object p, list indlist, deme = None):
     else:
         raise RuntimeError("view_diploids: unsupported object type")
 
+cdef copy_to_array(const void * data, size_t n, dtype):
+    """
+    Copy n elements of a C++ vector into a new 1D NumPy array
+    """
+    rv = np.empty(n,dtype=dtype)
+    cdef unsigned char[::1] dest
+    if n > 0:
+        dest = rv.view(np.uint8)
+        memcpy(&dest[0],data,rv.nbytes)
+    return rv
+
+cdef columnar_view_to_dict(const columnar_view & v):
+    cdef size_t nmuts = v.mutations.key.size()
+    cdef size_t ngams = v.gametes.key.size()
+    cdef size_t ndips = v.diploids.g.size()
+    mutations = np.empty(nmuts,dtype=[('pos',np.float64),('s',np.float64),('h',np.float64),
+                                      ('n',np.uint32),('g',np.uint32),('neutral',np.bool_),
+                                      ('label',np.uint16),('key',np.uintp)])
+    mutations['pos'] = copy_to_array(v.mutations.pos.data(),nmuts,np.float64)
+    mutations['s'] = copy_to_array(v.mutations.s.data(),nmuts,np.float64)
+    mutations['h'] = copy_to_array(v.mutations.h.data(),nmuts,np.float64)
+    mutations['n'] = copy_to_array(v.mutations.n.data(),nmuts,np.uint32)
+    mutations['g'] = copy_to_array(v.mutations.g.data(),nmuts,np.uint32)
+    mutations['neutral'] = copy_to_array(v.mutations.neutral.data(),nmuts,np.bool_)
+    mutations['label'] = copy_to_array(v.mutations.label.data(),nmuts,np.uint16)
+    mutations['key'] = copy_to_array(v.mutations.key.data(),nmuts,np.uintp)
+    gametes = {'n':copy_to_array(v.gametes.n.data(),ngams,np.uint32),
+               'neutral_offsets':copy_to_array(v.gametes.neutral_offsets.data(),ngams+1,np.uintp),
+               'neutral':copy_to_array(v.gametes.neutral.data(),v.gametes.neutral.size(),np.uint32),
+               'selected_offsets':copy_to_array(v.gametes.selected_offsets.data(),ngams+1,np.uintp),
+               'selected':copy_to_array(v.gametes.selected.data(),v.gametes.selected.size(),np.uint32),
+               'key':copy_to_array(v.gametes.key.data(),ngams,np.uintp)}
+    cdef size_t nloci = v.diploids.nloci
+    gamete_dtype = np.uint32 if nloci == 1 else (np.uint32,(nloci,))
+    diploids = np.empty(ndips,dtype=[('first',gamete_dtype),('second',gamete_dtype),
+                                     ('g',np.float64),('e',np.float64),('w',np.float64)])
+    diploids['first'] = copy_to_array(v.diploids.first.data(),ndips*nloci,np.uint32).reshape(diploids['first'].shape)
+    diploids['second'] = copy_to_array(v.diploids.second.data(),ndips*nloci,np.uint32).reshape(diploids['second'].shape)
+    diploids['g'] = copy_to_array(v.diploids.g.data(),ndips,np.float64)
+    diploids['e'] = copy_to_array(v.diploids.e.data(),ndips,np.float64)
+    diploids['w'] = copy_to_array(v.diploids.w.data(),ndips,np.float64)
+    return {'mutations':mutations,'gametes':gametes,'diploids':diploids}
+
+def view_columnar(object p, deme = None):
+    """
+    Get the mutations, gametes, and diploids of a population as NumPy arrays.
+
+    :param p: a :class:`fwdpy.fwdpy.PopType` or a :class:`fwdpy.fwdpy.PopVec`
+    :param deme: If p is a :class:`fwdpy.fwdpy.MetaPop` or :class:`fwdpy.fwdpy.MetaPopVec`, deme is the index of the deme whose diploids are returned
+
+    :rtype: A dict, or a list of dicts if p is a :class:`fwdpy.fwdpy.PopVec`.  See Note.
+
+    Unlike :func:`view_mutations`, :func:`view_gametes`, and :func:`view_diploids`, no Python
+    object is created per mutation or gamete, so this function is suitable for entire large populations.
+
+    Example:
+
+    >>> import fwdpy
+    >>> import numpy as np
+    >>> nregions = [fwdpy.Region(0,1,1),fwdpy.Region(2,3,1)]
+    >>> sregions = [fwdpy.ExpS(1,2,1,-0.1),fwdpy.ExpS(1,2,0.01,0.001)]
+    >>> rregions = [fwdpy.Region(0,3,1)]
+    >>> rng = fwdpy.GSLrng(100)
+    >>> popsizes = np.array([1000],dtype=np.uint32)
+    >>> popsizes=np.tile(popsizes,100)
+    >>> pops = fwdpy.evolve_regions(rng,1,1000,popsizes[0:],0.001,0.0001,0.001,nregions,sregions,rregions)
+    >>> v = fwdpy.view_columnar(pops[0])
+    >>> #Positions of the selected mutations on the first chromosome of the first diploid
+    >>> g = v['gametes']
+    >>> gam = v['diploids']['first'][0]
+    >>> pos = v['mutations']['pos'][g['selected'][g['selected_offsets'][gam]:g['selected_offsets'][gam+1]]]
+
+    .. note:: Each dict has three items:
+
+       * 'mutations' is a structured array with fields pos, s, h, n (count in the population), g (generation of origin),
+         neutral, label, and key (index in the population's container of mutations).  Extinct mutations are skipped.
+       * 'gametes' is a dict of arrays in compressed sparse row form: the neutral mutations in gamete i are rows
+         neutral[neutral_offsets[i]:neutral_offsets[i+1]] of the mutation table, and likewise for selected.
+         'n' and 'key' give the count and index of each gamete.  Extinct gametes are skipped.
+       * 'diploids' is a structured array with fields first, second, g, e, and w.  first and second are
+         rows of the gamete table.  For a :class:`fwdpy.fwdpy.MlocusPop`, first and second have one element per locus.
+    """
+    cdef columnar_view v
+    cdef size_t i
+    if isinstance(p,Spop):
+        with nogil:
+            v = make_columnar_view((<Spop>p).pop.get())
+        return columnar_view_to_dict(v)
+    elif isinstance(p,MlocusPop):
+        with nogil:
+            v = make_columnar_view((<MlocusPop>p).pop.get())
+        return columnar_view_to_dict(v)
+    elif isinstance(p,MetaPop):
+        if deme is None:
+            raise RuntimeError("view_columnar: deme index required for metapopulation")
+        i = deme
+        with nogil:
+            v = make_columnar_view((<MetaPop>p).mpop.get(),i)
+        return columnar_view_to_dict(v)
+    elif isinstance(p,SpopVec):
+        return [view_columnar(pop) for pop in p]
+    elif isinstance(p,MlocusPopVec):
+        return [view_columnar(pop) for pop in p]
+    elif isinstance(p,MetaPopVec):
+        if deme is None:
+            raise RuntimeError("view_columnar: deme index required for metapopulation")
+        return [view_columnar(pop,deme) for pop in p]
+    else:
+        raise RuntimeError("view_columnar: unsupported object type")
+
 cdef diploid_view_to_sample_init_containers(list mutations, map[double,string] * rmap, list info, const size_t ttl_nsam):
     cdef map[double,string].iterator map_itr
     cdef char ancestral = '0'
@@ -0,0 +1,129 @@
+/*!
+  \file async_gz_writer.hpp
+
+  \brief A gzip output stream that compresses on a background thread.
+
+  Callers append bytes to a buffer under a lock.  A worker thread swaps
+  that buffer with its own and calls gzwrite outside the lock, so the
+  caller only pays for a copy.  Both buffers keep their capacity, so no
+  allocation occurs once they have grown to the size of a typical write.
+*/
+#ifndef FWDPY_ASYNC_GZ_WRITER_HPP
+#define FWDPY_ASYNC_GZ_WRITER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <zlib.h>
+
+namespace fwdpy
+{
+    class async_gz_writer
+    {
+      private:
+        const std::string filename;
+        gzFile gz;
+        std::string pending, writing;
+        std::mutex m;
+        std::condition_variable cv;
+        bool closing, failed;
+        std::thread worker;
+        //! write() blocks while this many bytes are waiting to be compressed
+        static constexpr std::size_t max_pending = std::size_t(1) << 26;
+
+        void
+        run()
+        {
+            std::unique_lock<std::mutex> lock(m);
+            while (true)
+                {
+                    cv.wait(lock,
+                            [this]() { return closing || !pending.empty(); });
+                    if (pending.empty())
+                        return;
+                    writing.swap(pending);
+                    lock.unlock();
+                    cv.notify_all();
+                    const bool ok
+                        = gzwrite(gz, writing.data(), unsigned(writing.size()))
+                          == int(writing.size());
+                    writing.clear();
+                    lock.lock();
+                    if (!ok)
+                        failed = true;
+                }
+        }
+
+      public:
+        async_gz_writer(const std::string &fn, const char *mode)
+            : filename(fn), gz(gzopen(fn.c_str(), mode)), pending{},
+              writing{}, m{}, cv{}, closing(false), failed(false), worker{}
+        {
+            if (gz == NULL)
+                {
+                    throw std::runtime_error("could not open " + filename
+                                             + " in '" + mode + "' mode");
+                }
+            worker = std::thread(&async_gz_writer::run, this);
+        }
+
+        async_gz_writer(const async_gz_writer &) = delete;
+        async_gz_writer &operator=(const async_gz_writer &) = delete;
+
+        void
+        write(const char *data, const std::size_t n)
+        //! Queue n bytes for compression
+        {
+            std::unique_lock<std::mutex> lock(m);
+            if (failed)
+                throw std::runtime_error("error writing to " + filename);
+            cv.wait(lock, [this]() { return pending.size() < max_pending; });
+            pending.append(data, n);
+            lock.unlock();
+            cv.notify_all();
+        }
+
+        void
+        write(const std::string &s)
+        {
+            write(s.data(), s.size());
+        }
+
+        void
+        close()
+        /*!
+          Compress everything queued so far, stop the worker, and close the
+          file.  Throws std::runtime_error if any write failed.  Calling
+          close() more than once has no effect.
+        */
+        {
+            if (!worker.joinable())
+                return;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                closing = true;
+            }
+            cv.notify_all();
+            worker.join();
+            const bool ok = (gzclose(gz) == Z_OK) && !failed;
+            if (!ok)
+                throw std::runtime_error("error writing to " + filename);
+        }
+
+        ~async_gz_writer()
+        {
+            try
+                {
+                    close();
+                }
+            catch (...)
+                {
+                }
+        }
+    };
+}
+
+#endif
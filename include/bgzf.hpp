@@ -0,0 +1,451 @@
+/*!
+  \file bgzf.hpp
+
+  \brief Streams for BGZF files, compressed and decompressed using several
+  threads.
+
+  BGZF (the "blocked gzip" format used by samtools/htslib) is a series of
+  gzip members of at most 64kb each.  Every member records its compressed
+  size in a gzip "extra" field.  Because the members are independent, they
+  can be compressed and decompressed in parallel, and the output is still
+  a valid gzip file that can be read by zlib's gzread, gunzip, etc.
+
+  fwdpy::bgzf::ostreambuf and fwdpy::bgzf::istreambuf are std::streambuf
+  types, so that a population can be written to or read from a file by
+  the same KTfwd::serialize/deserialize code used for in-memory strings.
+  Data are buffered and (de)compressed a batch of blocks at a time.
+*/
+#ifndef FWDPY_BGZF_HPP
+#define FWDPY_BGZF_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+namespace fwdpy
+{
+    namespace bgzf
+    {
+        //! Maximum uncompressed bytes per block.  This is htslib's value.
+        constexpr std::size_t max_block_input = 0xff00;
+        //! Maximum size of a compressed block, including header and footer
+        constexpr std::size_t max_block_size = 0x10000;
+        constexpr std::size_t header_size = 18;
+        constexpr std::size_t footer_size = 8;
+        //! Blocks (de)compressed per thread per batch
+        constexpr std::size_t blocks_per_thread = 8;
+
+        //! An empty block, which marks the end of a BGZF file
+        static const unsigned char eof_block[28]
+            = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff, 0x06, 0, 0x42, 0x43,
+                0x02, 0,    0x1b, 0,    3, 0, 0, 0, 0, 0,    0,    0, 0,    0 };
+
+        inline unsigned
+        resolve_nthreads(const unsigned nthreads)
+        //! \return nthreads, or the number of hardware threads if nthreads is 0
+        {
+            if (nthreads)
+                return nthreads;
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        inline std::uint32_t
+        unpack_le(const unsigned char *p, const unsigned nbytes)
+        {
+            std::uint32_t rv = 0;
+            for (unsigned i = 0; i < nbytes; ++i)
+                rv |= std::uint32_t(p[i]) << (8 * i);
+            return rv;
+        }
+
+        inline void
+        pack_le(unsigned char *p, std::uint32_t x, const unsigned nbytes)
+        {
+            for (unsigned i = 0; i < nbytes; ++i, x >>= 8)
+                p[i] = static_cast<unsigned char>(x & 0xff);
+        }
+
+        inline bool
+        is_block_header(const unsigned char *h)
+        //! \return true if the header_size bytes at h begin a BGZF block
+        {
+            return h[0] == 31 && h[1] == 139 && h[2] == 8 && (h[3] & 4)
+                   && unpack_le(h + 10, 2) == 6 && h[12] == 'B'
+                   && h[13] == 'C' && unpack_le(h + 14, 2) == 2;
+        }
+
+        inline bool
+        is_bgzf(const char *filename)
+        //! \return true if filename exists and begins with a BGZF block
+        {
+            std::ifstream in(filename, std::ios::binary);
+            unsigned char h[header_size];
+            if (!in.read(reinterpret_cast<char *>(h), header_size))
+                return false;
+            return is_block_header(h);
+        }
+
+        template <typename F>
+        inline void
+        parallel_for(const std::size_t n, const unsigned nthreads, const F &f)
+        /*!
+          Call f(t,i) for i in [0,n), where t is the thread index.  Thread t
+          gets i = t, t + nthreads, ...  The first exception thrown by any
+          call is re-thrown after all threads finish.
+        */
+        {
+            const unsigned nt = unsigned(std::min<std::size_t>(nthreads, n));
+            if (nt <= 1)
+                {
+                    for (std::size_t i = 0; i < n; ++i)
+                        f(0u, i);
+                    return;
+                }
+            std::vector<std::exception_ptr> errors(nt);
+            std::vector<std::thread> threads;
+            for (unsigned t = 0; t < nt; ++t)
+                {
+                    threads.emplace_back([&f, &errors, n, nt, t]() {
+                        try
+                            {
+                                for (std::size_t i = t; i < n; i += nt)
+                                    f(t, i);
+                            }
+                        catch (...)
+                            {
+                                errors[t] = std::current_exception();
+                            }
+                    });
+                }
+            for (auto &t : threads)
+                t.join();
+            for (auto &e : errors)
+                {
+                    if (e)
+                        std::rethrow_exception(e);
+                }
+        }
+
+        class ostreambuf : public std::streambuf
+        /*!
+          Writes BGZF.  Output is compressed when the buffer, which holds
+          nthreads * blocks_per_thread blocks, is full, and by sync() and
+          close().
+        */
+        {
+          private:
+            std::ofstream out;
+            const unsigned nthreads;
+            const int level;
+            std::vector<char> buffer;
+            std::vector<std::string> blocks;
+            std::uint64_t uncompressed;
+
+            void
+            compress_block(const char *data, const std::size_t n,
+                           std::string &block) const
+            {
+                block.resize(max_block_size);
+                auto *b = reinterpret_cast<unsigned char *>(&block[0]);
+                z_stream zs;
+                std::memset(&zs, 0, sizeof(z_stream));
+                if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8,
+                                 Z_DEFAULT_STRATEGY)
+                    != Z_OK)
+                    throw std::runtime_error("deflateInit2 failed");
+                zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+                zs.avail_in = uInt(n);
+                zs.next_out = b + header_size;
+                zs.avail_out = uInt(max_block_size - header_size - footer_size);
+                const int rv = deflate(&zs, Z_FINISH);
+                const std::size_t csize = zs.total_out;
+                deflateEnd(&zs);
+                if (rv != Z_STREAM_END)
+                    throw std::runtime_error("BGZF block did not fit");
+                const std::size_t bsize = header_size + csize + footer_size;
+                std::memcpy(b, eof_block, header_size);
+                pack_le(b + 16, std::uint32_t(bsize - 1), 2);
+                pack_le(b + header_size + csize,
+                        std::uint32_t(crc32(crc32(0L, Z_NULL, 0),
+                                            reinterpret_cast<const Bytef *>(
+                                                data),
+                                            uInt(n))),
+                        4);
+                pack_le(b + header_size + csize + 4, std::uint32_t(n), 4);
+                block.resize(bsize);
+            }
+
+            void
+            flush_buffer()
+            {
+                const std::size_t n = std::size_t(pptr() - pbase());
+                if (!n)
+                    return;
+                const std::size_t nblocks
+                    = (n + max_block_input - 1) / max_block_input;
+                const char *data = pbase();
+                parallel_for(nblocks, nthreads, [this, data, n](
+                                                    unsigned, std::size_t i) {
+                    const std::size_t beg = i * max_block_input;
+                    compress_block(data + beg,
+                                   std::min(max_block_input, n - beg),
+                                   blocks[i]);
+                });
+                for (std::size_t i = 0; i < nblocks; ++i)
+                    out.write(blocks[i].data(), std::streamsize(blocks[i].size()));
+                if (!out)
+                    throw std::runtime_error("error writing BGZF output");
+                uncompressed += n;
+                setp(buffer.data(), buffer.data() + buffer.size());
+            }
+
+          protected:
+            virtual int_type
+            overflow(int_type c)
+            {
+                flush_buffer();
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    {
+                        *pptr() = traits_type::to_char_type(c);
+                        pbump(1);
+                    }
+                return traits_type::not_eof(c);
+            }
+
+            virtual int
+            sync()
+            {
+                flush_buffer();
+                out.flush();
+                return out ? 0 : -1;
+            }
+
+          public:
+            ostreambuf(const char *filename, const bool append,
+                       const unsigned nthreads_, const int level_ = 6)
+                : out(filename, append ? std::ios::binary | std::ios::app
+                                       : std::ios::binary | std::ios::trunc),
+                  nthreads(resolve_nthreads(nthreads_)), level(level_),
+                  buffer(nthreads * blocks_per_thread * max_block_input),
+                  blocks(nthreads * blocks_per_thread), uncompressed(0)
+            {
+                if (!out)
+                    throw std::runtime_error(std::string("could not open ")
+                                             + filename);
+                setp(buffer.data(), buffer.data() + buffer.size());
+            }
+
+            std::uint64_t
+            close()
+            /*!
+              Compress any buffered data, write the end-of-file marker and
+              close the file.
+
+              \return The number of uncompressed bytes written.
+            */
+            {
+                flush_buffer();
+                out.write(reinterpret_cast<const char *>(eof_block),
+                          sizeof(eof_block));
+                out.close();
+                if (!out)
+                    throw std::runtime_error("error writing BGZF output");
+                return uncompressed;
+            }
+        };
+
+        class istreambuf : public std::streambuf
+        /*!
+          Reads BGZF.  Each call to underflow() reads a batch of
+          nthreads * blocks_per_thread blocks and decompresses them in
+          parallel.
+        */
+        {
+          private:
+            struct block
+            {
+                std::string raw;
+                std::size_t offset, isize;
+            };
+
+            std::ifstream in;
+            const unsigned nthreads;
+            std::vector<block> blocks;
+            std::vector<char> buffer;
+
+            bool
+            read_block(block &b)
+            //! \return false at end of file
+            {
+                unsigned char h[header_size];
+                if (!in.read(reinterpret_cast<char *>(h), header_size))
+                    {
+                        if (in.gcount() == 0)
+                            return false;
+                        throw std::runtime_error("truncated BGZF block");
+                    }
+                if (!is_block_header(h))
+                    throw std::runtime_error(
+                        "input contains a gzip member that is not BGZF");
+                const std::size_t bsize = unpack_le(h + 16, 2) + 1;
+                if (bsize < header_size + footer_size)
+                    throw std::runtime_error("invalid BGZF block size");
+                b.raw.resize(bsize - header_size);
+                if (!in.read(&b.raw[0], std::streamsize(b.raw.size())))
+                    throw std::runtime_error("truncated BGZF block");
+                b.isize = unpack_le(reinterpret_cast<const unsigned char *>(
+                                        b.raw.data() + b.raw.size() - 4),
+                                    4);
+                return true;
+            }
+
+            void
+            inflate_block(const block &b, char *dest) const
+            {
+                z_stream zs;
+                std::memset(&zs, 0, sizeof(z_stream));
+                if (inflateInit2(&zs, -15) != Z_OK)
+                    throw std::runtime_error("inflateInit2 failed");
+                zs.next_in = reinterpret_cast<Bytef *>(
+                    const_cast<char *>(b.raw.data()));
+                zs.avail_in = uInt(b.raw.size() - footer_size);
+                zs.next_out = reinterpret_cast<Bytef *>(dest);
+                zs.avail_out = uInt(b.isize);
+                const int rv = inflate(&zs, Z_FINISH);
+                const std::size_t n = zs.total_out;
+                inflateEnd(&zs);
+                const auto crc = unpack_le(
+                    reinterpret_cast<const unsigned char *>(
+                        b.raw.data() + b.raw.size() - footer_size),
+                    4);
+                if ((rv != Z_STREAM_END && b.isize) || n != b.isize
+                    || crc32(crc32(0L, Z_NULL, 0),
+                             reinterpret_cast<const Bytef *>(dest), uInt(n))
+                           != crc)
+                    throw std::runtime_error("corrupt BGZF block");
+            }
+
+          protected:
+            virtual int_type
+            underflow()
+            {
+                if (gptr() < egptr())
+                    return traits_type::to_int_type(*gptr());
+                std::size_t nblocks = 0, total = 0;
+                // Skip over empty blocks, such as end-of-file markers
+                while (total == 0)
+                    {
+                        nblocks = 0;
+                        while (nblocks < blocks.size()
+                               && read_block(blocks[nblocks]))
+                            {
+                                blocks[nblocks].offset = total;
+                                total += blocks[nblocks].isize;
+                                ++nblocks;
+                            }
+                        if (!nblocks)
+                            return traits_type::eof();
+                    }
+                buffer.resize(total);
+                char *dest = buffer.data();
+                parallel_for(nblocks, nthreads,
+                             [this, dest](unsigned, std::size_t i) {
+                                 inflate_block(blocks[i],
+                                               dest + blocks[i].offset);
+                             });
+                setg(buffer.data(), buffer.data(), buffer.data() + total);
+                return traits_type::to_int_type(*gptr());
+            }
+
+          public:
+            istreambuf(const char *filename, const unsigned nthreads_)
+                : in(filename, std::ios::binary),
+                  nthreads(resolve_nthreads(nthreads_)),
+                  blocks(nthreads * blocks_per_thread), buffer{}
+            {
+                if (!in)
+                    throw std::runtime_error(std::string("could not open ")
+                                             + filename);
+                setg(nullptr, nullptr, nullptr);
+            }
+
+            void
+            skip(std::uint64_t offset)
+            /*!
+              Advance offset bytes into the uncompressed data.  Whole blocks
+              are skipped by reading only their headers and sizes.
+            */
+            {
+                unsigned char h[header_size], isize[4];
+                while (offset)
+                    {
+                        const auto start = in.tellg();
+                        if (!in.read(reinterpret_cast<char *>(h), header_size)
+                            || !is_block_header(h))
+                            throw std::runtime_error(
+                                "offset is past the end of the BGZF data");
+                        const std::size_t bsize = unpack_le(h + 16, 2) + 1;
+                        in.seekg(start + std::streamoff(bsize - 4));
+                        if (!in.read(reinterpret_cast<char *>(isize), 4))
+                            throw std::runtime_error("truncated BGZF block");
+                        const std::uint64_t n = unpack_le(isize, 4);
+                        if (n > offset)
+                            {
+                                in.seekg(start);
+                                break;
+                            }
+                        offset -= n;
+                    }
+                while (offset)
+                    {
+                        if (traits_type::eq_int_type(underflow(),
+                                                     traits_type::eof()))
+                            throw std::runtime_error(
+                                "offset is past the end of the BGZF data");
+                        const auto n = std::min<std::uint64_t>(
+                            offset, std::uint64_t(egptr() - gptr()));
+                        gbump(int(n));
+                        offset -= n;
+                    }
+            }
+        };
+
+        inline void
+        remove_eof_block(const char *filename)
+        /*!
+          If filename ends with an end-of-file marker, remove it, so that
+          data can be appended.  Some readers, including htslib, stop at
+          the first empty block.
+        */
+        {
+            std::fstream f(filename,
+                           std::ios::binary | std::ios::in | std::ios::out);
+            if (!f)
+                return;
+            f.seekg(0, std::ios::end);
+            const auto size = f.tellg();
+            if (size < std::streamoff(sizeof(eof_block)))
+                return;
+            unsigned char tail[sizeof(eof_block)];
+            f.seekg(size - std::streamoff(sizeof(eof_block)));
+            f.read(reinterpret_cast<char *>(tail), sizeof(eof_block));
+            f.close();
+            if (std::equal(tail, tail + sizeof(eof_block), eof_block)
+                && ::truncate(filename,
+                              off_t(size) - off_t(sizeof(eof_block))))
+                throw std::runtime_error(std::string("could not truncate ")
+                                         + filename);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*!
+  \file checkpoint.hpp
+
+  \brief In-memory copies of a replicate's state, for rolling back a
+  simulation.
+*/
+#ifndef FWDPY_CHECKPOINT_HPP
+#define FWDPY_CHECKPOINT_HPP
+
+#include "gsl_rng_ptr.hpp"
+#include "types.hpp"
+#include <gsl/gsl_rng.h>
+#include <stdexcept>
+
+namespace fwdpy
+{
+    class singlepop_checkpoint
+    /*!
+      A copy of a population and of a random number generator's state.
+
+      Restoring copy-assigns into the population, so containers keep their
+      capacity and repeated rollbacks do not reallocate.
+    */
+    {
+      private:
+        singlepop_t pop;
+        gsl_rng_ptr_t rng;
+
+      public:
+        singlepop_checkpoint(const singlepop_t &pop_, const gsl_rng *rng_)
+            : pop(pop_), rng(gsl_rng_clone(rng_))
+        {
+            if (rng == nullptr)
+                throw std::runtime_error("could not copy random number "
+                                         "generator");
+        }
+
+        void
+        restore(singlepop_t &pop_, gsl_rng *rng_) const
+        //! rng_ must be of the same type as the one checkpointed
+        {
+            pop_ = pop;
+            gsl_rng_memcpy(rng_, rng.get());
+        }
+
+        unsigned
+        generation() const
+        {
+            return pop.generation;
+        }
+    };
+}
+
+#endif
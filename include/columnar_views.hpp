@@ -0,0 +1,232 @@
+/*!
+  \file columnar_views.hpp
+
+  \brief Column-oriented copies of a population's mutations, gametes and
+  diploids.
+
+  The functions in views.pyx build one record per mutation per gamete,
+  which is convenient for small populations but allocates a Python object
+  per element.  The types here hold one std::vector per field, so that
+  each can be copied into a NumPy array in one step.
+
+  Extinct mutations and gametes are left out.  Gametes refer to
+  mutations, and diploids to gametes, by row in the respective table,
+  not by index in the population's containers.  The original indexes are
+  kept in the "key" columns.
+*/
+#ifndef FWDPY_COLUMNAR_VIEWS_HPP
+#define FWDPY_COLUMNAR_VIEWS_HPP
+
+#include "types.hpp"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace fwdpy
+{
+    struct mutation_columns
+    {
+        std::vector<double> pos, s, h;
+        //! Number of copies in the population, and generation of origin
+        std::vector<unsigned> n, g;
+        std::vector<char> neutral;
+        std::vector<std::uint16_t> label;
+        //! Index in pop->mutations
+        std::vector<std::size_t> key;
+    };
+
+    struct gamete_columns
+    /*!
+      Mutations carried by gamete i are rows
+      neutral[neutral_offsets[i]] to neutral[neutral_offsets[i+1]-1] of
+      the mutation table, and likewise for selected.  Each offsets vector
+      has one more element than there are gametes.
+    */
+    {
+        std::vector<unsigned> n;
+        std::vector<std::size_t> neutral_offsets, selected_offsets;
+        std::vector<std::uint32_t> neutral, selected;
+        //! Index in pop->gametes
+        std::vector<std::size_t> key;
+    };
+
+    struct diploid_columns
+    /*!
+      first and second are rows of the gamete table.  For a multi-locus
+      population, they hold nloci elements per diploid, in order of locus,
+      and g, e and w are taken from the first locus.
+    */
+    {
+        std::vector<std::uint32_t> first, second;
+        std::vector<double> g, e, w;
+        std::size_t nloci;
+    };
+
+    struct columnar_view
+    {
+        mutation_columns mutations;
+        gamete_columns gametes;
+        diploid_columns diploids;
+    };
+
+    namespace columnar_detail
+    {
+        constexpr std::uint32_t no_row
+            = std::numeric_limits<std::uint32_t>::max();
+
+        template <typename mcont_t>
+        std::vector<std::uint32_t>
+        fill_mutations(const mcont_t &mutations,
+                       const std::vector<unsigned> &mcounts,
+                       mutation_columns &m)
+        //! \return The row of each mutation key, or no_row if extinct
+        {
+            std::vector<std::uint32_t> row(mutations.size(), no_row);
+            for (std::size_t i = 0; i < mutations.size(); ++i)
+                {
+                    if (!mcounts[i])
+                        continue;
+                    row[i] = std::uint32_t(m.key.size());
+                    const auto &mut = mutations[i];
+                    m.pos.push_back(mut.pos);
+                    m.s.push_back(mut.s);
+                    m.h.push_back(mut.h);
+                    m.n.push_back(mcounts[i]);
+                    m.g.push_back(mut.g);
+                    m.neutral.push_back(mut.neutral);
+                    m.label.push_back(mut.xtra);
+                    m.key.push_back(i);
+                }
+            return row;
+        }
+
+        template <typename key_container>
+        void
+        append_rows(const key_container &keys,
+                    const std::vector<std::uint32_t> &mutation_row,
+                    std::vector<std::uint32_t> &rows,
+                    std::vector<std::size_t> &offsets)
+        {
+            for (const auto k : keys)
+                rows.push_back(mutation_row[k]);
+            offsets.push_back(rows.size());
+        }
+
+        template <typename gcont_t>
+        std::vector<std::uint32_t>
+        fill_gametes(const gcont_t &gametes,
+                     const std::vector<std::uint32_t> &mutation_row,
+                     gamete_columns &gc)
+        //! \return The row of each gamete index, or no_row if extinct
+        {
+            std::vector<std::uint32_t> row(gametes.size(), no_row);
+            gc.neutral_offsets.push_back(0);
+            gc.selected_offsets.push_back(0);
+            for (std::size_t i = 0; i < gametes.size(); ++i)
+                {
+                    if (!gametes[i].n)
+                        continue;
+                    row[i] = std::uint32_t(gc.key.size());
+                    gc.n.push_back(gametes[i].n);
+                    gc.key.push_back(i);
+                    append_rows(gametes[i].mutations, mutation_row,
+                                gc.neutral, gc.neutral_offsets);
+                    append_rows(gametes[i].smutations, mutation_row,
+                                gc.selected, gc.selected_offsets);
+                }
+            return row;
+        }
+
+        template <typename diploid_t>
+        void
+        add_diploid(const diploid_t &dip,
+                    const std::vector<std::uint32_t> &gamete_row,
+                    diploid_columns &d)
+        {
+            d.first.push_back(gamete_row[dip.first]);
+            d.second.push_back(gamete_row[dip.second]);
+        }
+
+        template <typename diploid_t>
+        void
+        add_fitness(const diploid_t &dip, diploid_columns &d)
+        {
+            d.g.push_back(dip.g);
+            d.e.push_back(dip.e);
+            d.w.push_back(dip.w);
+        }
+
+        template <typename pop_t>
+        columnar_view
+        make_tables(const pop_t *pop, std::vector<std::uint32_t> &gamete_row)
+        {
+            if (pop->mutations.size() >= no_row
+                || pop->gametes.size() >= no_row)
+                throw std::runtime_error(
+                    "too many mutations or gametes for a columnar view");
+            columnar_view rv;
+            const auto mutation_row = fill_mutations(
+                pop->mutations, pop->mcounts, rv.mutations);
+            gamete_row = fill_gametes(pop->gametes, mutation_row, rv.gametes);
+            return rv;
+        }
+    }
+
+    inline columnar_view
+    make_columnar_view(const singlepop_t *pop)
+    {
+        std::vector<std::uint32_t> gamete_row;
+        auto rv = columnar_detail::make_tables(pop, gamete_row);
+        rv.diploids.nloci = 1;
+        for (const auto &dip : pop->diploids)
+            {
+                columnar_detail::add_diploid(dip, gamete_row, rv.diploids);
+                columnar_detail::add_fitness(dip, rv.diploids);
+            }
+        return rv;
+    }
+
+    inline columnar_view
+    make_columnar_view(const metapop_t *pop, const std::size_t deme)
+    /*!
+      Mutations and gametes are those of the entire metapopulation, with
+      counts over all demes.  Diploids are those of one deme.
+    */
+    {
+        if (deme >= pop->diploids.size())
+            throw std::out_of_range("deme index out of range");
+        std::vector<std::uint32_t> gamete_row;
+        auto rv = columnar_detail::make_tables(pop, gamete_row);
+        rv.diploids.nloci = 1;
+        for (const auto &dip : pop->diploids[deme])
+            {
+                columnar_detail::add_diploid(dip, gamete_row, rv.diploids);
+                columnar_detail::add_fitness(dip, rv.diploids);
+            }
+        return rv;
+    }
+
+    inline columnar_view
+    make_columnar_view(const multilocus_t *pop)
+    {
+        std::vector<std::uint32_t> gamete_row;
+        auto rv = columnar_detail::make_tables(pop, gamete_row);
+        rv.diploids.nloci
+            = pop->diploids.empty() ? 0 : pop->diploids.front().size();
+        for (const auto &dip : pop->diploids)
+            {
+                if (dip.size() != rv.diploids.nloci)
+                    throw std::runtime_error(
+                        "diploids differ in their number of loci");
+                for (const auto &locus : dip)
+                    columnar_detail::add_diploid(locus, gamete_row,
+                                                 rv.diploids);
+                if (!dip.empty())
+                    columnar_detail::add_fitness(dip.front(), rv.diploids);
+            }
+        return rv;
+    }
+}
+
+#endif
@@ -0,0 +1,255 @@
+/*!
+  \file event_timeline.hpp
+
+  \brief Generation-stamped changes to a simulation's parameters, applied
+  inside the evolve functions.
+*/
+#ifndef FWDPY_EVENT_TIMELINE_HPP
+#define FWDPY_EVENT_TIMELINE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace fwdpy
+{
+    enum class timeline_event_type : int
+    {
+        //! Diploid population size, replacing the values in Nvector
+        popsize,
+        mu_neutral,
+        mu_selected,
+        recrate,
+        //! Selfing probability
+        selfing,
+        //! Sampling interval.  0 turns the sampler off.
+        sampling_interval,
+        //! Generations between merges of identical gametes.  0 turns
+        //! merging off.
+        gamete_dedup_interval,
+        //! Parameters of the Gaussian stabilizing selection model
+        optimum,
+        VS,
+        sigmaE
+    };
+
+    struct timeline_event
+    {
+        unsigned generation;
+        timeline_event_type type;
+        double value;
+    };
+
+    class event_timeline
+    /*!
+      Events, sorted by generation.  Events in the same generation are kept
+      in the order they were added.
+
+      An event stamped with generation g takes effect before offspring are
+      generated from the population at generation g.  When evolution
+      starts at a later generation, earlier events are applied first, in
+      order.
+    */
+    {
+      private:
+        std::vector<timeline_event> events;
+
+      public:
+        event_timeline() : events{} {}
+
+        void
+        add(const unsigned generation, const timeline_event_type type,
+            const double value)
+        /*!
+          Throws std::invalid_argument if value is not valid for type.
+        */
+        {
+            if (!std::isfinite(value))
+                throw std::invalid_argument("event value must be finite");
+            switch (type)
+                {
+                case timeline_event_type::popsize:
+                    if (!(value >= 1.) || value != std::floor(value))
+                        throw std::invalid_argument(
+                            "population size must be a positive integer");
+                    break;
+                case timeline_event_type::sampling_interval:
+                case timeline_event_type::gamete_dedup_interval:
+                    if (value < 0. || value != std::floor(value))
+                        throw std::invalid_argument(
+                            "intervals must be non-negative integers");
+                    break;
+                case timeline_event_type::selfing:
+                    if (value < 0. || value > 1.)
+                        throw std::invalid_argument(
+                            "selfing probabilty must be 0<=f<=1.");
+                    break;
+                case timeline_event_type::VS:
+                    if (value <= 0.)
+                        throw std::invalid_argument("VS must be > 0.");
+                    break;
+                case timeline_event_type::optimum:
+                    break;
+                default: // rates and sigmaE
+                    if (value < 0.)
+                        throw std::invalid_argument(
+                            "mutation rates, recombination rates and sigmaE "
+                            "must be non-negative");
+                }
+            const timeline_event e{ generation, type, value };
+            events.insert(std::upper_bound(events.begin(), events.end(), e,
+                                           [](const timeline_event &a,
+                                              const timeline_event &b) {
+                                               return a.generation
+                                                      < b.generation;
+                                           }),
+                          e);
+        }
+
+        const std::vector<timeline_event> &
+        get_events() const
+        {
+            return events;
+        }
+
+        std::size_t
+        size() const
+        {
+            return events.size();
+        }
+
+        bool
+        has(const timeline_event_type type) const
+        {
+            return std::any_of(events.begin(), events.end(),
+                               [type](const timeline_event &e) {
+                                   return e.type == type;
+                               });
+        }
+
+        bool
+        has_trait_events() const
+        //! True if any event changes a parameter of a trait model
+        {
+            return has(timeline_event_type::optimum)
+                   || has(timeline_event_type::VS)
+                   || has(timeline_event_type::sigmaE);
+        }
+    };
+
+    class timeline_cursor
+    /*!
+      Position of one replicate in a fwdpy::event_timeline.  A null
+      timeline has no events.
+    */
+    {
+      private:
+        const event_timeline *timeline;
+        std::size_t next;
+
+      public:
+        explicit timeline_cursor(const event_timeline *t) : timeline(t), next(0)
+        {
+        }
+
+        template <typename handler_t>
+        void
+        apply(const unsigned generation, const handler_t &handler)
+        /*!
+          Call handler on each event stamped with a generation <= generation
+          that has not been applied yet.
+        */
+        {
+            if (timeline == nullptr)
+                return;
+            const auto &events = timeline->get_events();
+            for (; next < events.size() && events[next].generation <= generation;
+                 ++next)
+                handler(events[next]);
+        }
+    };
+
+    struct timeline_parameters
+    /*!
+      The parameters of a running simulation that events may change.
+    */
+    {
+        double neutral, selected, recrate, f;
+        int interval;
+        unsigned dedup_interval;
+        //! Population size set by an event.  0 means "use Nvector".
+        unsigned N;
+        //! Set when recrate changes, so that the caller can rebind
+        //! its recombination policy.
+        bool recrate_changed;
+
+        timeline_parameters(const double neutral_, const double selected_,
+                            const double recrate_, const double f_,
+                            const int interval_)
+            : neutral(neutral_), selected(selected_), recrate(recrate_),
+              f(f_), interval(interval_), dedup_interval(0), N(0),
+              recrate_changed(false)
+        {
+        }
+
+        double
+        mu_tot() const
+        {
+            return neutral + selected;
+        }
+
+        unsigned
+        nextN(const unsigned fromNvector) const
+        {
+            return N ? N : fromNvector;
+        }
+
+        bool
+        dedup_due(const unsigned generation) const
+        {
+            return dedup_interval && generation % dedup_interval == 0;
+        }
+
+        bool
+        apply(const timeline_event &e)
+        /*!
+          Returns false for events that are parameters of a trait model,
+          which must be handled by the caller.  Callers that do not model
+          a trait should reject such events with
+          event_timeline::has_trait_events before evolving.
+        */
+        {
+            switch (e.type)
+                {
+                case timeline_event_type::popsize:
+                    N = unsigned(e.value);
+                    return true;
+                case timeline_event_type::mu_neutral:
+                    neutral = e.value;
+                    return true;
+                case timeline_event_type::mu_selected:
+                    selected = e.value;
+                    return true;
+                case timeline_event_type::recrate:
+                    recrate = e.value;
+                    recrate_changed = true;
+                    return true;
+                case timeline_event_type::selfing:
+                    f = e.value;
+                    return true;
+                case timeline_event_type::sampling_interval:
+                    interval = int(e.value);
+                    return true;
+                case timeline_event_type::gamete_dedup_interval:
+                    dedup_interval = unsigned(e.value);
+                    return true;
+                default:
+                    return false;
+                }
+        }
+    };
+}
+
+#endif
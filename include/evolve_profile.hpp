@@ -0,0 +1,62 @@
+/*!
+  \file evolve_profile.hpp
+
+  \brief Per-replicate timings and counters recorded by the evolve functions.
+*/
+#ifndef FWDPY_EVOLVE_PROFILE_HPP
+#define FWDPY_EVOLVE_PROFILE_HPP
+
+namespace fwdpy
+{
+    struct evolve_profile
+    /*!
+      Wall time (in seconds) spent in each phase of a generation, and counts
+      of events, summed over all generations a population has been evolved
+      for.
+
+      Values are only recorded when fwdpy is compiled with -DFWDPY_PROFILE.
+      Otherwise, enabled is false and all values remain zero.  The
+      exceptions are the counts from merging identical gametes
+      (fwdpy::evolve_profile::add_dedup), which are always recorded.
+
+      \note fitness time is also included in sample_diploid time, as
+      fitnesses are calculated while offspring are generated.
+    */
+    {
+        bool enabled;
+        unsigned long long generations;
+        double sample_diploid, update_mutations, fitness, sampler;
+        unsigned long long new_mutations, crossovers, recycled_mutations,
+            recycled_gametes, gametes_allocated, sampler_calls,
+            merged_gametes;
+        //! Extant gametes before and after each merge, summed over merges
+        unsigned long long gametes_before_dedup, gametes_after_dedup;
+        evolve_profile() noexcept
+            :
+#ifdef FWDPY_PROFILE
+              enabled(true),
+#else
+              enabled(false),
+#endif
+              generations(0),
+              sample_diploid(0.), update_mutations(0.), fitness(0.),
+              sampler(0.), new_mutations(0), crossovers(0),
+              recycled_mutations(0), recycled_gametes(0),
+              gametes_allocated(0), sampler_calls(0), merged_gametes(0),
+              gametes_before_dedup(0), gametes_after_dedup(0)
+        {
+        }
+
+        void
+        add_dedup(const unsigned long long before,
+                  const unsigned long long after) noexcept
+        //! Record one merge of identical gametes
+        {
+            gametes_before_dedup += before;
+            gametes_after_dedup += after;
+            merged_gametes += before - after;
+        }
+    };
+}
+
+#endif
@@ -1,19 +1,62 @@
 #ifndef FWDPY_EVOLVE_REGIONS_SAMPLER_HPP
 #define FWDPY_EVOLVE_REGIONS_SAMPLER_HPP
+#include "event_timeline.hpp"
 #include "fwdpy_fitness.hpp"
 #include "internal_region_manager.hpp"
 #include "sampler_base.hpp"
+#include "stop_condition.hpp"
 #include "types.hpp"
+#include "wf_rules.hpp"
+#include <fwdpp/extensions/regions.hpp>
 #include <memory>
 #include <vector>
 namespace fwdpy
 {
+    //! Evolve a single replicate.  Called from evolve_regions_sampler_cpp,
+    //! and declared here so that it may be timed in isolation.
+    void evolve_regions_sampler_cpp_details(
+        singlepop_t *pop, const unsigned long seed, const unsigned *Nvector,
+        const size_t Nvector_len, const double neutral, const double selected,
+        const double recrate, const double f,
+        std::unique_ptr<singlepop_fitness> &fitness, const int interval,
+        KTfwd::extensions::discrete_mut_model &&__m,
+        KTfwd::extensions::discrete_rec_model &&__recmap, sampler_base &s,
+        wf_rules rules, const event_timeline *timeline = nullptr,
+        stop_condition *stop = nullptr);
+
     void evolve_regions_sampler_cpp(
         GSLrng_t *rng, std::vector<std::shared_ptr<singlepop_t>> &pops,
         std::vector<std::unique_ptr<sampler_base>> &samplers,
         const unsigned *Nvector, const size_t Nvector_length,
         const double mu_neutral, const double mu_selected,
         const double littler, const double f, const int sample,
-        const internal::region_manager *rm, const singlepop_fitness &fitness);
+        const internal::region_manager *rm, const singlepop_fitness &fitness,
+        const event_timeline *timeline = nullptr,
+        std::vector<std::unique_ptr<stop_condition>> *stops = nullptr);
+
+    //! Evolve a single replicate to checkpoint_generation, then evolve
+    //! the rest of Nvector, rolling the population and random number
+    //! generator back to the checkpoint whenever restart is met.  Called
+    //! from evolve_regions_until_cpp.
+    void evolve_regions_until_cpp_details(
+        singlepop_t *pop, const unsigned long seed, const unsigned *Nvector,
+        const size_t Nvector_len, const double neutral, const double selected,
+        const double recrate, const double f,
+        std::unique_ptr<singlepop_fitness> &fitness,
+        const internal::region_manager *rm, const event_timeline *timeline,
+        const unsigned checkpoint_generation, stop_condition &restart,
+        stop_condition *stop, const unsigned max_attempts,
+        unsigned &attempts);
+
+    std::vector<unsigned> evolve_regions_until_cpp(
+        GSLrng_t *rng, std::vector<std::shared_ptr<singlepop_t>> &pops,
+        const unsigned *Nvector, const size_t Nvector_length,
+        const double mu_neutral, const double mu_selected,
+        const double littler, const double f,
+        const internal::region_manager *rm, const singlepop_fitness &fitness,
+        const std::vector<unsigned> &checkpoint_generations,
+        std::vector<std::unique_ptr<stop_condition>> &restarts,
+        const unsigned max_attempts, const event_timeline *timeline = nullptr,
+        std::vector<std::unique_ptr<stop_condition>> *stops = nullptr);
 } // ns fwdpy
 #endif
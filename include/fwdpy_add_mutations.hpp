@@ -9,6 +9,10 @@
 #define FWDPY_ADD_MUTATIONS_HPP
 
 #include "types.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace fwdpy
 {
@@ -17,6 +21,26 @@ namespace fwdpy
                                  const std::vector<short> &clist,
                                  const double pos, const double s,
                                  const double h);
+
+    std::vector<std::size_t>
+    add_mutations_cpp(singlepop_t *pop, const std::vector<double> &pos,
+                      const std::vector<double> &s,
+                      const std::vector<double> &h,
+                      const std::uint8_t *haplotypes);
+
+    std::vector<std::size_t> add_mutations_cpp(
+        multilocus_t *pop, const std::vector<double> &pos,
+        const std::vector<double> &s, const std::vector<double> &h,
+        const std::uint8_t *haplotypes,
+        const std::vector<std::pair<double, double>> &locus_boundaries);
+
+    std::size_t init_from_ms_cpp(singlepop_t *pop, const std::string &filename,
+                                 const std::size_t rep, const double beg,
+                                 const double end);
+
+    std::size_t init_from_ms_cpp(
+        multilocus_t *pop, const std::string &filename, const std::size_t rep,
+        const std::vector<std::pair<double, double>> &locus_boundaries);
 }
 
 #endif
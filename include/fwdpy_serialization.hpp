@@ -3,8 +3,14 @@
  */
 #ifndef FWDPY_SERIALIZATION_HPP
 #define FWDPY_SERIALIZATION_HPP
+#include "bgzf.hpp"
 #include "serialization_common.hpp"
+#include <cstdint>
 #include <fwdpp/sugar/serialization.hpp>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 namespace fwdpy
 {
     namespace serialize_objects
@@ -54,6 +60,34 @@ namespace fwdpy
             return rv;
         }
 
+        template <typename poptype, typename mwriter_t, typename dipwriter_t>
+        inline std::int64_t
+        bgzserialize_details(const poptype &pop, const mwriter_t &mwriter,
+                             const dipwriter_t &dipwriter,
+                             const char *filename, bool append,
+                             const unsigned nthreads)
+        /*!
+          As gzserialize_details, but the output is BGZF, compressed using
+          nthreads threads (0 means all hardware threads).
+
+          \return The number of uncompressed bytes written, which is the
+          offset of the next population written to the same file.
+        */
+        {
+            if (append)
+                {
+                    bgzf::remove_eof_block(filename);
+                }
+            bgzf::ostreambuf sb(filename, append, nthreads);
+            std::ostream buffer(&sb);
+            buffer.exceptions(std::ios::badbit);
+            buffer.write(reinterpret_cast<const char *>(&pop.generation),
+                         sizeof(decltype(pop.generation)));
+            KTfwd::serialize s;
+            s(buffer, pop, mwriter, dipwriter);
+            return std::int64_t(sb.close());
+        }
+
         template <typename poptype> struct gzdeserialize_details
         {
             template <typename mreader_t, typename dipreader_t,
@@ -64,6 +98,11 @@ namespace fwdpy
                        constructor_data... cdata) const
             {
                 gzFile f = gzopen(filename, "rb");
+                if (f == NULL)
+                    {
+                        throw std::runtime_error(std::string("could not open ")
+                                                 + filename);
+                    }
                 if (offset)
                     {
                         gzseek(f, offset, SEEK_SET);
@@ -77,6 +116,38 @@ namespace fwdpy
                 return temp;
             };
         };
+
+        template <typename poptype> struct bgzdeserialize_details
+        /*!
+          Reads files written by either bgzserialize_details, using
+          nthreads threads, or by gzserialize_details.
+        */
+        {
+            template <typename mreader_t, typename dipreader_t,
+                      typename... constructor_data>
+            inline poptype
+            operator()(const mreader_t &mreader, const dipreader_t &dipreader,
+                       const char *filename, std::size_t offset,
+                       const unsigned nthreads,
+                       constructor_data... cdata) const
+            {
+                if (!bgzf::is_bgzf(filename))
+                    {
+                        return gzdeserialize_details<poptype>()(
+                            mreader, dipreader, filename, offset, cdata...);
+                    }
+                bgzf::istreambuf sb(filename, nthreads);
+                sb.skip(offset);
+                std::istream buffer(&sb);
+                buffer.exceptions(std::ios::badbit);
+                poptype temp(cdata...);
+                buffer.read(reinterpret_cast<char *>(&temp.generation),
+                            sizeof(decltype(temp.generation)));
+                KTfwd::deserialize d;
+                d(temp, buffer, mreader, dipreader);
+                return temp;
+            }
+        };
     }
 }
 #endif
@@ -6,6 +6,7 @@
 #include <fwdpp/sugar/serialization.hpp>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,28 @@ namespace fwdpy
             }
         };
 
+        template <typename poptype> struct fromfile_details
+        {
+            template <typename... constructor_data>
+            std::vector<std::shared_ptr<poptype>>
+            operator()(const std::vector<std::string> &filenames,
+                       const std::vector<std::size_t> &offsets,
+                       const unsigned nthreads, constructor_data... cdata)
+            {
+                if (filenames.size() != offsets.size())
+                    throw std::invalid_argument(
+                        "number of file names and offsets must be equal");
+                std::vector<std::shared_ptr<poptype>> rv;
+                for (std::size_t i = 0; i < filenames.size(); ++i)
+                    {
+                        rv.emplace_back(new poptype(cdata...));
+                        rv.back()->fromfile(filenames[i].c_str(), offsets[i],
+                                            nthreads);
+                    }
+                return rv;
+            }
+        };
+
         std::string serialize_singlepop(const singlepop_t *spop);
         std::vector<std::shared_ptr<singlepop_t>>
         deserialize_singlepop(const std::vector<std::string> &strings);
@@ -45,6 +68,18 @@ namespace fwdpy
         std::string serialize_multilocus(const fwdpy::multilocus_t *pop);
         std::vector<std::shared_ptr<multilocus_t>>
         deserialize_multilocus(const std::vector<std::string> &strings);
+        std::vector<std::shared_ptr<singlepop_t>>
+        fromfile_singlepop(const std::vector<std::string> &filenames,
+                           const std::vector<std::size_t> &offsets,
+                           const unsigned nthreads);
+        std::vector<std::shared_ptr<metapop_t>>
+        fromfile_metapop(const std::vector<std::string> &filenames,
+                         const std::vector<std::size_t> &offsets,
+                         const unsigned nthreads);
+        std::vector<std::shared_ptr<multilocus_t>>
+        fromfile_multilocus(const std::vector<std::string> &filenames,
+                            const std::vector<std::size_t> &offsets,
+                            const unsigned nthreads);
     }
 }
 
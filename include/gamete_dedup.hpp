@@ -0,0 +1,131 @@
+/*!
+  \file gamete_dedup.hpp
+
+  \brief Merge gametes that carry identical mutations.
+
+  sample_diploid adds a new gamete whenever recombination or mutation
+  makes one, even if an extant gamete already has the same contents.
+  Merging them reduces the number of gametes, and so the work done by
+  anything that loops over gametes.
+*/
+#ifndef FWDPY_GAMETE_DEDUP_HPP
+#define FWDPY_GAMETE_DEDUP_HPP
+
+#include "types.hpp"
+#include <cstddef>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+namespace fwdpy
+{
+    struct gamete_dedup_result
+    {
+        //! Number of extant gametes before and after merging
+        unsigned long long before, after;
+    };
+
+    namespace gamete_dedup_detail
+    {
+        struct key_hash
+        {
+            const gcont_t *gametes;
+            std::size_t
+            operator()(const std::size_t i) const
+            {
+                std::size_t h = 0;
+                const std::hash<KTfwd::uint_t> hk{};
+                const auto &g = (*gametes)[i];
+                for (const auto k : g.mutations)
+                    h ^= hk(k) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                // Neutral and selected keys are separate lists
+                h ^= std::size_t(g.mutations.size()) << 1;
+                for (const auto k : g.smutations)
+                    h ^= hk(k) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+
+        struct key_equal
+        {
+            const gcont_t *gametes;
+            bool
+            operator()(const std::size_t a, const std::size_t b) const
+            {
+                const auto &ga = (*gametes)[a];
+                const auto &gb = (*gametes)[b];
+                return ga.mutations == gb.mutations
+                       && ga.smutations == gb.smutations;
+            }
+        };
+
+        inline void
+        rewrite(diploid_t &dip, const std::vector<std::size_t> &canonical)
+        {
+            dip.first = canonical[dip.first];
+            dip.second = canonical[dip.second];
+        }
+
+        template <typename T>
+        inline void
+        rewrite(std::vector<T> &diploids,
+                const std::vector<std::size_t> &canonical)
+        {
+            for (auto &d : diploids)
+                rewrite(d, canonical);
+        }
+    }
+
+    inline gamete_dedup_result
+    merge_identical_gametes(gcont_t &gametes,
+                            std::vector<std::size_t> &canonical)
+    /*!
+      For each set of extant gametes with the same mutations, move the
+      counts to the first of the set and mark the others as extinct, so
+      that they will be recycled.  On return, canonical[i] is the index
+      that replaces gamete i.
+    */
+    {
+        canonical.resize(gametes.size());
+        std::unordered_set<std::size_t, gamete_dedup_detail::key_hash,
+                           gamete_dedup_detail::key_equal>
+            seen(gametes.size(), gamete_dedup_detail::key_hash{ &gametes },
+                 gamete_dedup_detail::key_equal{ &gametes });
+        gamete_dedup_result rv{ 0, 0 };
+        for (std::size_t i = 0; i < gametes.size(); ++i)
+            {
+                canonical[i] = i;
+                if (!gametes[i].n)
+                    continue;
+                ++rv.before;
+                auto r = seen.insert(i);
+                if (r.second)
+                    ++rv.after;
+                else
+                    {
+                        canonical[i] = *r.first;
+                        gametes[*r.first].n += gametes[i].n;
+                        gametes[i].n = 0;
+                    }
+            }
+        return rv;
+    }
+
+    template <typename poptype>
+    inline gamete_dedup_result
+    dedup_gametes(poptype &pop)
+    /*!
+      Merge identical gametes and update the diploids to refer to the
+      merged ones.  Works for fwdpy::singlepop_t, fwdpy::multilocus_t, and
+      fwdpy::metapop_t.
+    */
+    {
+        std::vector<std::size_t> canonical;
+        const auto rv = merge_identical_gametes(pop.gametes, canonical);
+        if (rv.after < rv.before)
+            gamete_dedup_detail::rewrite(pop.diploids, canonical);
+        return rv;
+    }
+}
+
+#endif
@@ -0,0 +1,205 @@
+/*!
+  \file generation_profiler.hpp
+
+  \brief Instrumentation of the evolve loops.
+
+  fwdpy::generation_profiler fills in a fwdpy::evolve_profile.  Unless
+  FWDPY_PROFILE is defined, every member function is an empty inline
+  function (or returns its argument), so the instrumentation compiles
+  to nothing.
+*/
+#ifndef FWDPY_GENERATION_PROFILER_HPP
+#define FWDPY_GENERATION_PROFILER_HPP
+
+#include "evolve_profile.hpp"
+#include "fwdpy_fitness.hpp"
+#include "types.hpp"
+#include <utility>
+#ifdef FWDPY_PROFILE
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#endif
+
+namespace fwdpy
+{
+    //! Phases of a generation that are timed
+    enum class generation_phase
+    {
+        sample_diploid,
+        update_mutations,
+        sampler
+    };
+
+#ifdef FWDPY_PROFILE
+    class generation_profiler
+    {
+      private:
+        using clock = std::chrono::steady_clock;
+        evolve_profile &profile;
+        clock::time_point t0;
+        //! Accumulated by fitness functions, which may run concurrently
+        std::atomic<std::int64_t> fitness_ns, ncrossovers;
+        //! Recyclable slots at the start of a generation
+        std::vector<char> extinct_gametes, extinct_mutations;
+
+        double &
+        field(const generation_phase p)
+        {
+            switch (p)
+                {
+                case generation_phase::sample_diploid:
+                    return profile.sample_diploid;
+                case generation_phase::update_mutations:
+                    return profile.update_mutations;
+                default:
+                    return profile.sampler;
+                }
+        }
+
+      public:
+        explicit generation_profiler(evolve_profile &p)
+            : profile(p), t0(), fitness_ns(0), ncrossovers(0),
+              extinct_gametes(), extinct_mutations()
+        {
+        }
+
+        void
+        start()
+        {
+            t0 = clock::now();
+        }
+
+        void
+        stop(const generation_phase p)
+        {
+            field(p) += std::chrono::duration<double>(clock::now() - t0)
+                            .count();
+            if (p == generation_phase::sampler)
+                ++profile.sampler_calls;
+        }
+
+        template <typename poptype>
+        void
+        before_generation(const poptype &pop)
+        /*!
+          Record which gamete and mutation slots may be recycled.  Must be
+          called immediately before sample_diploid.
+        */
+        {
+            extinct_gametes.resize(pop.gametes.size());
+            for (std::size_t i = 0; i < pop.gametes.size(); ++i)
+                extinct_gametes[i] = !pop.gametes[i].n;
+            extinct_mutations.resize(pop.mcounts.size());
+            for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+                extinct_mutations[i] = !pop.mcounts[i];
+        }
+
+        template <typename poptype>
+        void
+        after_generation(const poptype &pop)
+        /*!
+          Count recycled and new slots.  Must be called immediately after
+          sample_diploid.
+        */
+        {
+            unsigned long long recycled = 0;
+            for (std::size_t i = 0; i < extinct_gametes.size(); ++i)
+                recycled += (extinct_gametes[i] && pop.gametes[i].n);
+            profile.recycled_gametes += recycled;
+            profile.gametes_allocated
+                += pop.gametes.size() - extinct_gametes.size();
+            recycled = 0;
+            for (std::size_t i = 0; i < extinct_mutations.size(); ++i)
+                recycled += (extinct_mutations[i] && pop.mcounts[i]);
+            profile.recycled_mutations += recycled;
+            profile.new_mutations += recycled + pop.mcounts.size()
+                                     - extinct_mutations.size();
+            profile.crossovers += ncrossovers.exchange(0);
+            profile.fitness += double(fitness_ns.exchange(0)) * 1e-9;
+            ++profile.generations;
+        }
+
+        void
+        add_crossovers(const std::size_t n)
+        {
+            ncrossovers += std::int64_t(n);
+        }
+
+        template <typename recpol_t>
+        std::function<std::vector<double>(const gamete_t &, const gamete_t &,
+                                          const mcont_t &)>
+        wrap_recombination(recpol_t recpol)
+        //! Count crossovers made by a recombination policy
+        {
+            return [this, recpol](const gamete_t &g1, const gamete_t &g2,
+                                  const mcont_t &mutations) {
+                auto rv = recpol(g1, g2, mutations);
+                // The last breakpoint is a terminating sentinel
+                if (!rv.empty())
+                    this->ncrossovers += std::int64_t(rv.size() - 1);
+                return rv;
+            };
+        }
+
+        single_region_fitness_fxn
+        wrap_fitness(single_region_fitness_fxn ff)
+        //! Time calls to a fitness function
+        {
+            return [this, ff](const diploid_t &dip, const gcont_t &gametes,
+                              const mcont_t &mutations) {
+                const auto t = clock::now();
+                const double w = ff(dip, gametes, mutations);
+                this->fitness_ns
+                    += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           clock::now() - t)
+                           .count();
+                return w;
+            };
+        }
+    };
+#else
+    class generation_profiler
+    {
+      public:
+        explicit generation_profiler(evolve_profile &) noexcept {}
+        void
+        start() noexcept
+        {
+        }
+        void
+        stop(const generation_phase) noexcept
+        {
+        }
+        template <typename poptype>
+        void
+        before_generation(const poptype &) noexcept
+        {
+        }
+        template <typename poptype>
+        void
+        after_generation(const poptype &) noexcept
+        {
+        }
+        void
+        add_crossovers(const std::size_t) noexcept
+        {
+        }
+        template <typename recpol_t>
+        recpol_t
+        wrap_recombination(recpol_t recpol)
+        {
+            return recpol;
+        }
+        single_region_fitness_fxn
+        wrap_fitness(single_region_fitness_fxn ff)
+        {
+            return ff;
+        }
+    };
+#endif
+}
+
+#endif
@@ -9,9 +9,14 @@
 #include <set>
 #include <memory>
 #include <cstddef>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <sstream>
 #include "types.hpp"
 #include "gsl.hpp"
+#include "plink.hpp"
+#include "sampling_pass.hpp"
 namespace fwdpy
 {
     namespace gsl_data_matrix
@@ -76,35 +81,66 @@ namespace fwdpy
             gzclose(gzout);
         }
 
-        template <typename pop_t>
-        std::vector<KTfwd::uint_t>
-        get_mut_keys(const pop_t *pop, const bool sort_freq = false,
-                     const bool sort_esize = false)
+        inline void
+        write_geno_matrix_plink(const geno_matrix *m,
+                                const KTfwd::uint_t generation,
+                                std::string stub, const int repid)
+        /*!
+          Write m in PLINK binary format, as stub.generationX.repY.bed/.bim/.fam.
+          Column 0, the origin, is skipped.  The matrix does not record
+          positions, so variant j (counting from 1) has ID "mj" and
+          base-pair coordinate j.  The phenotype is the genetic value.
+        */
         {
-            std::vector<KTfwd::uint_t> mut_keys; // array of keys for each
-                                                 // segregating, non-neutral
-                                                 // variant
-            std::set<KTfwd::uint_t>
-                ucounts; // the number of unique frequency bins...
-            for (std::size_t i = 0; i < pop->mutations.size(); ++i)
+            stub += ".generation" + std::to_string(generation) + ".rep"
+                    + std::to_string(repid);
+            const std::size_t nbytes = plink::bytes_per_variant(m->nrow);
+            const std::string bedname = stub + ".bed", bimname = stub + ".bim";
+            std::ofstream bed, bim;
+            plink::open(bed, bedname);
+            plink::open(bim, bimname);
+            plink::write_bed_header(bed);
+            std::vector<char> buffer(nbytes);
+            for (std::size_t col = 1; col < m->ncol; ++col)
                 {
-                    // first check is to avoid extinct variants that fwdpp will
-                    // recycle later.
-                    // The second avoids fixed variants
-                    if (pop->mcounts[i]
-                        && (pop->mcounts[i] < 2 * pop->diploids.size())
-                        && !pop->mutations[i].neutral)
+                    std::fill(buffer.begin(), buffer.end(), 0);
+                    for (std::size_t row = 0; row < m->nrow; ++row)
                         {
-                            mut_keys.push_back(i);
-                            ucounts.insert(pop->mcounts[i]);
+                            buffer[row / 4] |= static_cast<char>(
+                                plink::genotype_code(static_cast<unsigned>(
+                                    gsl_matrix_get(m->m.get(), row, col)))
+                                << (2 * (row % 4)));
                         }
+                    bed.write(buffer.data(),
+                              static_cast<std::streamsize>(nbytes));
+                    plink::write_bim_line(bim, "m" + std::to_string(col), col);
                 }
+            plink::close(bed, bedname);
+            plink::close(bim, bimname);
+            plink::write_fam(stub + ".fam", m->G, std::vector<double>());
+        }
+
+        template <typename mcont_t, typename mcount_t>
+        void
+        sort_mut_keys(std::vector<KTfwd::uint_t> &mut_keys,
+                      const mcont_t &mutations, const mcount_t &mcounts,
+                      const bool sort_freq, const bool sort_esize)
+        /*!
+          Sort keys by count, descending, and/or by |effect size|,
+          descending.  When both are requested, keys are sorted by
+          |effect size| within each count.
+        */
+        {
             if (sort_freq)
                 {
+                    // the number of unique frequency bins...
+                    std::set<KTfwd::uint_t> ucounts;
+                    for (const auto k : mut_keys)
+                        ucounts.insert(mcounts[k]);
                     // Now, I need to sort based on frequency, descending order
                     std::sort(mut_keys.begin(), mut_keys.end(),
-                              [&pop](KTfwd::uint_t a, KTfwd::uint_t b) {
-                                  return pop->mcounts[a] > pop->mcounts[b];
+                              [&mcounts](KTfwd::uint_t a, KTfwd::uint_t b) {
+                                  return mcounts[a] > mcounts[b];
                               });
                     if (sort_esize)
                         {
@@ -116,21 +152,21 @@ namespace fwdpy
                                 {
                                     auto itr_b = std::find_if(
                                         mut_keys.begin(), mut_keys.end(),
-                                        [&pop, uc](KTfwd::uint_t a) {
-                                            return pop->mcounts[a] == uc;
+                                        [&mcounts, uc](KTfwd::uint_t a) {
+                                            return mcounts[a] == uc;
                                         });
                                     auto itr_e = std::find_if(
                                         itr_b + 1, mut_keys.end(),
-                                        [&pop, uc](KTfwd::uint_t a) {
-                                            return pop->mcounts[a] != uc;
+                                        [&mcounts, uc](KTfwd::uint_t a) {
+                                            return mcounts[a] != uc;
                                         });
                                     std::sort(
-                                        itr_b, itr_e, [&pop](KTfwd::uint_t a,
-                                                             KTfwd::uint_t b) {
-                                            return std::fabs(
-                                                       pop->mutations[a].s)
+                                        itr_b, itr_e,
+                                        [&mutations](KTfwd::uint_t a,
+                                                     KTfwd::uint_t b) {
+                                            return std::fabs(mutations[a].s)
                                                    > std::fabs(
-                                                         pop->mutations[b].s);
+                                                         mutations[b].s);
                                         });
                                 }
                         }
@@ -139,11 +175,51 @@ namespace fwdpy
                 // Simply sort based on |esize|, largest first
                 {
                     std::sort(mut_keys.begin(), mut_keys.end(),
-                              [&pop](KTfwd::uint_t a, KTfwd::uint_t b) {
-                                  return std::fabs(pop->mutations[a].s)
-                                         > std::fabs(pop->mutations[b].s);
+                              [&mutations](KTfwd::uint_t a, KTfwd::uint_t b) {
+                                  return std::fabs(mutations[a].s)
+                                         > std::fabs(mutations[b].s);
                               });
                 }
+        }
+
+        template <typename pop_t>
+        std::vector<KTfwd::uint_t>
+        get_mut_keys(const pop_t *pop, const bool sort_freq = false,
+                     const bool sort_esize = false)
+        {
+            std::vector<KTfwd::uint_t> mut_keys; // array of keys for each
+                                                 // segregating, non-neutral
+                                                 // variant
+            for (std::size_t i = 0; i < pop->mutations.size(); ++i)
+                {
+                    // first check is to avoid extinct variants that fwdpp will
+                    // recycle later.
+                    // The second avoids fixed variants
+                    if (pop->mcounts[i]
+                        && (pop->mcounts[i] < 2 * pop->diploids.size())
+                        && !pop->mutations[i].neutral)
+                        {
+                            mut_keys.push_back(i);
+                        }
+                }
+            sort_mut_keys(mut_keys, pop->mutations, pop->mcounts, sort_freq,
+                          sort_esize);
+            return mut_keys;
+        }
+
+        inline std::vector<KTfwd::uint_t>
+        get_mut_keys(const sampling_pass &p, const bool sort_freq = false,
+                     const bool sort_esize = false)
+        //! As above, with the keys taken from a fwdpy::sampling_pass
+        {
+            std::vector<KTfwd::uint_t> mut_keys;
+            for (const auto k : p.selected)
+                {
+                    if ((*p.mcounts)[k] < p.twoN)
+                        mut_keys.push_back(k);
+                }
+            sort_mut_keys(mut_keys, *p.mutations, *p.mcounts, sort_freq,
+                          sort_esize);
             return mut_keys;
         }
         template <typename pop_t>
@@ -243,6 +319,39 @@ namespace fwdpy
                     row++;
                 }
         }
+        inline void
+        update_matrix_counts(const sampling_pass &p,
+                             const std::vector<KTfwd::uint_t> &mut_keys,
+                             gsl_matrix *rv)
+        /*!
+          As above, with the genotypes taken from a fwdpy::sampling_pass.
+        */
+        {
+            constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+            std::vector<std::size_t> column(p.mutations->size(), none);
+            for (std::size_t i = 0; i < mut_keys.size(); ++i)
+                column[mut_keys[i]] = i + 1;
+            for (std::size_t row = 0; row + 1 < p.offsets.size(); ++row)
+                {
+                    gsl_matrix_set(rv, row, 0, 1.0);
+                    for (std::size_t i = p.offsets[row];
+                         i < p.offsets[row + 1]; ++i)
+                        {
+                            const auto col = column[p.carried[i]];
+                            if (col == none)
+                                throw std::runtime_error(
+                                    "mutation key not found: "
+                                    + std::string(__FILE__) + ", "
+                                    + std::to_string(__LINE__));
+                            if (col >= rv->size2)
+                                throw std::runtime_error(
+                                    "second dimension out of range: "
+                                    + std::string(__FILE__) + ", "
+                                    + std::to_string(__LINE__));
+                            *gsl_matrix_ptr(rv, row, col) += 1.0;
+                        }
+                }
+        }
     }
 }
 
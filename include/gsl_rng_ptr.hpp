@@ -0,0 +1,26 @@
+/*!
+  \file gsl_rng_ptr.hpp
+
+  \brief Smart pointer to a gsl_rng.
+*/
+#ifndef FWDPY_GSL_RNG_PTR_HPP
+#define FWDPY_GSL_RNG_PTR_HPP
+
+#include <gsl/gsl_rng.h>
+#include <memory>
+
+namespace fwdpy
+{
+    struct gsl_rng_deleter
+    {
+        void
+        operator()(gsl_rng *r) noexcept
+        {
+            gsl_rng_free(r);
+        }
+    };
+
+    using gsl_rng_ptr_t = std::unique_ptr<gsl_rng, gsl_rng_deleter>;
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "gsl.hpp"
 #include "types.hpp"
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -57,11 +58,38 @@ namespace fwdpy
                                 }
                         }
                 }
+            // Map each key to its column.  Neutral and causative keys are
+            // disjoint, so one table serves both matrices.
+            constexpr std::size_t no_column
+                = std::numeric_limits<std::size_t>::max();
+            std::vector<std::size_t> column(pop->mutations.size(), no_column);
+            for (std::size_t i = 0; i < neut_indexes.size(); ++i)
+                column[neut_indexes[i]] = i;
+            for (std::size_t i = 0; i < causative_indexes.size(); ++i)
+                column[causative_indexes[i]] = i;
             // Use GSL matrixes
-			gsl::gsl_matrix_ptr_t gn(
-                gsl_matrix_alloc(pop->diploids.size(), neut_indexes.size())),
-                gc(gsl_matrix_alloc(pop->diploids.size(),
-                                    causative_indexes.size()));
+            gsl::gsl_matrix_ptr_t gn(
+                gsl_matrix_calloc(pop->diploids.size(), neut_indexes.size())),
+                gc(gsl_matrix_calloc(pop->diploids.size(),
+                                     causative_indexes.size()));
+            auto add_counts = [&column](
+                const decltype(pop->gametes[0].mutations) &keys,
+                gsl_matrix *m,
+                const std::size_t row) {
+                for (auto k : keys)
+                    {
+                        const auto col = column[k];
+                        if (col != no_column)
+                            {
+                                if (col >= m->size2)
+                                    throw std::out_of_range(
+                                        "column index out of range: "
+                                        + std::to_string(col) + ">="
+                                        + std::to_string(m->size2));
+                                *gsl_matrix_ptr(m, row, col) += 1.0;
+                            }
+                    }
+            };
             // Fill the matrices, etc.
             std::size_t row = 0;
             std::vector<double> G, E;
@@ -74,92 +102,18 @@ namespace fwdpy
                     // Fill selected matrix
                     if (!causative_indexes.empty())
                         {
-                            for (auto k : pop->gametes[dip.first].smutations)
-                                {
-                                    auto i = std::find(
-                                        causative_indexes.begin(),
-                                        causative_indexes.end(), k);
-                                    if (i != causative_indexes.end())
-                                        {
-                                            std::size_t col = std::distance(
-                                                causative_indexes.begin(), i);
-                                            if (col >= gc->size2)
-                                                throw std::out_of_range(
-                                                    "column index out of "
-                                                    "range: "
-                                                    + std::to_string(col)
-                                                    + ">=" + std::to_string(
-                                                                 gc->size2));
-                                            auto m = gsl_matrix_ptr(gc.get(),
-                                                                    row, col);
-                                            *m += 1.0;
-                                        }
-                                }
-                            for (auto k : pop->gametes[dip.second].smutations)
-                                {
-                                    auto i = std::find(
-                                        causative_indexes.begin(),
-                                        causative_indexes.end(), k);
-                                    if (i != causative_indexes.end())
-                                        {
-                                            std::size_t col = std::distance(
-                                                causative_indexes.begin(), i);
-                                            if (col >= gc->size2)
-                                                throw std::out_of_range(
-                                                    "column index out of "
-                                                    "range: "
-                                                    + std::to_string(col)
-                                                    + ">=" + std::to_string(
-                                                                 gc->size2));
-                                            auto m = gsl_matrix_ptr(gc.get(),
-                                                                    row, col);
-                                            *m += 1.0;
-                                        }
-                                }
+                            add_counts(pop->gametes[dip.first].smutations,
+                                       gc.get(), row);
+                            add_counts(pop->gametes[dip.second].smutations,
+                                       gc.get(), row);
                         }
                     // Fill neutral matrix
                     if (!neut_indexes.empty())
                         {
-                            for (auto k : pop->gametes[dip.first].mutations)
-                                {
-                                    auto i = std::find(neut_indexes.begin(),
-                                                       neut_indexes.end(), k);
-                                    if (i != neut_indexes.end())
-                                        {
-                                            std::size_t col = std::distance(
-                                                neut_indexes.begin(), i);
-                                            if (col >= gn->size2)
-                                                throw std::out_of_range(
-                                                    "column index out of "
-                                                    "range: "
-                                                    + std::to_string(col)
-                                                    + ">=" + std::to_string(
-                                                                 gn->size2));
-                                            auto m = gsl_matrix_ptr(gn.get(),
-                                                                    row, col);
-                                            *m += 1.0;
-                                        }
-                                }
-                            for (auto k : pop->gametes[dip.second].mutations)
-                                {
-                                    auto i = std::find(neut_indexes.begin(),
-                                                       neut_indexes.end(), k);
-                                    if (i != neut_indexes.end())
-                                        {
-                                            std::size_t col = std::distance(
-                                                neut_indexes.begin(), i);
-                                            if (col >= gn->size2)
-                                                throw std::out_of_range(
-                                                    "column index out of "
-                                                    "range: "
-                                                    + std::to_string(col)
-                                                    + ">=" + std::to_string(
-                                                                 gn->size2));
-                                            auto m = gsl_matrix_ptr(gn.get(),
-                                                                    row, col);
-                                            *m += 1.0;
-                                        }
-                                }
+                            add_counts(pop->gametes[dip.first].mutations,
+                                       gn.get(), row);
+                            add_counts(pop->gametes[dip.second].mutations,
+                                       gn.get(), row);
                         }
                     ++row;
                 }
@@ -0,0 +1,262 @@
+/*!
+  \file gwas_scan.hpp
+
+  \brief Marginal association tests at every segregating site.
+
+  For each site, the phenotype y = G + E is regressed on the number of
+  derived alleles, x, by ordinary least squares.  Genotypes are taken from
+  a fwdpy::packed_haplotype_matrix.  Sums of x and x^2 come from popcounts
+  of each column.  The cross-products sum(x*y) are computed for blocks of
+  sites at a time by expanding the block to doubles and calling
+  gsl_blas_dgemv.
+*/
+#ifndef FWDPY_GWAS_SCAN_HPP
+#define FWDPY_GWAS_SCAN_HPP
+
+#include "packed_haplotype_matrix.hpp"
+#include "popcount.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_cdf.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fwdpy
+{
+    namespace gwas
+    {
+        struct scan_result
+        /*!
+          Columnar output of fwdpy::gwas::scan, with one element per site,
+          in order of position.  esize is 0 for neutral sites.  beta, se
+          and pvalue are NaN if x does not vary among individuals.
+        */
+        {
+            std::vector<double> pos, freq, esize, beta, se, pvalue;
+            std::vector<int> neutral;
+        };
+
+        namespace scan_detail
+        {
+            //! Number of sites expanded to doubles per call to gsl_blas_dgemv
+            constexpr std::size_t block_size = 128;
+
+            struct site
+            {
+                double pos, esize;
+                const packed_haplotype_matrix::word_t *bits;
+                bool neutral;
+            };
+
+            inline std::uint64_t
+            homozygotes(const packed_haplotype_matrix::word_t *col,
+                        const std::size_t nwords) noexcept
+            /*!
+              \return The number of individuals with two derived alleles.
+              Rows 2i and 2i+1 are always in the same word.
+            */
+            {
+                std::uint64_t rv = 0;
+                for (std::size_t w = 0; w < nwords; ++w)
+                    rv += std::uint64_t(__builtin_popcountll(
+                        col[w] & (col[w] >> 1)
+                        & packed_haplotype_matrix::word_t(
+                              0x5555555555555555ULL)));
+                return rv;
+            }
+
+            inline void
+            expand(const packed_haplotype_matrix::word_t *col,
+                   const std::size_t nind, double *x) noexcept
+            //! Fill x with the number of derived alleles in each individual
+            {
+                for (std::size_t i = 0; i < nind; ++i)
+                    {
+                        const auto w = col[(2 * i)
+                                           / packed_haplotype_matrix::word_bits]
+                                       >> ((2 * i)
+                                           % packed_haplotype_matrix::word_bits);
+                        x[i] = double((w & 1) + ((w >> 1) & 1));
+                    }
+            }
+
+            inline std::vector<site>
+            get_sites(const packed_haplotype_matrix &hm, const double minfreq)
+            // Neutral and selected sites, merged by position
+            {
+                std::vector<site> rv;
+                std::size_t i = 0, j = 0;
+                while (i < hm.ncol_n || j < hm.ncol_s)
+                    {
+                        const bool neutral
+                            = (j == hm.ncol_s)
+                              || (i < hm.ncol_n && hm.np[i] <= hm.sp[j]);
+                        const double f = neutral ? hm.nf[i] : hm.sf[j];
+                        const site s
+                            = neutral
+                                  ? site{ hm.np[i], 0.,
+                                          hm.n.data()
+                                              + i * hm.words_per_column,
+                                          true }
+                                  : site{ hm.sp[j], hm.esizes[j],
+                                          hm.s.data()
+                                              + j * hm.words_per_column,
+                                          false };
+                        (neutral ? i : j)++;
+                        if (std::min(f, 1. - f) >= minfreq)
+                            rv.push_back(s);
+                    }
+                return rv;
+            }
+        }
+
+        inline scan_result
+        scan(const packed_haplotype_matrix &hm, const double minfreq)
+        /*!
+          \param hm Genotypes and G and E of each individual
+          \param minfreq Sites with minor allele frequency less than this
+          are skipped.  Frequencies are those in the population.
+        */
+        {
+            const std::size_t nind = hm.G.size();
+            if (nind < 3)
+                throw std::invalid_argument(
+                    "at least three individuals are required");
+            const double df = double(nind - 2);
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+
+            // Centered phenotypes
+            std::vector<double> y(nind);
+            double ybar = 0.;
+            for (std::size_t i = 0; i < nind; ++i)
+                {
+                    y[i] = hm.G[i] + hm.E[i];
+                    ybar += y[i];
+                }
+            ybar /= double(nind);
+            double Syy = 0.;
+            for (auto &yi : y)
+                {
+                    yi -= ybar;
+                    Syy += yi * yi;
+                }
+            auto yv = gsl_vector_view_array(y.data(), nind);
+
+            const auto sites = scan_detail::get_sites(hm, minfreq);
+            scan_result rv;
+            std::vector<double> X(scan_detail::block_size * nind),
+                Sxy(scan_detail::block_size);
+            for (std::size_t b = 0; b < sites.size();
+                 b += scan_detail::block_size)
+                {
+                    const std::size_t nb = std::min(scan_detail::block_size,
+                                                    sites.size() - b);
+                    for (std::size_t j = 0; j < nb; ++j)
+                        scan_detail::expand(sites[b + j].bits, nind,
+                                            X.data() + j * nind);
+                    auto Xv = gsl_matrix_view_array(X.data(), nb, nind);
+                    auto Sxyv = gsl_vector_view_array(Sxy.data(), nb);
+                    // y is centered, so X*y is sum((x-xbar)*(y-ybar))
+                    gsl_blas_dgemv(CblasNoTrans, 1.0, &Xv.matrix, &yv.vector,
+                                   0.0, &Sxyv.vector);
+                    for (std::size_t j = 0; j < nb; ++j)
+                        {
+                            const auto &s = sites[b + j];
+                            const double sumx = double(
+                                popcount(s.bits, hm.words_per_column));
+                            const double sumx2
+                                = sumx
+                                  + 2. * double(scan_detail::homozygotes(
+                                             s.bits, hm.words_per_column));
+                            const double Sxx
+                                = sumx2 - sumx * sumx / double(nind);
+                            rv.pos.push_back(s.pos);
+                            rv.freq.push_back(sumx / double(2 * nind));
+                            rv.esize.push_back(s.esize);
+                            rv.neutral.push_back(s.neutral);
+                            if (!(Sxx > 0.))
+                                {
+                                    rv.beta.push_back(nan);
+                                    rv.se.push_back(nan);
+                                    rv.pvalue.push_back(nan);
+                                    continue;
+                                }
+                            const double beta = Sxy[j] / Sxx;
+                            const double rss
+                                = std::max(Syy - beta * Sxy[j], 0.);
+                            const double se = std::sqrt(rss / df / Sxx);
+                            rv.beta.push_back(beta);
+                            rv.se.push_back(se);
+                            rv.pvalue.push_back(
+                                (se > 0.)
+                                    ? 2. * gsl_cdf_tdist_Q(
+                                               std::fabs(beta / se), df)
+                                    : 0.);
+                        }
+                }
+            return rv;
+        }
+
+        template <typename pop_t>
+        scan_result
+        scan(const pop_t *pop, const double minfreq)
+        /*!
+          Scan all individuals in pop.  Sites fixed in the population are
+          skipped.
+        */
+        {
+            std::vector<std::size_t> individuals(pop->diploids.size());
+            for (std::size_t i = 0; i < individuals.size(); ++i)
+                individuals[i] = i;
+            return scan(make_packed_haplotype_matrix(pop, individuals),
+                        minfreq);
+        }
+
+        template <typename pop_t>
+        std::vector<scan_result>
+        scan(const std::vector<std::shared_ptr<pop_t>> &pops,
+             const double minfreq)
+        /*!
+          Scan each population in a separate thread.  The first exception
+          thrown is re-thrown after all threads finish.
+        */
+        {
+            if (!(minfreq >= 0. && minfreq <= 0.5))
+                throw std::invalid_argument("minfreq must be in [0,0.5]");
+            std::vector<scan_result> rv(pops.size());
+            std::vector<std::exception_ptr> errors(pops.size());
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < pops.size(); ++i)
+                {
+                    threads.emplace_back([&pops, &rv, &errors, minfreq, i]() {
+                        try
+                            {
+                                rv[i] = scan(pops[i].get(), minfreq);
+                            }
+                        catch (...)
+                            {
+                                errors[i] = std::current_exception();
+                            }
+                    });
+                }
+            for (auto &t : threads)
+                t.join();
+            for (auto &e : errors)
+                {
+                    if (e)
+                        std::rethrow_exception(e);
+                }
+            return rv;
+        }
+    }
+}
+
+#endif
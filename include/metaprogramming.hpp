@@ -10,6 +10,7 @@
 #include <future>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 namespace fwdpy
 {
@@ -36,6 +37,28 @@ namespace fwdpy
                 }
             return rv;
         }
+
+        /*!
+          Detects "rules" types whose random component of the offspring
+          trait value can be supplied in bulk.  Such types provide:
+
+          double noise_sd() const;
+          void update_from_noise(const double, diploid_t &, const gcont_t &,
+                                 const mcont_t &,
+                                 const single_region_fitness_fxn &) const;
+        */
+        template <typename rules_t, typename = void>
+        struct has_batched_noise : std::false_type
+        {
+        };
+
+        template <typename rules_t>
+        struct has_batched_noise<rules_t,
+                                 decltype(void(std::declval<const rules_t &>()
+                                                   .noise_sd()))>
+            : std::true_type
+        {
+        };
     }
 }
 
@@ -0,0 +1,313 @@
+/*!
+  \file packed_haplotype_matrix.hpp
+
+  \brief A haplotype matrix stored at one bit per allele.
+
+  Compared to fwdpy::haplotype_matrix, which records the flat index of each
+  derived allele as a std::size_t, this representation needs 1 bit per
+  (haplotype, site) pair and is filled without searching for each mutation's
+  column.
+
+  Layout: the matrix is column-major in 64-bit words.  Column j (a site)
+  occupies words [j*words_per_column, (j+1)*words_per_column), and row i (a
+  haplotype) is bit i%64 of word i/64 within that range.  Unused bits of the
+  last word of each column are zero.  Rows 2i and 2i+1 are the two
+  haplotypes of the i-th diploid in the sample.
+*/
+#ifndef FWDPY_PACKED_HAPLOTYPE_MATRIX_HPP
+#define FWDPY_PACKED_HAPLOTYPE_MATRIX_HPP
+
+#include "types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace fwdpy
+{
+    struct packed_haplotype_matrix
+    {
+        using word_t = std::uint64_t;
+        static constexpr std::size_t word_bits = 64;
+        //! Bits for neutral markers
+        std::vector<word_t> n;
+        //! Bits for selected markers
+        std::vector<word_t> s;
+        //! Positions of neutral markers
+        std::vector<double> np;
+        //! Frequencies of neutral markers
+        std::vector<double> nf;
+        //! Positions of selected markers
+        std::vector<double> sp;
+        //! Frequencies of selected markers
+        std::vector<double> sf;
+        //! Genetic value
+        std::vector<double> G;
+        //! Random value
+        std::vector<double> E;
+        //! fitness
+        std::vector<double> w;
+        //! Effect sizes of mutations
+        std::vector<double> esizes;
+        //! Dominances of mutations
+        std::vector<double> h;
+        std::size_t nrow, ncol_n, ncol_s, words_per_column;
+
+        packed_haplotype_matrix()
+            : n{}, s{}, np{}, nf{}, sp{}, sf{}, G{}, E{}, w{}, esizes{}, h{},
+              nrow(0), ncol_n(0), ncol_s(0), words_per_column(0)
+        {
+        }
+
+        //! \return true if haplotype row carries the derived allele at col
+        static bool
+        get(const std::vector<word_t> &bits, const std::size_t words_per_column,
+            const std::size_t row, const std::size_t col) noexcept
+        {
+            return (bits[col * words_per_column + row / word_bits]
+                    >> (row % word_bits))
+                   & word_t(1);
+        }
+    };
+
+    namespace packed_detail
+    {
+        constexpr std::size_t no_column
+            = std::numeric_limits<std::size_t>::max();
+
+        template <typename mcont_t>
+        void
+        assign_columns(std::vector<std::size_t> &keys, const mcont_t &mutations,
+                       const std::vector<unsigned> &mcounts,
+                       const std::size_t twoN, std::vector<std::size_t> &column,
+                       std::vector<double> &pos, std::vector<double> &freq)
+        // Sort keys by position and record each key's column
+        {
+            std::sort(keys.begin(), keys.end(),
+                      [&mutations](const std::size_t i, const std::size_t j) {
+                          return mutations[i].pos < mutations[j].pos;
+                      });
+            pos.reserve(keys.size());
+            freq.reserve(keys.size());
+            for (std::size_t i = 0; i < keys.size(); ++i)
+                {
+                    column[keys[i]] = i;
+                    pos.push_back(mutations[keys[i]].pos);
+                    freq.push_back(double(mcounts[keys[i]]) / double(twoN));
+                }
+        }
+
+        template <typename key_container>
+        void
+        set_bits(const key_container &keys,
+                 const std::vector<std::size_t> &column, const std::size_t row,
+                 const std::size_t words_per_column,
+                 std::vector<packed_haplotype_matrix::word_t> &bits)
+        {
+            const auto word = row / packed_haplotype_matrix::word_bits;
+            const auto bit = packed_haplotype_matrix::word_t(1)
+                             << (row % packed_haplotype_matrix::word_bits);
+            for (const auto k : keys)
+                {
+                    const auto c = column[k];
+                    if (c != no_column)
+                        bits[c * words_per_column + word] |= bit;
+                }
+        }
+
+        template <typename gcont_t, typename mcont_t,
+                  typename haplotype_gametes>
+        packed_haplotype_matrix
+        make_packed(const gcont_t &gametes, const mcont_t &mutations,
+                    const std::vector<unsigned> &mcounts,
+                    const std::size_t twoN, const std::size_t nhaplotypes,
+                    const haplotype_gametes &for_each_gamete,
+                    const bool skip_fixed = true)
+        /*!
+          for_each_gamete(row, f) must call f(gamete index) for each gamete
+          making up haplotype row.  For a single locus, that is one gamete.
+
+          If skip_fixed is true, mutations fixed in the population
+          (mcounts == twoN) are not included.
+        */
+        {
+            packed_haplotype_matrix rv;
+            rv.nrow = nhaplotypes;
+
+            // Step 1: find the segregating mutations.  Each distinct gamete
+            // is visited once, regardless of how many times it is sampled.
+            std::vector<char> gamete_seen(gametes.size(), 0);
+            std::vector<char> key_seen(mutations.size(), 0);
+            std::vector<std::size_t> nkeys, skeys;
+            auto visit = [&](const std::size_t g) {
+                if (gamete_seen[g])
+                    return;
+                gamete_seen[g] = 1;
+                for (const auto k : gametes[g].mutations)
+                    {
+                        if (!key_seen[k]
+                            && (!skip_fixed || mcounts[k] < twoN))
+                            {
+                                key_seen[k] = 1;
+                                nkeys.push_back(k);
+                            }
+                    }
+                for (const auto k : gametes[g].smutations)
+                    {
+                        if (!key_seen[k]
+                            && (!skip_fixed || mcounts[k] < twoN))
+                            {
+                                key_seen[k] = 1;
+                                skeys.push_back(k);
+                            }
+                    }
+            };
+            for (std::size_t row = 0; row < nhaplotypes; ++row)
+                for_each_gamete(row, visit);
+
+            // Step 2: key -> column lookup table
+            std::vector<std::size_t> column(mutations.size(), no_column);
+            assign_columns(nkeys, mutations, mcounts, twoN, column, rv.np,
+                           rv.nf);
+            assign_columns(skeys, mutations, mcounts, twoN, column, rv.sp,
+                           rv.sf);
+            rv.esizes.reserve(skeys.size());
+            rv.h.reserve(skeys.size());
+            for (const auto k : skeys)
+                {
+                    rv.esizes.push_back(mutations[k].s);
+                    rv.h.push_back(mutations[k].h);
+                }
+            rv.ncol_n = nkeys.size();
+            rv.ncol_s = skeys.size();
+
+            // Step 3: fill the bits
+            rv.words_per_column
+                = (nhaplotypes + packed_haplotype_matrix::word_bits - 1)
+                  / packed_haplotype_matrix::word_bits;
+            rv.n.assign(rv.ncol_n * rv.words_per_column, 0);
+            rv.s.assign(rv.ncol_s * rv.words_per_column, 0);
+            for (std::size_t row = 0; row < nhaplotypes; ++row)
+                {
+                    for_each_gamete(row, [&](const std::size_t g) {
+                        set_bits(gametes[g].mutations, column, row,
+                                 rv.words_per_column, rv.n);
+                        set_bits(gametes[g].smutations, column, row,
+                                 rv.words_per_column, rv.s);
+                    });
+                }
+            return rv;
+        }
+
+        template <typename dipvec_t> struct single_locus_gametes
+        {
+            const dipvec_t &diploids;
+            const std::vector<std::size_t> &sample;
+            template <typename F>
+            void
+            operator()(const std::size_t row, F &&f) const
+            {
+                const auto &dip = diploids[sample[row / 2]];
+                f((row % 2) ? dip.second : dip.first);
+            }
+        };
+
+        template <typename dipvec_t> struct multi_locus_gametes
+        {
+            const dipvec_t &diploids;
+            const std::vector<std::size_t> &sample;
+            template <typename F>
+            void
+            operator()(const std::size_t row, F &&f) const
+            {
+                for (const auto &locus : diploids[sample[row / 2]])
+                    f((row % 2) ? locus.second : locus.first);
+            }
+        };
+
+        template <typename dipvec_t>
+        void
+        check_sample(const dipvec_t &diploids,
+                     const std::vector<std::size_t> &diploids_sample)
+        {
+            for (const auto dip : diploids_sample)
+                {
+                    if (dip >= diploids.size())
+                        throw std::out_of_range("diploid index out of range");
+                }
+        }
+
+        template <typename dipvec_t, typename gcont_t, typename mcont_t>
+        packed_haplotype_matrix
+        make_packed_single_deme(const dipvec_t &diploids,
+                                const gcont_t &gametes,
+                                const mcont_t &mutations,
+                                const std::vector<unsigned> &mcounts,
+                                const std::vector<std::size_t> &diploids_sample)
+        {
+            check_sample(diploids, diploids_sample);
+            auto rv = make_packed(
+                gametes, mutations, mcounts, 2 * diploids.size(),
+                2 * diploids_sample.size(),
+                single_locus_gametes<dipvec_t>{ diploids, diploids_sample });
+            for (const auto dip : diploids_sample)
+                {
+                    rv.G.push_back(diploids[dip].g);
+                    rv.E.push_back(diploids[dip].e);
+                    rv.w.push_back(diploids[dip].w);
+                }
+            return rv;
+        }
+    }
+
+    inline packed_haplotype_matrix
+    make_packed_haplotype_matrix(const singlepop_t *pop,
+                                 const std::vector<std::size_t> &diploids)
+    /*!
+      Create a bit-packed haplotype matrix from a single deme from a specified
+      set of individuals
+    */
+    {
+        return packed_detail::make_packed_single_deme(
+            pop->diploids, pop->gametes, pop->mutations, pop->mcounts,
+            diploids);
+    }
+
+    inline packed_haplotype_matrix
+    make_packed_haplotype_matrix(const metapop_t *pop,
+                                 const std::vector<std::size_t> &diploids,
+                                 const std::size_t deme)
+    {
+        if (deme >= pop->diploids.size())
+            throw std::out_of_range("deme index out of range");
+        return packed_detail::make_packed_single_deme(
+            pop->diploids[deme], pop->gametes, pop->mutations, pop->mcounts,
+            diploids);
+    }
+
+    inline packed_haplotype_matrix
+    make_packed_haplotype_matrix(const multilocus_t *pop,
+                                 const std::vector<std::size_t> &diploids)
+    /*!
+      Create a bit-packed haplotype matrix from a multi-locus population.
+      Each row is the union of one haplotype over all loci.
+    */
+    {
+        packed_detail::check_sample(pop->diploids, diploids);
+        auto rv = packed_detail::make_packed(
+            pop->gametes, pop->mutations, pop->mcounts,
+            2 * pop->diploids.size(), 2 * diploids.size(),
+            packed_detail::multi_locus_gametes<decltype(pop->diploids)>{
+                pop->diploids, diploids });
+        for (const auto dip : diploids)
+            {
+                rv.G.push_back(pop->diploids[dip][0].g);
+                rv.E.push_back(pop->diploids[dip][0].e);
+                rv.w.push_back(pop->diploids[dip][0].w);
+            }
+        return rv;
+    }
+}
+
+#endif
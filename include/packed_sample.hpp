@@ -0,0 +1,298 @@
+/*!
+  \file packed_sample.hpp
+
+  \brief Samples stored as positions plus a bit matrix.
+
+  KTfwd::sample_t stores each site as a std::string of '0'/'1' characters,
+  which costs one byte per chromosome per site.  fwdpy::packed_sample uses
+  one bit, in the layout of fwdpy::packed_haplotype_matrix: site j occupies
+  words [j*words_per_site, (j+1)*words_per_site), and chromosome i is bit
+  i%64 of word i/64 within that range.
+*/
+#ifndef FWDPY_PACKED_SAMPLE_HPP
+#define FWDPY_PACKED_SAMPLE_HPP
+
+#include "packed_haplotype_matrix.hpp"
+#include "popcount.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <fwdpp/sugar/sampling.hpp>
+#include <gsl/gsl_randist.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fwdpy
+{
+    struct packed_sample
+    {
+        using word_t = packed_haplotype_matrix::word_t;
+        //! Positions of each site, in increasing order
+        std::vector<double> pos;
+        std::vector<word_t> bits;
+        //! Number of chromosomes in the sample
+        unsigned nsam;
+        std::size_t words_per_site;
+
+        packed_sample() : pos{}, bits{}, nsam(0), words_per_site(0) {}
+
+        explicit packed_sample(const unsigned nsam_)
+            : pos{}, bits{}, nsam(nsam_),
+              words_per_site((nsam_ + packed_haplotype_matrix::word_bits - 1)
+                             / packed_haplotype_matrix::word_bits)
+        {
+        }
+
+        std::size_t
+        size() const noexcept
+        //! \return Number of sites
+        {
+            return pos.size();
+        }
+
+        const word_t *
+        site(const std::size_t j) const noexcept
+        {
+            return bits.data() + j * words_per_site;
+        }
+
+        bool
+        derived(const std::size_t j, const std::size_t chrom) const noexcept
+        {
+            return packed_haplotype_matrix::get(bits, words_per_site, chrom,
+                                                j);
+        }
+
+        std::vector<unsigned>
+        derived_counts() const
+        //! \return Number of derived alleles at each site
+        {
+            std::vector<unsigned> rv;
+            rv.reserve(size());
+            for (std::size_t j = 0; j < size(); ++j)
+                rv.push_back(unsigned(popcount(site(j), words_per_site)));
+            return rv;
+        }
+
+        KTfwd::sample_t
+        to_strings() const
+        //! \return The sample as '0'/'1' strings, one per site
+        {
+            KTfwd::sample_t rv;
+            rv.reserve(size());
+            for (std::size_t j = 0; j < size(); ++j)
+                {
+                    std::string s(nsam, '0');
+                    for (unsigned i = 0; i < nsam; ++i)
+                        {
+                            if (derived(j, i))
+                                s[i] = '1';
+                        }
+                    rv.emplace_back(pos[j], std::move(s));
+                }
+            return rv;
+        }
+
+        static packed_sample
+        from_strings(const KTfwd::sample_t &sample)
+        //! Pack a sample.  All strings must have the same length.
+        {
+            packed_sample rv(sample.empty()
+                                 ? 0u
+                                 : unsigned(sample.front().second.size()));
+            rv.bits.assign(sample.size() * rv.words_per_site, 0);
+            for (std::size_t j = 0; j < sample.size(); ++j)
+                {
+                    if (sample[j].second.size() != rv.nsam)
+                        throw std::invalid_argument(
+                            "all sites must have the same sample size");
+                    rv.pos.push_back(sample[j].first);
+                    for (unsigned i = 0; i < rv.nsam; ++i)
+                        {
+                            if (sample[j].second[i] == '1')
+                                rv.bits[j * rv.words_per_site
+                                        + i / packed_haplotype_matrix::
+                                                  word_bits]
+                                    |= word_t(1)
+                                       << (i % packed_haplotype_matrix::
+                                                   word_bits);
+                        }
+                }
+            return rv;
+        }
+    };
+
+    //! Neutral and selected sites, analagous to KTfwd::sep_sample_t
+    using packed_sep_sample_t = std::pair<packed_sample, packed_sample>;
+
+    namespace packed_detail
+    {
+        inline void
+        copy_sites(const std::vector<packed_haplotype_matrix::word_t> &bits,
+                   const std::vector<double> &pos,
+                   const std::size_t words_per_column, const double beg,
+                   const double end, const bool removeFixed,
+                   packed_sample &s)
+        // Append columns with positions in [beg,end)
+        {
+            for (std::size_t c = 0; c < pos.size(); ++c)
+                {
+                    if (pos[c] < beg || pos[c] >= end)
+                        continue;
+                    const auto col = bits.data() + c * words_per_column;
+                    if (removeFixed
+                        && popcount(col, words_per_column) == s.nsam)
+                        continue;
+                    s.pos.push_back(pos[c]);
+                    s.bits.insert(s.bits.end(), col, col + words_per_column);
+                }
+        }
+
+        template <typename mcont_t>
+        void
+        add_fixations(const mcont_t &fixations, const bool neutral,
+                      const double beg, const double end, packed_sample &s)
+        /*
+          Append sites, with all chromosomes derived, for fixations in
+          [beg,end) not already present in s, then restore position order.
+          This matches KTfwd::sample_separate when removeFixed is false.
+        */
+        {
+            const std::size_t nold = s.size();
+            std::vector<packed_sample::word_t> ones(s.words_per_site,
+                                                    ~packed_sample::word_t(0));
+            if (s.nsam % packed_haplotype_matrix::word_bits)
+                ones.back() = (packed_sample::word_t(1)
+                               << (s.nsam % packed_haplotype_matrix::word_bits))
+                              - 1;
+            for (const auto &f : fixations)
+                {
+                    if (f.neutral != neutral || f.pos < beg || f.pos >= end
+                        || std::binary_search(s.pos.begin(),
+                                              s.pos.begin() + nold, f.pos))
+                        continue;
+                    s.pos.push_back(f.pos);
+                    s.bits.insert(s.bits.end(), ones.begin(), ones.end());
+                }
+            if (s.size() == nold)
+                return;
+            std::vector<std::size_t> order(s.size());
+            for (std::size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(),
+                             [&s](const std::size_t a, const std::size_t b) {
+                                 return s.pos[a] < s.pos[b];
+                             });
+            packed_sample sorted(s.nsam);
+            for (const auto i : order)
+                {
+                    sorted.pos.push_back(s.pos[i]);
+                    sorted.bits.insert(sorted.bits.end(), s.site(i),
+                                       s.site(i) + s.words_per_site);
+                }
+            s = std::move(sorted);
+        }
+
+        template <typename dipvec_t>
+        std::vector<std::size_t>
+        sample_individuals(const gsl_rng *r, const dipvec_t &diploids,
+                           const unsigned nsam)
+        /*!
+          Individuals are chosen uniformly, with replacement, and both of
+          their chromosomes are sampled.  If nsam is odd, only the first
+          chromosome of the last individual is used.  This is the scheme
+          used by KTfwd::sample_separate.
+        */
+        {
+            if (diploids.empty())
+                throw std::runtime_error("population is empty");
+            std::vector<std::size_t> rv;
+            for (unsigned i = 0; i < nsam / 2 + nsam % 2; ++i)
+                rv.push_back(std::size_t(
+                    gsl_ran_flat(r, 0., double(diploids.size()))));
+            return rv;
+        }
+    }
+
+    inline packed_sep_sample_t
+    packed_sample_separate(const gsl_rng *r, const singlepop_t &pop,
+                           const unsigned nsam, const bool removeFixed)
+    /*!
+      Take a sample of nsam chromosomes, without building strings.
+
+      \note When removeFixed is true, sites where all nsam chromosomes
+      carry the derived allele are removed, as in KTfwd::sample_separate.
+      Otherwise, pop.fixations are included.  Selected fixations that are
+      also still in pop.mutations (as in the qtrait modules) appear once.
+    */
+    {
+        const auto individuals
+            = packed_detail::sample_individuals(r, pop.diploids, nsam);
+        const auto hm = packed_detail::make_packed(
+            pop.gametes, pop.mutations, pop.mcounts, 2 * pop.diploids.size(),
+            nsam,
+            packed_detail::single_locus_gametes<decltype(pop.diploids)>{
+                pop.diploids, individuals },
+            false);
+        packed_sep_sample_t rv{ packed_sample(nsam), packed_sample(nsam) };
+        const double inf = std::numeric_limits<double>::infinity();
+        packed_detail::copy_sites(hm.n, hm.np, hm.words_per_column, -inf, inf,
+                                  removeFixed, rv.first);
+        packed_detail::copy_sites(hm.s, hm.sp, hm.words_per_column, -inf, inf,
+                                  removeFixed, rv.second);
+        if (!removeFixed)
+            {
+                packed_detail::add_fixations(pop.fixations, true, -inf, inf,
+                                             rv.first);
+                packed_detail::add_fixations(pop.fixations, false, -inf, inf,
+                                             rv.second);
+            }
+        return rv;
+    }
+
+    inline std::vector<packed_sep_sample_t>
+    packed_sample_separate(
+        const gsl_rng *r, const multilocus_t &pop, const unsigned nsam,
+        const bool removeFixed,
+        const std::vector<std::pair<double, double>> &locus_boundaries)
+    /*!
+      Take a sample of nsam chromosomes from a multi-locus population.
+      Sites are assigned to loci by the half-open intervals in
+      locus_boundaries.
+    */
+    {
+        const auto individuals
+            = packed_detail::sample_individuals(r, pop.diploids, nsam);
+        const auto hm = packed_detail::make_packed(
+            pop.gametes, pop.mutations, pop.mcounts, 2 * pop.diploids.size(),
+            nsam,
+            packed_detail::multi_locus_gametes<decltype(pop.diploids)>{
+                pop.diploids, individuals },
+            false);
+        std::vector<packed_sep_sample_t> rv;
+        for (const auto &b : locus_boundaries)
+            {
+                rv.emplace_back(packed_sample(nsam), packed_sample(nsam));
+                packed_detail::copy_sites(hm.n, hm.np, hm.words_per_column,
+                                          b.first, b.second, removeFixed,
+                                          rv.back().first);
+                packed_detail::copy_sites(hm.s, hm.sp, hm.words_per_column,
+                                          b.first, b.second, removeFixed,
+                                          rv.back().second);
+                if (!removeFixed)
+                    {
+                        packed_detail::add_fixations(pop.fixations, true,
+                                                     b.first, b.second,
+                                                     rv.back().first);
+                        packed_detail::add_fixations(pop.fixations, false,
+                                                     b.first, b.second,
+                                                     rv.back().second);
+                    }
+            }
+        return rv;
+    }
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*!
+  \file philox_rng.hpp
+
+  \brief Counter-based random number generation via the gsl_rng interface.
+
+  Philox4x32-10 (Salmon et al. 2011, "Parallel random numbers: as easy as
+  1, 2, 3") maps a 128-bit counter and a 64-bit key to 128 random bits.
+  There is no sequential state, so any number of independent streams can
+  be created by choosing different counters.
+
+  Here, the key is a seed and the counter is laid out as:
+
+  * ctr[0]: number of 128-bit blocks drawn from the stream so far
+  * ctr[1]: sub-stream (e.g., an offspring index)
+  * ctr[2]: generation
+  * ctr[3]: replicate
+
+  The generator is registered as a gsl_rng_type, so a stream may be passed to
+  anything taking a gsl_rng *, such as fwdpp's mutation and recombination
+  policies or the "rules" classes.
+*/
+#ifndef FWDPY_PHILOX_RNG_HPP
+#define FWDPY_PHILOX_RNG_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <gsl/gsl_math.h>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include <stdexcept>
+
+namespace fwdpy
+{
+    namespace philox
+    {
+        struct philox4x32_state
+        {
+            std::uint32_t key[2];
+            std::uint32_t ctr[4];
+            std::uint32_t out[4];
+            //! Next element of out to return.  4 means a new block is needed.
+            unsigned idx;
+        };
+
+        //! The Philox4x32 bijection with 10 rounds.
+        inline void
+        philox4x32_10(const std::uint32_t ctr[4], const std::uint32_t key[2],
+                      std::uint32_t out[4]) noexcept
+        {
+            const std::uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57,
+                                W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+            std::uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+            std::uint32_t k0 = key[0], k1 = key[1];
+            for (unsigned round = 0; round < 10; ++round)
+                {
+                    const std::uint64_t p0 = std::uint64_t(M0) * c0;
+                    const std::uint64_t p1 = std::uint64_t(M1) * c2;
+                    const std::uint32_t hi0 = std::uint32_t(p0 >> 32),
+                                        lo0 = std::uint32_t(p0),
+                                        hi1 = std::uint32_t(p1 >> 32),
+                                        lo1 = std::uint32_t(p1);
+                    c0 = hi1 ^ c1 ^ k0;
+                    c1 = lo1;
+                    c2 = hi0 ^ c3 ^ k1;
+                    c3 = lo0;
+                    k0 += W0;
+                    k1 += W1;
+                }
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+
+        inline std::uint32_t
+        next(philox4x32_state *s) noexcept
+        {
+            if (s->idx == 4)
+                {
+                    philox4x32_10(s->ctr, s->key, s->out);
+                    ++s->ctr[0];
+                    s->idx = 0;
+                }
+            return s->out[s->idx++];
+        }
+
+        inline void
+        philox_set(void *vstate, unsigned long seed)
+        {
+            auto s = static_cast<philox4x32_state *>(vstate);
+            s->key[0] = std::uint32_t(seed);
+            s->key[1] = std::uint32_t(std::uint64_t(seed) >> 32);
+            s->ctr[0] = s->ctr[1] = s->ctr[2] = s->ctr[3] = 0;
+            s->idx = 4;
+        }
+
+        inline unsigned long
+        philox_get(void *vstate)
+        {
+            return next(static_cast<philox4x32_state *>(vstate));
+        }
+
+        inline double
+        philox_get_double(void *vstate)
+        {
+            return double(next(static_cast<philox4x32_state *>(vstate)))
+                   / 4294967296.0;
+        }
+
+        //! \return The gsl_rng_type for Philox4x32-10
+        inline const gsl_rng_type *
+        gsl_rng_philox4x32()
+        {
+            static const gsl_rng_type t
+                = { "philox4x32-10",     0xffffffffUL, 0,
+                    sizeof(philox4x32_state), &philox_set, &philox_get,
+                    &philox_get_double };
+            return &t;
+        }
+
+        inline bool
+        is_philox(const gsl_rng *r)
+        {
+            return r->type == gsl_rng_philox4x32();
+        }
+
+        inline void
+        set_stream(gsl_rng *r, const unsigned long seed,
+                   const std::uint32_t substream,
+                   const std::uint32_t generation,
+                   const std::uint32_t replicate)
+        /*!
+          Position r at the start of the stream identified by
+          (seed, replicate, generation, substream).  This costs the same as
+          writing a few integers, so streams may be switched per offspring.
+
+          \throw std::invalid_argument if r was not allocated with
+          gsl_rng_philox4x32()
+        */
+        {
+            if (!is_philox(r))
+                throw std::invalid_argument(
+                    "set_stream requires a philox4x32-10 gsl_rng");
+            auto s = static_cast<philox4x32_state *>(r->state);
+            philox_set(s, seed);
+            s->ctr[1] = substream;
+            s->ctr[2] = generation;
+            s->ctr[3] = replicate;
+        }
+
+        inline void
+        gaussian_batch(const gsl_rng *r, const double sigma, double *out,
+                       const std::size_t n)
+        /*!
+          Fill out with n Gaussian deviates with mean zero and standard
+          deviation sigma.
+
+          For Philox streams, deviates are generated in pairs by the
+          Box-Muller transform applied to the raw 32-bit output, which avoids
+          a function-pointer call and a rejection step per deviate.  Other
+          generators fall back to gsl_ran_gaussian_ziggurat.
+        */
+        {
+            if (!is_philox(r))
+                {
+                    for (std::size_t i = 0; i < n; ++i)
+                        out[i] = gsl_ran_gaussian_ziggurat(r, sigma);
+                    return;
+                }
+            auto s = static_cast<philox4x32_state *>(r->state);
+            std::size_t i = 0;
+            for (; i < n; i += 2)
+                {
+                    // Uniforms on the open interval (0,1)
+                    const double u1 = (double(next(s)) + 0.5) / 4294967296.0;
+                    const double u2 = (double(next(s)) + 0.5) / 4294967296.0;
+                    const double rad = sigma * std::sqrt(-2.0 * std::log(u1));
+                    out[i] = rad * std::cos(2.0 * M_PI * u2);
+                    if (i + 1 < n)
+                        out[i + 1] = rad * std::sin(2.0 * M_PI * u2);
+                }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*!
+  \file plink.hpp
+
+  \brief Genotypes in PLINK binary (.bed/.bim/.fam) format.
+
+  The .bed file is SNP-major: after a 3-byte header, each variant occupies
+  ceil(N/4) bytes, with individual i in bits 2*(i%4) and 2*(i%4)+1 of byte
+  i/4.  The derived allele is A1, so the 2-bit codes are 0 (two derived
+  copies), 2 (heterozygote) and 3 (no derived copies).  Code 1 (missing)
+  is never written.
+
+  Because rows 2i and 2i+1 of a fwdpy::packed_haplotype_matrix are the two
+  haplotypes of individual i, each byte of a column maps to one byte of
+  .bed output via a 256-entry table.
+*/
+#ifndef FWDPY_PLINK_HPP
+#define FWDPY_PLINK_HPP
+
+#include "packed_haplotype_matrix.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fwdpy
+{
+    namespace plink
+    {
+        constexpr unsigned char homozygous_derived = 0;
+        constexpr unsigned char heterozygous = 2;
+        constexpr unsigned char homozygous_ancestral = 3;
+
+        inline unsigned char
+        genotype_code(const unsigned nderived)
+        //! \return The 2-bit .bed code for 0, 1 or 2 derived alleles
+        {
+            if (nderived > 2)
+                throw std::invalid_argument(
+                    "genotypes must be 0, 1, or 2 copies of the derived "
+                    "allele");
+            return (nderived == 0) ? homozygous_ancestral
+                                   : ((nderived == 1) ? heterozygous
+                                                      : homozygous_derived);
+        }
+
+        inline const std::array<unsigned char, 256> &
+        haplotype_byte_table()
+        /*!
+          Maps 8 haplotype bits (4 individuals, two bits each) to one byte
+          of .bed output.
+        */
+        {
+            static const std::array<unsigned char, 256> table = []() {
+                std::array<unsigned char, 256> t;
+                for (unsigned h = 0; h < 256; ++h)
+                    {
+                        unsigned char b = 0;
+                        for (unsigned i = 0; i < 4; ++i)
+                            {
+                                const unsigned n = ((h >> (2 * i)) & 1u)
+                                                   + ((h >> (2 * i + 1)) & 1u);
+                                b |= static_cast<unsigned char>(
+                                    genotype_code(n) << (2 * i));
+                            }
+                        t[h] = b;
+                    }
+                return t;
+            }();
+            return table;
+        }
+
+        inline std::size_t
+        bytes_per_variant(const std::size_t nind)
+        {
+            return (nind + 3) / 4;
+        }
+
+        inline unsigned char
+        last_byte_mask(const std::size_t nind)
+        //! PLINK expects the unused bits of the last byte to be zero
+        {
+            return (nind % 4) ? static_cast<unsigned char>(
+                                    (1u << (2 * (nind % 4))) - 1)
+                              : static_cast<unsigned char>(0xff);
+        }
+
+        inline void
+        open(std::ofstream &o, const std::string &filename)
+        {
+            o.open(filename.c_str(), std::ios_base::out | std::ios_base::binary
+                                         | std::ios_base::trunc);
+            if (!o)
+                throw std::runtime_error("could not open " + filename
+                                         + " for writing");
+        }
+
+        inline void
+        close(std::ofstream &o, const std::string &filename)
+        {
+            o.close();
+            if (o.fail())
+                throw std::runtime_error("error writing to " + filename);
+        }
+
+        inline void
+        write_bed_header(std::ostream &o)
+        {
+            const char magic[3] = { 0x6c, 0x1b, 0x01 };
+            o.write(magic, 3);
+        }
+
+        inline void
+        write_fam(const std::string &filename, const std::vector<double> &G,
+                  const std::vector<double> &E)
+        /*!
+          One line per individual: family and individual IDs are both the
+          1-based row number, parents and sex are unknown, and the phenotype
+          is G+E.  If E is empty, the phenotype is G.
+        */
+        {
+            std::ofstream o;
+            open(o, filename);
+            o.precision(std::numeric_limits<double>::max_digits10);
+            for (std::size_t i = 0; i < G.size(); ++i)
+                {
+                    o << (i + 1) << ' ' << (i + 1) << " 0 0 0 "
+                      << (E.empty() ? G[i] : G[i] + E[i]) << '\n';
+                }
+            close(o, filename);
+        }
+
+        inline void
+        write_bim_line(std::ostream &o, const std::string &id,
+                       const std::size_t bp)
+        /*!
+          All variants are on chromosome 1, at genetic position 0.
+          A1 is the derived allele, coded 'D', and A2 is 'A'.
+        */
+        {
+            o << "1\t" << id << "\t0\t" << bp << "\tD\tA\n";
+        }
+
+        inline std::size_t
+        write_plink(const packed_haplotype_matrix &hm, const std::string &stub)
+        /*!
+          Write stub.bed, stub.bim and stub.fam.  Neutral and selected
+          variants are merged in order of position.  Variant IDs are
+          positions, printed to full precision.  fwdpy positions are not
+          integers, so the base-pair coordinate is the variant's 1-based
+          rank.
+
+          \return The number of variants written
+        */
+        {
+            if (hm.nrow % 2)
+                throw std::invalid_argument(
+                    "haplotype matrix must contain diploids");
+            const std::size_t nind = hm.nrow / 2;
+            const std::size_t nbytes = bytes_per_variant(nind);
+            const unsigned char mask = last_byte_mask(nind);
+            const auto &table = haplotype_byte_table();
+
+            const std::string bedname = stub + ".bed",
+                              bimname = stub + ".bim";
+            std::ofstream bed, bim;
+            open(bed, bedname);
+            open(bim, bimname);
+            bim.precision(std::numeric_limits<double>::max_digits10);
+            write_bed_header(bed);
+
+            std::vector<char> buffer(nbytes);
+            std::size_t i = 0, j = 0, nvariants = 0;
+            while (i < hm.ncol_n || j < hm.ncol_s)
+                {
+                    const bool neutral
+                        = (j == hm.ncol_s)
+                          || (i < hm.ncol_n && hm.np[i] <= hm.sp[j]);
+                    const auto *col
+                        = neutral ? hm.n.data() + i * hm.words_per_column
+                                  : hm.s.data() + j * hm.words_per_column;
+                    const double pos = neutral ? hm.np[i++] : hm.sp[j++];
+                    for (std::size_t b = 0; b < nbytes; ++b)
+                        {
+                            buffer[b] = static_cast<char>(
+                                table[(col[b / 8] >> (8 * (b % 8))) & 0xff]);
+                        }
+                    if (nbytes)
+                        buffer.back() = static_cast<char>(
+                            static_cast<unsigned char>(buffer.back()) & mask);
+                    bed.write(buffer.data(),
+                              static_cast<std::streamsize>(nbytes));
+                    std::ostringstream id;
+                    id.precision(std::numeric_limits<double>::max_digits10);
+                    id << pos;
+                    write_bim_line(bim, id.str(), ++nvariants);
+                }
+            close(bed, bedname);
+            close(bim, bimname);
+            write_fam(stub + ".fam", hm.G, hm.E);
+            return nvariants;
+        }
+
+        template <typename pop_t>
+        std::size_t
+        write_plink(const pop_t *pop, const std::string &stub)
+        /*!
+          Write all individuals in pop.  Variants fixed in the population
+          are skipped.  For a multi-locus population, each individual's
+          genotype is over all loci.
+        */
+        {
+            std::vector<std::size_t> individuals(pop->diploids.size());
+            for (std::size_t i = 0; i < individuals.size(); ++i)
+                individuals[i] = i;
+            return write_plink(make_packed_haplotype_matrix(pop, individuals),
+                               stub);
+        }
+    }
+}
+
+#endif
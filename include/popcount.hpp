@@ -0,0 +1,74 @@
+/*!
+  \file popcount.hpp
+
+  \brief Population counts over arrays of 64-bit words.
+
+  If the compiler targets AVX2 (e.g., CFLAGS=-march=native), 256 bits are
+  processed at a time using the nibble look-up method of Mula et al.
+  (2018, "Faster population counts using AVX2 instructions").  Otherwise,
+  the compiler's popcount builtin is used one word at a time.
+*/
+#ifndef FWDPY_POPCOUNT_HPP
+#define FWDPY_POPCOUNT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace fwdpy
+{
+    inline std::uint64_t
+    popcount(const std::uint64_t *a, const std::size_t nwords) noexcept
+    //! \return The number of bits set in a[0] to a[nwords-1]
+    {
+        std::uint64_t rv = 0;
+        for (std::size_t i = 0; i < nwords; ++i)
+            rv += std::uint64_t(__builtin_popcountll(a[i]));
+        return rv;
+    }
+
+    inline std::uint64_t
+    popcount_and(const std::uint64_t *a, const std::uint64_t *b,
+                 const std::size_t nwords) noexcept
+    //! \return The number of bits set in both a and b
+    {
+        std::uint64_t rv = 0;
+        std::size_t i = 0;
+#ifdef __AVX2__
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2,
+            2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 4 <= nwords; i += 4)
+            {
+                const __m256i v = _mm256_and_si256(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i *>(a + i)),
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i *>(b + i)));
+                const __m256i lo = _mm256_and_si256(v, low_mask);
+                const __m256i hi
+                    = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+                const __m256i counts
+                    = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                      _mm256_shuffle_epi8(lookup, hi));
+                // Horizontal byte sums into 4 64-bit lanes.  Each lane
+                // gets at most 8*8 = 64 per iteration, so no overflow.
+                acc = _mm256_add_epi64(
+                    acc, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+            }
+        rv += std::uint64_t(_mm256_extract_epi64(acc, 0))
+              + std::uint64_t(_mm256_extract_epi64(acc, 1))
+              + std::uint64_t(_mm256_extract_epi64(acc, 2))
+              + std::uint64_t(_mm256_extract_epi64(acc, 3));
+#endif
+        for (; i < nwords; ++i)
+            rv += std::uint64_t(__builtin_popcountll(a[i] & b[i]));
+        return rv;
+    }
+}
+
+#endif
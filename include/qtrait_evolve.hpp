@@ -2,11 +2,17 @@
 #ifndef FWDP_QTRAIT_EVOLVE_QTRAIT_SAMPLER_HPP
 #define FWDP_QTRAIT_EVOLVE_QTRAIT_SAMPLER_HPP
 
+#include "event_timeline.hpp"
 #include "fwdpp_features.hpp"
 #include "fwdpy_fitness.hpp"
+#include "gamete_dedup.hpp"
+#include "generation_profiler.hpp"
 #include "internal_region_manager.hpp"
+#include "qtrait_evolve_rules.hpp"
 #include "reserve.hpp"
+#include "sample_diploid_parallel.hpp"
 #include "sampler_base.hpp"
+#include "stop_condition.hpp"
 #include "types.hpp"
 #include <algorithm>
 #include <future>
@@ -20,6 +26,57 @@ namespace fwdpy
 {
     namespace qtrait
     {
+        //! True if rules_t can apply optimum, VS, and sigmaE events
+        template <typename rules_t>
+        struct supports_trait_events : std::false_type
+        {
+        };
+
+        template <>
+        struct supports_trait_events<qtrait_model_rules> : std::true_type
+        {
+        };
+
+        template <typename rules_t>
+        inline void
+        check_timeline(const event_timeline *timeline)
+        /*!
+          Throw std::runtime_error if timeline has events that rules_t
+          cannot apply.  Called before replicates' threads are started.
+        */
+        {
+            if (!supports_trait_events<rules_t>::value && timeline != nullptr
+                && timeline->has_trait_events())
+                throw std::runtime_error(
+                    "trait parameter events are not supported by this model");
+        }
+
+        template <typename rules_t>
+        inline void
+        apply_trait_event(rules_t &, const timeline_event &)
+        // Not reached: check_timeline rejects these timelines.
+        {
+        }
+
+        inline void
+        apply_trait_event(qtrait_model_rules &rules, const timeline_event &e)
+        {
+            switch (e.type)
+                {
+                case timeline_event_type::optimum:
+                    rules.set_optimum(e.value);
+                    break;
+                case timeline_event_type::VS:
+                    rules.set_VS(e.value);
+                    break;
+                case timeline_event_type::sigmaE:
+                    rules.set_sigE(e.value);
+                    break;
+                default:
+                    break;
+                }
+        }
+
         template <typename rules_t>
         void
         evolve_regions_qtrait_sampler_cpp_details(
@@ -30,54 +87,122 @@ namespace fwdpy
             const double VS, std::unique_ptr<singlepop_fitness> &fitness,
             const int interval, KTfwd::extensions::discrete_mut_model &&__m,
             KTfwd::extensions::discrete_rec_model &&__recmap, sampler_base &s,
-            rules_t &&rules)
+            rules_t &&rules, const unsigned nthreads = 1,
+            const unsigned long stream_seed = 0,
+            const unsigned replicate = 0,
+            const event_timeline *timeline = nullptr,
+            stop_condition *stop = nullptr)
         /*
           \note the gist of this implementation is from
           fwdpy/fwdpy/evolve_regions_sampler.cc
+
+          When nthreads > 1, offspring are generated by
+          fwdpy::parallel_sample_diploid instead of by fwdpp, using the
+          Philox streams for (stream_seed, replicate).  Replicates of one
+          call should share stream_seed and differ in replicate.
+
+          Events in timeline are applied at the start of each generation,
+          before sampling.  Evolution stops early if stop is met.
         */
         {
             gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
             gsl_rng_set(rng, seed);
             const unsigned simlen = unsigned(Nvector_len);
-            const double mu_tot = neutral + selected;
+            timeline_parameters params(neutral, selected, recrate, f,
+                                       interval);
+            timeline_cursor events(timeline);
             auto x = std::max_element(Nvector, Nvector + Nvector_len);
             assert(x != Nvector + Nvector_len);
-            reserve_space(pop->gametes, pop->mutations, *x, mu_tot);
+            reserve_space(pop->gametes, pop->mutations, *x, params.mu_tot());
             KTfwd::extensions::discrete_mut_model m(std::move(__m));
             KTfwd::extensions::discrete_rec_model recmap(std::move(__recmap));
             rules_t model_rules(std::forward<rules_t>(rules));
-            const auto recpos = KTfwd::extensions::bind_drm(
-                recmap, pop->gametes, pop->mutations, rng, recrate);
+            generation_profiler profiler(pop->profile);
+            auto recpos
+                = profiler.wrap_recombination(KTfwd::extensions::bind_drm(
+                    recmap, pop->gametes, pop->mutations, rng, recrate));
+            const auto ff = profiler.wrap_fitness(fitness->fitness_function);
+            std::unique_ptr<parallel_sample_diploid> psd(
+                (nthreads > 1) ? new parallel_sample_diploid(
+                                     nthreads, stream_seed, replicate)
+                               : nullptr);
             // fitness->update(pop);
+            if (stop != nullptr)
+                stop->reset();
             for (unsigned g = 0; g < simlen; ++g, ++pop->generation)
                 {
-                    const unsigned nextN = *(Nvector + g);
-                    if (interval && pop->generation
-                        && pop->generation % interval == 0.)
+                    if (stop != nullptr && stop->check(pop))
+                        break;
+                    events.apply(pop->generation,
+                                 [&params, &model_rules](
+                                     const timeline_event &e) {
+                                     if (!params.apply(e))
+                                         apply_trait_event(model_rules, e);
+                                 });
+                    if (params.recrate_changed)
+                        {
+                            recpos = profiler.wrap_recombination(
+                                KTfwd::extensions::bind_drm(
+                                    recmap, pop->gametes, pop->mutations, rng,
+                                    params.recrate));
+                            params.recrate_changed = false;
+                        }
+                    const unsigned nextN = params.nextN(*(Nvector + g));
+                    if (params.interval && pop->generation
+                        && pop->generation % params.interval == 0.)
                         {
+                            profiler.start();
                             s(pop, pop->generation);
+                            profiler.stop(generation_phase::sampler);
+                        }
+                    profiler.before_generation(*pop);
+                    profiler.start();
+                    if (psd)
+                        {
+                            (*psd)(*pop, nextN, params.mu_tot(), m, recmap,
+                                   params.neutral, params.selected,
+                                   params.recrate, ff, params.f, model_rules);
+                            profiler.add_crossovers(psd->crossovers());
                         }
-                    KTfwd::experimental::sample_diploid(
-                        rng, pop->gametes, pop->diploids, pop->mutations,
-                        pop->mcounts, pop->N, nextN, mu_tot,
-                        KTfwd::extensions::bind_dmm(
-                            m, pop->mutations, pop->mut_lookup, rng, neutral,
-                            selected, pop->generation),
-                        recpos, fitness->fitness_function, pop->neutral,
-                        pop->selected, f, model_rules,
-                        KTfwd::remove_neutral());
+                    else
+                        {
+                            KTfwd::experimental::sample_diploid(
+                                rng, pop->gametes, pop->diploids,
+                                pop->mutations, pop->mcounts, pop->N, nextN,
+                                params.mu_tot(),
+                                KTfwd::extensions::bind_dmm(
+                                    m, pop->mutations, pop->mut_lookup, rng,
+                                    params.neutral, params.selected,
+                                    pop->generation),
+                                recpos, ff, pop->neutral, pop->selected,
+                                params.f,
+                                model_rules, KTfwd::remove_neutral());
+                        }
+                    profiler.stop(generation_phase::sample_diploid);
+                    profiler.after_generation(*pop);
+                    profiler.start();
                     fwdpy::update_mutations_n(pop->mutations, pop->fixations,
                                               pop->fixation_times,
                                               pop->mut_lookup, pop->mcounts,
                                               pop->generation, 2 * nextN);
+                    profiler.stop(generation_phase::update_mutations);
+                    if (params.dedup_due(pop->generation + 1))
+                        {
+                            const auto d = dedup_gametes(*pop);
+                            pop->profile.add_dedup(d.before, d.after);
+                        }
                     assert(KTfwd::check_sum(pop->gametes, 2 * nextN));
                     pop->N = nextN;
                     // fitness->update(pop);
                 }
-            if (interval && pop->generation
-                && pop->generation % interval == 0.)
+            if (stop != nullptr && !stop->stopped())
+                stop->check(pop);
+            if (params.interval && pop->generation
+                && pop->generation % params.interval == 0.)
                 {
+                    profiler.start();
                     s(pop, pop->generation);
+                    profiler.stop(generation_phase::sampler);
                 }
             gsl_rng_free(rng);
             // Allow a sampler to clean up after itself
@@ -92,7 +217,9 @@ namespace fwdpy
             const double f, const double sigmaE, const double optimum,
             const double VS, const int interval,
             const internal::region_manager *rm,
-            const singlepop_fitness &fitness);
+            const singlepop_fitness &fitness, const unsigned nthreads = 1,
+            const event_timeline *timeline = nullptr,
+            std::vector<std::unique_ptr<stop_condition>> *stops = nullptr);
     }
 }
 
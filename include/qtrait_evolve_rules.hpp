@@ -23,7 +23,7 @@ namespace fwdpy
         struct qtrait_model_rules : public fwdpy::single_region_rules_base
         {
             using base_t = fwdpy::single_region_rules_base;
-            const double sigE, optimum, VS;
+            double sigE, optimum, VS;
             qtrait_model_rules(const double &sigE_, const double &optimum_,
                                const double &VS_,
                                const unsigned maxN_ = 100000,
@@ -47,6 +47,29 @@ namespace fwdpy
             {
             }
 
+            void
+            set_optimum(const double optimum_)
+            {
+                optimum = optimum_;
+            }
+
+            void
+            set_VS(const double VS_)
+            {
+                if (VS_ <= 0.)
+                    throw std::runtime_error("VS must be > 0.");
+                VS = VS_;
+            }
+
+            void
+            set_sigE(const double sigE_)
+            {
+                if (sigE_ < 0.)
+                    throw std::runtime_error(
+                        "Environmental noise term must be >= 0.");
+                sigE = sigE_;
+            }
+
             virtual void
             w(const dipvector_t &diploids, gcont_t &gametes,
               const mcont_t &mutations)
@@ -74,9 +97,30 @@ namespace fwdpy
                    const diploid_t &, const gcont_t &gametes,
                    const mcont_t &mutations,
                    const single_region_fitness_fxn &ff) noexcept
+            {
+                update_from_noise(gsl_ran_gaussian_ziggurat(r, sigE), offspring,
+                                  gametes, mutations, ff);
+            }
+
+            //! \brief Standard deviation of the random component of trait
+            //! value
+            double
+            noise_sd() const noexcept
+            {
+                return sigE;
+            }
+
+            //! \brief Same as update, but with the random component of trait
+            //! value supplied by the caller.  Allows those deviates to be
+            //! generated in bulk.
+            void
+            update_from_noise(const double noise, diploid_t &offspring,
+                              const gcont_t &gametes, const mcont_t &mutations,
+                              const single_region_fitness_fxn &ff) const
+                noexcept
             {
                 offspring.g = ff(offspring, gametes, mutations);
-                offspring.e = gsl_ran_gaussian_ziggurat(r, sigE);
+                offspring.e = noise;
                 double dev = (offspring.g + offspring.e - optimum);
                 offspring.w = std::exp(-(dev * dev) / (2. * VS));
                 assert(std::isfinite(offspring.w));
@@ -40,6 +40,39 @@ namespace fwdpy
         std::vector<double>
         ew2010_traits_cpp(const fwdpy::singlepop_t *pop,
                           const std::map<double, ew_mut_details> &effects);
+
+        struct ew_effects
+        /*!
+          Effects of EW2010 model, indexed by mutation key.  Elements for
+          neutral or extinct mutations are NaN.
+        */
+        {
+            std::vector<double> s, e, p;
+        };
+
+        ew_effects ew2010_assign_effects_dense(GSLrng_t *rng,
+                                               const fwdpy::singlepop_t *pop,
+                                               const double tau,
+                                               const double sigma);
+        std::vector<double>
+        ew2010_traits_dense(const fwdpy::singlepop_t *pop,
+                            const ew_effects &effects, const unsigned nthreads);
+
+        struct ew_grid
+        /*!
+          EW2010 traits for K combinations of (tau, sigma).  Summaries
+          have one element per combination.  traits is N x K, row-major,
+          and is empty unless requested.
+        */
+        {
+            std::vector<double> tau, sigma, mean, variance, corr_w, traits;
+        };
+
+        ew_grid ew2010_traits_grid(GSLrng_t *rng, const fwdpy::singlepop_t *pop,
+                                   const std::vector<double> &tau,
+                                   const std::vector<double> &sigma,
+                                   const bool keep_traits,
+                                   const unsigned nthreads);
     }
 }
 
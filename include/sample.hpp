@@ -5,7 +5,12 @@
 #ifndef __FWDPY_SAMPLE_HPP__
 #define __FWDPY_SAMPLE_HPP__
 
+#include "packed_sample.hpp"
 #include "types.hpp"
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace fwdpy
 {
@@ -40,12 +45,11 @@ namespace fwdpy
 
     inline std::pair<singlepop_t::mcont_t::const_iterator, bool>
     find_variant(const singlepop_t::mcont_t &mutations,
-                 const singlepop_t::mcont_t &fixations,
-                 const std::pair<double, std::string> &site)
+                 const singlepop_t::mcont_t &fixations, const double pos)
     {
         auto mitr = std::find_if(fixations.begin(), fixations.end(),
-                                 [&site](const singlepop_t::mutation_t &m) {
-                                     return site.first == m.pos;
+                                 [pos](const singlepop_t::mutation_t &m) {
+                                     return pos == m.pos;
                                  });
         if (mitr != fixations.end())
             {
@@ -53,55 +57,118 @@ namespace fwdpy
             }
 
         mitr = std::find_if(mutations.begin(), mutations.end(),
-                            [&site](const singlepop_t::mutation_t &m) {
-                                return site.first == m.pos;
+                            [pos](const singlepop_t::mutation_t &m) {
+                                return pos == m.pos;
                             });
         if (mitr == mutations.end()) // BAD
             {
                 throw std::runtime_error("Variant at position "
-                                         + std::to_string(site.first)
+                                         + std::to_string(pos)
                                          + " could not be found");
             }
         return std::make_pair(mitr, false);
     }
 
+    inline std::pair<singlepop_t::mcont_t::const_iterator, bool>
+    find_variant(const singlepop_t::mcont_t &mutations,
+                 const singlepop_t::mcont_t &fixations,
+                 const std::pair<double, std::string> &site)
+    {
+        return find_variant(mutations, fixations, site.first);
+    }
+
+    class variant_index
+    /*!
+      Position -> index look-up for mutations and fixations.
+
+      find_variant is a linear search, so getting details for a sample is
+      O(sites * mutations).  Building this index is linear in the number of
+      mutations, after which each look-up is O(1).  Like find_variant,
+      fixations take precedence over mutations, and the first element at a
+      given position is used.
+    */
+    {
+      private:
+        std::unordered_map<double, std::size_t> fixed, segregating;
+
+        static void
+        build(const singlepop_t::mcont_t &m,
+              std::unordered_map<double, std::size_t> &index)
+        {
+            index.reserve(m.size());
+            for (std::size_t i = 0; i < m.size(); ++i)
+                index.emplace(m[i].pos, i);
+        }
+
+      public:
+        variant_index() : fixed{}, segregating{} {}
+        variant_index(const singlepop_t::mcont_t &mutations,
+                      const singlepop_t::mcont_t &fixations)
+            : fixed{}, segregating{}
+        {
+            build(fixations, fixed);
+            build(mutations, segregating);
+        }
+
+        std::pair<std::size_t, bool>
+        find(const double pos) const
+        /*!
+          \return The index of the variant at pos, and true if that is an
+          index into fixations, false if it is an index into mutations.
+        */
+        {
+            auto i = fixed.find(pos);
+            if (i != fixed.end())
+                return std::make_pair(i->second, true);
+            i = segregating.find(pos);
+            if (i == segregating.end())
+                {
+                    throw std::runtime_error("Variant at position "
+                                             + std::to_string(pos)
+                                             + " could not be found");
+                }
+            return std::make_pair(i->second, false);
+        }
+    };
+
     inline popsample_details
-    get_sh_details(const std::vector<std::pair<double, std::string>> &sample,
+    get_sh_details(const std::vector<double> &positions,
+                   std::vector<unsigned> &&dcount, const variant_index &index,
                    const singlepop_t::mcont_t &mutations,
                    const std::vector<KTfwd::popgenmut> &fixations,
                    const std::vector<KTfwd::uint_t> &fixation_times,
                    const singlepop_t::mcount_t &mcounts, const size_t &twoN,
                    const unsigned &gen, const unsigned &locus_num)
+    /*!
+      Details for sites at the given positions, where dcount is the
+      number of derived alleles at each site in the sample.
+    */
     {
         std::vector<double> s, h, p;
-        std::vector<unsigned> dcount, origin, generation, ftime, locus;
+        std::vector<unsigned> origin, generation, ftime, locus;
         std::vector<std::uint16_t> label;
-        for (const auto &site : sample)
+        for (const auto pos : positions)
             {
-                auto x = find_variant(mutations, fixations, site);
-                s.push_back(x.first->s);
-                h.push_back(x.first->h);
-                origin.push_back(x.first->g);
+                const auto x = index.find(pos);
+                const auto &m
+                    = x.second ? fixations[x.first] : mutations[x.first];
+                s.push_back(m.s);
+                h.push_back(m.h);
+                origin.push_back(m.g);
                 if (x.second)
                     {
                         p.push_back(1.0);
-                        std::size_t idx = static_cast<std::size_t>(
-                            std::distance(fixations.begin(), x.first));
-                        ftime.push_back(fixation_times[idx] - fixations[idx].g
-                                        + 1);
+                        ftime.push_back(fixation_times[x.first] - m.g + 1);
                     }
                 else
                     {
-                        p.push_back(double(mcounts[std::distance(
-                                        mutations.begin(), x.first)])
+                        p.push_back(double(mcounts[x.first])
                                     / (2.0 * double(twoN)));
                         ftime.push_back(std::numeric_limits<unsigned>::max());
                     }
 
-                dcount.push_back( // count of derived allele in sample
-                    std::count(site.second.begin(), site.second.end(), '1'));
                 label.push_back(
-                    x.first->xtra); // This is the 'label' assigned to a
+                    m.xtra); // This is the 'label' assigned to a
                                     // mutation -- See Regions.pyx for
                                     // details.
             }
@@ -129,6 +196,54 @@ namespace fwdpy
                                  std::move(generation), std::move(ftime),
                                  std::move(locus), std::move(label));
     }
+
+    inline popsample_details
+    get_sh_details(const std::vector<std::pair<double, std::string>> &sample,
+                   const variant_index &index,
+                   const singlepop_t::mcont_t &mutations,
+                   const std::vector<KTfwd::popgenmut> &fixations,
+                   const std::vector<KTfwd::uint_t> &fixation_times,
+                   const singlepop_t::mcount_t &mcounts, const size_t &twoN,
+                   const unsigned &gen, const unsigned &locus_num)
+    {
+        std::vector<double> positions;
+        std::vector<unsigned> dcount;
+        for (const auto &site : sample)
+            {
+                positions.push_back(site.first);
+                dcount.push_back( // count of derived allele in sample
+                    std::count(site.second.begin(), site.second.end(), '1'));
+            }
+        return get_sh_details(positions, std::move(dcount), index, mutations,
+                              fixations, fixation_times, mcounts, twoN, gen,
+                              locus_num);
+    }
+
+    inline popsample_details
+    get_sh_details(const std::vector<std::pair<double, std::string>> &sample,
+                   const singlepop_t::mcont_t &mutations,
+                   const std::vector<KTfwd::popgenmut> &fixations,
+                   const std::vector<KTfwd::uint_t> &fixation_times,
+                   const singlepop_t::mcount_t &mcounts, const size_t &twoN,
+                   const unsigned &gen, const unsigned &locus_num)
+    {
+        return get_sh_details(sample, variant_index(mutations, fixations),
+                              mutations, fixations, fixation_times, mcounts,
+                              twoN, gen, locus_num);
+    }
+
+    inline popsample_details
+    get_sh_details(const packed_sample &sample, const variant_index &index,
+                   const singlepop_t::mcont_t &mutations,
+                   const std::vector<KTfwd::popgenmut> &fixations,
+                   const std::vector<KTfwd::uint_t> &fixation_times,
+                   const singlepop_t::mcount_t &mcounts, const size_t &twoN,
+                   const unsigned &gen, const unsigned &locus_num)
+    {
+        return get_sh_details(sample.pos, sample.derived_counts(), index,
+                              mutations, fixations, fixation_times, mcounts,
+                              twoN, gen, locus_num);
+    }
     /*!
       \brief Get detailed info about mutations in a sample.
       \note Definition in fwdpy/fwdpy/sample.cc
@@ -0,0 +1,474 @@
+/*!
+  \file sample_diploid_parallel.hpp
+
+  \brief Generate the offspring of a single population using several threads.
+
+  KTfwd::experimental::sample_diploid generates offspring one at a time, which
+  becomes the bottleneck when a single replicate has N on the order of 10^6.
+
+  The type defined here splits the offspring into blocks of fixed size.  A
+  generation proceeds in three phases:
+
+  1. In parallel, each block picks parents, generates crossover positions,
+  recombines the parental key lists, and creates new mutations.  All output is
+  stored in block-local containers.
+  2. Serially and in block order, new mutations are moved into the population
+  and new gametes are created, recycling extinct slots when possible.
+  3. In parallel, rules_t::update is applied to each offspring.
+
+  Random numbers come from counter-based (Philox) streams.  Offspring i of
+  generation g uses the stream (seed, replicate, g, 2i) during phase 1 and
+  (seed, replicate, g, 2i + 1) during phase 3.  Thus, the output depends only
+  on the seed, and not on the number of threads or on how offspring are
+  assigned to blocks.  The exception is "rules" types for which
+  fwdpy::meta::has_batched_noise is true: their Gaussian deviates are drawn in
+  bulk, one stream per block.  The block size is a compile-time constant, so
+  the output still does not depend on the number of threads.
+
+  \note rules_t::update is called concurrently for different offspring,
+  and must therefore not modify the rules object.  This is true for
+  fwdpy::qtrait::qtrait_model_rules, but not for fwdpy::wf_rules.
+*/
+#ifndef FWDPY_SAMPLE_DIPLOID_PARALLEL_HPP
+#define FWDPY_SAMPLE_DIPLOID_PARALLEL_HPP
+
+#include "fwdpy_fitness.hpp"
+#include "gsl_rng_ptr.hpp"
+#include "metaprogramming.hpp"
+#include "philox_rng.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fwdpp/diploid.hh>
+#include <fwdpp/extensions/regions.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fwdpy
+{
+    template <typename key_list_t>
+    inline void
+    recombine_keys(const std::vector<double> &breakpoints,
+                   const key_list_t &k1, const key_list_t &k2,
+                   const mcont_t &mutations, key_list_t &output)
+    /*!
+      Append the recombinant of k1 and k2 to output.  The logic is the same
+      as fwdpp's, but the result is written to a caller-supplied buffer
+      rather than to the gamete container, which makes it safe to call
+      concurrently.
+    */
+    {
+        auto beg1 = k1.cbegin(), end1 = k1.cend();
+        auto beg2 = k2.cbegin(), end2 = k2.cend();
+        const auto comp = [&mutations](const double v,
+                                       const KTfwd::uint_t k) noexcept {
+            return v < mutations[k].pos;
+        };
+        for (const double b : breakpoints)
+            {
+                auto itr = std::upper_bound(beg1, end1, b, comp);
+                output.insert(output.end(), beg1, itr);
+                beg1 = itr;
+                beg2 = std::upper_bound(beg2, end2, b, comp);
+                std::swap(beg1, beg2);
+                std::swap(end1, end2);
+            }
+    }
+
+    class parallel_sample_diploid
+    /*!
+      Multi-threaded replacement for KTfwd::experimental::sample_diploid
+      for fwdpy::singlepop_t.  An instance holds the per-block buffers,
+      which are re-used from generation to generation.
+    */
+    {
+      public:
+        using key_list_t = gamete_t::mutation_container;
+        using lookup_t = decltype(singlepop_t::mut_lookup);
+        //! Number of offspring per block.
+        static constexpr std::size_t block_size = 1024;
+
+      private:
+        struct staged_gamete
+        {
+            //! Parental gamete.  Used as-is if there is no recombination or
+            //! mutation
+            std::size_t parent;
+            //! Ranges in offspring_block::neutral and ::selected
+            std::size_t nbeg, nend, sbeg, send;
+            //! Range in offspring_block::new_mutations
+            std::size_t mbeg, mend;
+            bool recombinant;
+        };
+
+        struct offspring_block
+        {
+            gsl_rng_ptr_t r;
+            std::vector<std::size_t> p1, p2;
+            std::vector<staged_gamete> staged;
+            key_list_t neutral, selected;
+            //! Indexes of new mutations in offspring_block::mutations
+            std::vector<std::size_t> new_mutations;
+            mcont_t mutations;
+            lookup_t lookup;
+            //! Always empty: new mutations are never recycled locally
+            std::queue<std::size_t> mutation_recycling_bin;
+            //! Gaussian deviates for rules_t::update_from_noise
+            std::vector<double> noise;
+            std::size_t ncrossovers;
+            offspring_block()
+                : r(gsl_rng_alloc(philox::gsl_rng_philox4x32())), p1{}, p2{},
+                  staged{}, neutral{}, selected{}, new_mutations{},
+                  mutations{}, lookup{},
+                  mutation_recycling_bin{}, noise{}, ncrossovers(0)
+            {
+            }
+
+            void
+            clear(const std::size_t expected_mutations)
+            {
+                lookup.clear();
+                lookup.reserve(expected_mutations);
+                p1.clear();
+                p2.clear();
+                staged.clear();
+                neutral.clear();
+                selected.clear();
+                new_mutations.clear();
+                mutations.clear();
+                ncrossovers = 0;
+            }
+        };
+
+        std::vector<std::unique_ptr<offspring_block>> blocks;
+        //! Copy of the parental generation.  Kept as a member so that its
+        //! storage is re-used.
+        dipvector_t parents;
+        //! Maps a block's new mutations to their keys in the population
+        std::vector<std::size_t> global_keys;
+        unsigned nthreads;
+        unsigned long seed;
+        std::uint32_t replicate;
+        std::size_t ncrossovers;
+
+        //! Sub-stream used by the block-wide Gaussian deviates
+        static std::uint32_t
+        block_stream(const std::size_t b) noexcept
+        {
+            return 0x80000000u | std::uint32_t(b);
+        }
+
+        template <typename rules_t>
+        void
+        update_block(offspring_block &block, const std::size_t b,
+                     singlepop_t &pop, const dipvector_t &parents,
+                     const single_region_fitness_fxn &ff, rules_t &rules,
+                     std::false_type)
+        {
+            const std::size_t first = b * block_size;
+            for (std::size_t i = 0; i < block.p1.size(); ++i)
+                {
+                    philox::set_stream(block.r.get(), seed,
+                                       std::uint32_t(2 * (first + i) + 1),
+                                       pop.generation, replicate);
+                    rules.update(block.r.get(), pop.diploids[first + i],
+                                 parents[block.p1[i]], parents[block.p2[i]],
+                                 pop.gametes, pop.mutations, ff);
+                }
+        }
+
+        template <typename rules_t>
+        void
+        update_block(offspring_block &block, const std::size_t b,
+                     singlepop_t &pop, const dipvector_t &,
+                     const single_region_fitness_fxn &ff, rules_t &rules,
+                     std::true_type)
+        {
+            const std::size_t first = b * block_size;
+            block.noise.resize(block.p1.size());
+            philox::set_stream(block.r.get(), seed, block_stream(b),
+                               pop.generation, replicate);
+            philox::gaussian_batch(block.r.get(), rules.noise_sd(),
+                                   block.noise.data(), block.noise.size());
+            for (std::size_t i = 0; i < block.p1.size(); ++i)
+                {
+                    rules.update_from_noise(block.noise[i],
+                                            pop.diploids[first + i],
+                                            pop.gametes, pop.mutations, ff);
+                }
+        }
+
+        template <typename F>
+        void
+        for_each_block(const std::size_t nblocks, const F &f) const
+        {
+            std::vector<std::thread> threads;
+            for (unsigned t = 0; t < nthreads; ++t)
+                {
+                    threads.emplace_back([&f, t, nblocks, this]() {
+                        for (std::size_t b = t; b < nblocks; b += nthreads)
+                            f(b);
+                    });
+                }
+            for (auto &t : threads)
+                t.join();
+        }
+
+        template <typename recpol_t, typename mmodel_t>
+        void
+        stage_gamete(offspring_block &block, const singlepop_t &pop,
+                     std::size_t ga, std::size_t gb, const double mu_tot,
+                     const recpol_t &recpol, const mmodel_t &mmodel)
+        {
+            if (gsl_rng_uniform(block.r.get()) < 0.5)
+                std::swap(ga, gb);
+            staged_gamete sg;
+            sg.parent = ga;
+            sg.recombinant = false;
+            sg.nbeg = block.neutral.size();
+            sg.sbeg = block.selected.size();
+            if (ga != gb)
+                {
+                    auto breakpoints = recpol(pop.gametes[ga], pop.gametes[gb],
+                                              pop.mutations);
+                    if (!breakpoints.empty())
+                        {
+                            // The last breakpoint is a terminating sentinel
+                            block.ncrossovers += breakpoints.size() - 1;
+                            recombine_keys(breakpoints,
+                                           pop.gametes[ga].mutations,
+                                           pop.gametes[gb].mutations,
+                                           pop.mutations, block.neutral);
+                            recombine_keys(breakpoints,
+                                           pop.gametes[ga].smutations,
+                                           pop.gametes[gb].smutations,
+                                           pop.mutations, block.selected);
+                            sg.recombinant = true;
+                        }
+                }
+            sg.nend = block.neutral.size();
+            sg.send = block.selected.size();
+            sg.mbeg = block.new_mutations.size();
+            const unsigned nm
+                = (mu_tot > 0.) ? gsl_ran_poisson(block.r.get(), mu_tot) : 0u;
+            for (unsigned i = 0; i < nm; ++i)
+                {
+                    block.new_mutations.push_back(mmodel(
+                        block.mutation_recycling_bin, block.mutations));
+                }
+            sg.mend = block.new_mutations.size();
+            block.staged.push_back(sg);
+        }
+
+        std::size_t
+        commit_gamete(singlepop_t &pop, const offspring_block &block,
+                      const staged_gamete &sg,
+                      std::queue<std::size_t> &gamete_recycling_bin)
+        {
+            if (!sg.recombinant && sg.mbeg == sg.mend)
+                {
+                    pop.gametes[sg.parent].n++;
+                    return sg.parent;
+                }
+            std::size_t idx;
+            if (!gamete_recycling_bin.empty())
+                {
+                    idx = gamete_recycling_bin.front();
+                    gamete_recycling_bin.pop();
+                }
+            else
+                {
+                    idx = pop.gametes.size();
+                    pop.gametes.emplace_back(0u);
+                }
+            auto &g = pop.gametes[idx];
+            if (sg.recombinant)
+                {
+                    g.mutations.assign(block.neutral.begin() + sg.nbeg,
+                                       block.neutral.begin() + sg.nend);
+                    g.smutations.assign(block.selected.begin() + sg.sbeg,
+                                        block.selected.begin() + sg.send);
+                }
+            else
+                {
+                    g.mutations = pop.gametes[sg.parent].mutations;
+                    g.smutations = pop.gametes[sg.parent].smutations;
+                }
+            for (std::size_t i = sg.mbeg; i < sg.mend; ++i)
+                {
+                    const auto key = global_keys[block.new_mutations[i]];
+                    const double pos = pop.mutations[key].pos;
+                    auto &keys = (pop.mutations[key].neutral) ? g.mutations
+                                                              : g.smutations;
+                    keys.insert(
+                        std::upper_bound(
+                            keys.begin(), keys.end(), pos,
+                            [&pop](const double v,
+                                   const KTfwd::uint_t k) noexcept {
+                                return v < pop.mutations[k].pos;
+                            }),
+                        KTfwd::uint_t(key));
+                }
+            g.n = 1;
+            return idx;
+        }
+
+      public:
+        parallel_sample_diploid(const unsigned nthreads_,
+                                const unsigned long seed_,
+                                const std::uint32_t replicate_ = 0)
+            : blocks{}, parents{}, global_keys{}, nthreads(nthreads_),
+              seed(seed_),
+              replicate(replicate_), ncrossovers(0)
+        {
+            if (!nthreads)
+                throw std::runtime_error("number of threads must be > 0");
+        }
+
+        //! \return Number of crossovers during the last generation
+        std::size_t
+        crossovers() const noexcept
+        {
+            return ncrossovers;
+        }
+
+        template <typename rules_t>
+        double
+        operator()(singlepop_t &pop, const unsigned NN,
+                   const double mu_tot,
+                   const KTfwd::extensions::discrete_mut_model &m,
+                   const KTfwd::extensions::discrete_rec_model &recmap,
+                   const double neutral, const double selected,
+                   const double recrate, const single_region_fitness_fxn &ff,
+                   const double f, rules_t &rules)
+        /*!
+          Generate NN offspring from pop.diploids, updating pop.gametes,
+          pop.mutations, pop.mut_lookup, and pop.mcounts.  Extinct and
+          fixed neutral mutations are then removed from gametes, as with
+          KTfwd::remove_neutral.
+
+          \return Mean fitness of the parental generation.
+        */
+        {
+            auto gamete_recycling_bin
+                = KTfwd::fwdpp_internal::make_gamete_queue(pop.gametes);
+            auto mutation_recycling_bin
+                = KTfwd::fwdpp_internal::make_mut_queue(pop.mcounts);
+            rules.w(pop.diploids, pop.gametes, pop.mutations);
+            parents.assign(pop.diploids.begin(), pop.diploids.end());
+            pop.diploids.resize(NN);
+
+            const std::size_t nblocks = (NN + block_size - 1) / block_size;
+            while (blocks.size() < nblocks)
+                blocks.emplace_back(new offspring_block());
+            // Expected number of new mutations per block, plus some slack
+            const auto expected_mutations = std::size_t(
+                2.5 * double(block_size) * mu_tot) + 1;
+
+            // Phase 1: parents, recombination, and new mutations
+            for_each_block(nblocks, [&](const std::size_t b) {
+                auto &block = *blocks[b];
+                block.clear(expected_mutations);
+                const auto recpol = KTfwd::extensions::bind_drm(
+                    recmap, pop.gametes, pop.mutations, block.r.get(),
+                    recrate);
+                const auto mmodel = KTfwd::extensions::bind_dmm(
+                    m, block.mutations, block.lookup, block.r.get(), neutral,
+                    selected, pop.generation);
+                const std::size_t first = b * block_size,
+                                  last = std::min(first + block_size,
+                                                  std::size_t(NN));
+                for (std::size_t i = first; i < last; ++i)
+                    {
+                        philox::set_stream(block.r.get(), seed,
+                                           std::uint32_t(2 * i),
+                                           pop.generation, replicate);
+                        const auto p1 = rules.pick1(block.r.get());
+                        const auto p2
+                            = rules.pick2(block.r.get(), p1, f, parents[p1],
+                                          pop.gametes, pop.mutations);
+                        block.p1.push_back(p1);
+                        block.p2.push_back(p2);
+                        stage_gamete(block, pop, parents[p1].first,
+                                     parents[p1].second, mu_tot, recpol,
+                                     mmodel);
+                        stage_gamete(block, pop, parents[p2].first,
+                                     parents[p2].second, mu_tot, recpol,
+                                     mmodel);
+                    }
+            });
+
+            // Phase 2: deterministic merge, in block order
+            ncrossovers = 0;
+            for (std::size_t b = 0; b < nblocks; ++b)
+                {
+                    auto &block = *blocks[b];
+                    ncrossovers += block.ncrossovers;
+                    global_keys.resize(block.mutations.size());
+                    for (std::size_t k = 0; k < block.mutations.size(); ++k)
+                        {
+                            auto &mut = block.mutations[k];
+                            // Another block may have used this position
+                            while (pop.mut_lookup.find(mut.pos)
+                                   != pop.mut_lookup.end())
+                                {
+                                    mut.pos = std::nextafter(
+                                        mut.pos,
+                                        std::numeric_limits<double>::max());
+                                }
+                            pop.mut_lookup.insert(mut.pos);
+                            std::size_t key;
+                            if (!mutation_recycling_bin.empty())
+                                {
+                                    key = mutation_recycling_bin.front();
+                                    mutation_recycling_bin.pop();
+                                    pop.mutations[key] = std::move(mut);
+                                }
+                            else
+                                {
+                                    key = pop.mutations.size();
+                                    pop.mutations.emplace_back(std::move(mut));
+                                }
+                            global_keys[k] = key;
+                        }
+                    const std::size_t first = b * block_size;
+                    for (std::size_t i = 0; i < block.p1.size(); ++i)
+                        {
+                            auto &dip = pop.diploids[first + i];
+                            dip.first
+                                = commit_gamete(pop, block, block.staged[2 * i],
+                                                gamete_recycling_bin);
+                            dip.second = commit_gamete(
+                                pop, block, block.staged[2 * i + 1],
+                                gamete_recycling_bin);
+                        }
+                }
+
+            // Phase 3: offspring properties
+            for_each_block(nblocks, [&](const std::size_t b) {
+                update_block(*blocks[b], b, pop, parents, ff, rules,
+                             typename meta::has_batched_noise<
+                                 typename std::decay<rules_t>::type>::type());
+            });
+
+            KTfwd::fwdpp_internal::process_gametes(pop.gametes, pop.mutations,
+                                                   pop.mcounts);
+            KTfwd::fwdpp_internal::gamete_cleaner(
+                pop.gametes, pop.mutations, pop.mcounts, 2 * NN,
+                KTfwd::remove_neutral(),
+                typename std::is_same<KTfwd::remove_neutral,
+                                      std::true_type>::type());
+            return rules.wbar;
+        }
+    };
+}
+
+#endif
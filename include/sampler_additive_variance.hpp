@@ -17,6 +17,7 @@
 #include <gsl/gsl_statistics_double.h>
 #include "gsl_data_matrix.hpp"
 #include "sampler_base.hpp"
+#include "sampling_pass.hpp"
 #include "types.hpp"
 #include "gsl.hpp"
 #include <algorithm>
@@ -66,6 +67,26 @@ namespace fwdpy
         {
             call_operator_details(pop, generation);
         }
+        virtual bool
+        uses_sampling_pass() const
+        {
+            return true;
+        }
+        virtual void
+        apply_pass(const sampling_pass &p)
+        {
+            auto mut_keys = gsl_data_matrix::get_mut_keys(p, true, true);
+            if (mut_keys.empty())
+                return;
+            Gbuffer.assign(p.g.begin(), p.g.end());
+            regress(std::move(mut_keys), *p.mcounts, p.g.size(),
+                    p.generation,
+                    [&p](const std::vector<KTfwd::uint_t> &keys,
+                         gsl_matrix *genotypes) {
+                        gsl_data_matrix::update_matrix_counts(p, keys,
+                                                              genotypes);
+                    });
+        }
 
         virtual void
         cleanup()
@@ -126,25 +147,43 @@ namespace fwdpy
             // Genetic values for each diploid
             double VG;
             fillG(pop, Gbuffer, &VG);
-            auto Gview = gsl_vector_view_array(Gbuffer.data(), pop->N);
+            regress(std::move(mut_keys), pop->mcounts, pop->N, generation,
+                    [pop](const std::vector<KTfwd::uint_t> &keys,
+                          gsl_matrix *genotypes) {
+                        gsl_data_matrix::update_matrix_counts(pop, keys,
+                                                              genotypes);
+                    });
+        }
+
+        template <typename mcount_t, typename fill_fxn>
+        inline void
+        regress(std::vector<KTfwd::uint_t> mut_keys, const mcount_t &mcounts,
+                const std::size_t N, unsigned generation,
+                const fill_fxn &fill_genotypes)
+        /*!
+          Regress Gbuffer on the genotypes at mut_keys, which fill_genotypes
+          writes to an N x (mut_keys.size()+1) matrix.
+        */
+        {
+            auto Gview = gsl_vector_view_array(Gbuffer.data(), N);
             auto G = &Gview.vector; // this is a gsl_vector *
 
             // Get a vector of the mcounts corresponding to mut_kets
             std::vector<KTfwd::uint_t> mut_key_counts;
             for (const auto i : mut_keys)
-                mut_key_counts.emplace_back(pop->mcounts[i]);
+                mut_key_counts.emplace_back(mcounts[i]);
 
             // Check if we need to reallocate
-            if (std::size_t(pop->N) * (mut_keys.size() + 1) > buffer.size())
+            if (N * (mut_keys.size() + 1) > buffer.size())
                 {
-                    buffer.resize(std::size_t(pop->N) * (mut_keys.size() + 1));
+                    buffer.resize(N * (mut_keys.size() + 1));
                 }
-            std::size_t tda = buffer.size() / pop->N;
+            std::size_t tda = buffer.size() / N;
             auto genotypes_view = gsl_matrix_view_array_with_tda(
-                buffer.data(), pop->N, mut_keys.size() + 1, tda);
+                buffer.data(), N, mut_keys.size() + 1, tda);
             auto genotypes = &genotypes_view.matrix;
             gsl_matrix_set_zero(genotypes);
-			gsl_data_matrix::update_matrix_counts(pop, mut_keys, genotypes);
+            fill_genotypes(mut_keys, genotypes);
             auto ucol_labels
                 = prune_matrix(genotypes, mut_keys, mut_key_counts);
             auto DF = std::count(ucol_labels.begin(), ucol_labels.end(), 1);
@@ -250,8 +289,8 @@ namespace fwdpy
                     //                                            er.second)));
                     //double adj_rsq = 1.0 - a * b;
                     VGcollection.emplace_back(VAcum(
-                        double(uc) / (2.0 * double(pop->diploids.size())), rsq,
-                        generation, pop->diploids.size()));
+                        double(uc) / (2.0 * double(N)), rsq, generation,
+                        unsigned(N)));
                 }
         }
 
@@ -8,6 +8,8 @@
 
 namespace fwdpy
 {
+    struct sampling_pass;
+
     struct sampler_base
     /*!
       Base class for a temporal sampler.
@@ -36,6 +38,22 @@ namespace fwdpy
             throw std::runtime_error(
                 "sampler type not implemented for metapopulation simulations");
         };
+        virtual bool
+        uses_sampling_pass() const
+        /*!
+          Return true if this sampler implements apply_pass.  Such samplers
+          are given a fwdpy::sampling_pass, shared with other samplers, when
+          they are children of a fwdpy::composite_sampler.
+        */
+        {
+            return false;
+        }
+        virtual void
+        apply_pass(const sampling_pass &)
+        {
+            throw std::runtime_error(
+                "sampler type not implemented for shared sampling passes");
+        }
         virtual void
         cleanup()
         /*!
@@ -49,6 +67,16 @@ namespace fwdpy
          */
         {
         }
+        virtual void
+        flush()
+        /*!
+          Called on the calling thread, after the threads that applied this
+          sampler have been joined.  Samplers that complete work in the
+          background report any errors here, rather than throwing from a
+          replicate's thread.
+        */
+        {
+        }
         virtual ~sampler_base() {}
     };
 
@@ -59,6 +87,13 @@ namespace fwdpy
 		v=std::move(t);
 	}
 
+    inline void
+    flush_samplers(const std::vector<std::unique_ptr<sampler_base>> &v)
+    {
+        for (auto &s : v)
+            s->flush();
+    }
+
     template <typename pop_t>
     inline void
     apply_sampler_wrapper(sampler_base *s, const pop_t *pop)
@@ -77,7 +112,8 @@ namespace fwdpy
         const std::vector<std::shared_ptr<T>> &popvec,
         const std::vector<std::unique_ptr<sampler_base>> &samplers)
     /*!
-      Apply the i-th ampler to the i-th pop using std::thread.
+      Apply the i-th ampler to the i-th pop using std::thread, and then
+      flush the samplers.
 
       Throws runtime_error if popvec.size()!=samplers.size().
      */
@@ -93,6 +129,7 @@ namespace fwdpy
             }
         for (auto &t : threads)
             t.join();
+        flush_samplers(samplers);
     }
 
     template <typename final_t> struct custom_sampler : public sampler_base
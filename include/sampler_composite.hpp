@@ -0,0 +1,89 @@
+#ifndef FWDPY_SAMPLER_COMPOSITE_HPP
+#define FWDPY_SAMPLER_COMPOSITE_HPP
+
+#include "sampler_base.hpp"
+#include "sampling_pass.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace fwdpy
+{
+    class composite_sampler : public sampler_base
+    /*!
+      \brief A "sampler" that applies several samplers to the same
+      population.
+      \ingroup samplers
+
+      When any child uses a fwdpy::sampling_pass, the population is
+      traversed once per call and the pass is given to each such child.
+      Other children are called with the population.
+
+      The children are not owned, and must outlive this object.
+    */
+    {
+      public:
+        explicit composite_sampler(std::vector<sampler_base *> children_)
+            : children(std::move(children_)), pass(sampling_pass())
+        {
+        }
+
+        virtual void
+        operator()(const singlepop_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        operator()(const multilocus_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        operator()(const metapop_t *pop, const unsigned generation)
+        {
+            for (auto c : children)
+                c->operator()(pop, generation);
+        }
+
+        virtual void
+        cleanup()
+        {
+            for (auto c : children)
+                c->cleanup();
+            pass = sampling_pass();
+        }
+
+        virtual void
+        flush()
+        {
+            for (auto c : children)
+                c->flush();
+        }
+
+      private:
+        std::vector<sampler_base *> children;
+        sampling_pass pass;
+
+        template <typename pop_t>
+        void
+        call_operator_details(const pop_t *pop, const unsigned generation)
+        {
+            if (std::any_of(children.begin(), children.end(),
+                            [](const sampler_base *c) {
+                                return c->uses_sampling_pass();
+                            }))
+                fill_sampling_pass(pop, generation, pass);
+            for (auto c : children)
+                {
+                    if (c->uses_sampling_pass())
+                        c->apply_pass(pass);
+                    else
+                        c->operator()(pop, generation);
+                }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,222 @@
+/*!
+  \file sampler_ld.hpp
+
+  \brief Linkage disequilibrium as a function of distance.
+
+  Each segregating site is represented by a bitset over the haplotypes of
+  the population, or of a random sample of individuals (see
+  packed_haplotype_matrix.hpp).  Haplotype counts for pairs of sites are
+  obtained by popcount of the bitwise AND of two columns.  Results are
+  averaged within bins of distance between sites, so the output size does
+  not depend on the number of sites.
+*/
+#ifndef FWDPY_SAMPLER_LD_HPP
+#define FWDPY_SAMPLER_LD_HPP
+
+#include "packed_haplotype_matrix.hpp"
+#include "popcount.hpp"
+#include "sampler_base.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gsl/gsl_randist.h>
+#include <stdexcept>
+#include <vector>
+
+namespace fwdpy
+{
+    struct ld_data
+    /*!
+      Columnar output of fwdpy::ld_sampler, with one element per distance
+      bin per sampling time.  Means are over pairs of sites within the bin,
+      and are NaN if npairs == 0.  D is calculated with respect to derived
+      alleles, and Dprime is Lewontin's signed D/Dmax.
+    */
+    {
+        std::vector<unsigned> generation;
+        std::vector<double> bin_left, bin_right;
+        std::vector<unsigned long long> npairs;
+        std::vector<double> mean_D, mean_rsq, mean_Dprime;
+    };
+
+    class ld_sampler : public sampler_base
+    {
+      public:
+        using final_t = ld_data;
+
+      private:
+        struct site
+        {
+            double pos;
+            const packed_haplotype_matrix::word_t *bits;
+            double p;
+            bool selected;
+        };
+
+        final_t rv;
+        GSLrng_t r;
+        //! Edges of distance bins, in increasing order
+        const std::vector<double> edges;
+        //! Number of individuals to sample.  0 means the entire population.
+        const unsigned nind;
+        const double minfreq;
+        const bool selected_focal;
+
+        std::vector<std::size_t>
+        individuals(const std::size_t N)
+        {
+            std::vector<std::size_t> all(N);
+            for (std::size_t i = 0; i < N; ++i)
+                all[i] = i;
+            if (!nind)
+                return all;
+            if (nind > N)
+                throw std::runtime_error(
+                    "sample size larger than population size");
+            std::vector<std::size_t> s(nind);
+            gsl_ran_choose(r.get(), s.data(), nind, all.data(), N,
+                           sizeof(std::size_t));
+            return s;
+        }
+
+        void
+        add_sites(const std::vector<packed_haplotype_matrix::word_t> &bits,
+                  const std::vector<double> &pos,
+                  const std::size_t words_per_column, const double n,
+                  const bool selected, std::vector<site> &sites) const
+        {
+            for (std::size_t c = 0; c < pos.size(); ++c)
+                {
+                    const auto *col = bits.data() + c * words_per_column;
+                    const double p
+                        = double(popcount(col, words_per_column)) / n;
+                    if (p > 0. && p < 1. && std::min(p, 1. - p) >= minfreq)
+                        sites.push_back(site{ pos[c], col, p, selected });
+                }
+        }
+
+        template <typename pop_t>
+        void
+        call_operator_details(const pop_t *pop, const unsigned generation)
+        {
+            const auto hm = make_packed_haplotype_matrix(
+                pop, individuals(pop->diploids.size()));
+            const double n = double(hm.nrow);
+            const auto wpc = hm.words_per_column;
+            std::vector<site> sites;
+            add_sites(hm.n, hm.np, wpc, n, false, sites);
+            add_sites(hm.s, hm.sp, wpc, n, true, sites);
+            std::sort(sites.begin(), sites.end(),
+                      [](const site &a, const site &b) {
+                          return a.pos < b.pos;
+                      });
+
+            const std::size_t nbins = edges.size() - 1;
+            std::vector<unsigned long long> npairs(nbins, 0);
+            std::vector<double> sumD(nbins, 0.), sumrsq(nbins, 0.),
+                sumDprime(nbins, 0.);
+            for (std::size_t i = 0; i < sites.size(); ++i)
+                {
+                    const auto &a = sites[i];
+                    for (std::size_t j = i + 1; j < sites.size(); ++j)
+                        {
+                            const auto &b = sites[j];
+                            const double d = b.pos - a.pos;
+                            // Sites are sorted, so no further pair can be
+                            // in a bin
+                            if (d >= edges.back())
+                                break;
+                            if (d < edges.front())
+                                continue;
+                            if (selected_focal && !a.selected && !b.selected)
+                                continue;
+                            const std::size_t bin
+                                = std::size_t(std::distance(
+                                      edges.begin(),
+                                      std::upper_bound(edges.begin(),
+                                                       edges.end(), d)))
+                                  - 1;
+                            const double pAB
+                                = double(popcount_and(a.bits, b.bits, wpc))
+                                  / n;
+                            const double D = pAB - a.p * b.p;
+                            const double Dmax
+                                = (D < 0.)
+                                      ? std::min(a.p * b.p,
+                                                 (1. - a.p) * (1. - b.p))
+                                      : std::min(a.p * (1. - b.p),
+                                                 (1. - a.p) * b.p);
+                            ++npairs[bin];
+                            sumD[bin] += D;
+                            sumrsq[bin] += D * D
+                                           / (a.p * (1. - a.p) * b.p
+                                              * (1. - b.p));
+                            sumDprime[bin] += (Dmax > 0.) ? D / Dmax : 0.;
+                        }
+                }
+            for (std::size_t bin = 0; bin < nbins; ++bin)
+                {
+                    const double np = double(npairs[bin]);
+                    rv.generation.push_back(generation);
+                    rv.bin_left.push_back(edges[bin]);
+                    rv.bin_right.push_back(edges[bin + 1]);
+                    rv.npairs.push_back(npairs[bin]);
+                    rv.mean_D.push_back(sumD[bin] / np);
+                    rv.mean_rsq.push_back(sumrsq[bin] / np);
+                    rv.mean_Dprime.push_back(sumDprime[bin] / np);
+                }
+        }
+
+      public:
+        virtual void
+        operator()(const singlepop_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        operator()(const multilocus_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        final_t
+        final() const
+        {
+            return rv;
+        }
+
+        explicit ld_sampler(const gsl_rng *r_,
+                            const std::vector<double> &bin_edges,
+                            const unsigned nind_, const double minfreq_,
+                            const bool selected_focal_)
+            : rv(final_t()), r(GSLrng_t(gsl_rng_get(r_))), edges(bin_edges),
+              nind(nind_), minfreq(minfreq_), selected_focal(selected_focal_)
+        /*!
+          \param r_ Used to seed this object's random number generator, as
+          in fwdpy::sample_n.
+          \param bin_edges Edges of the distance bins.  Bin i is
+          [bin_edges[i], bin_edges[i+1]).
+          \param nind_ Number of individuals to sample without replacement.
+          If 0, the entire population is used.
+          \param minfreq_ Sites with minor allele frequency less than this
+          are skipped.
+          \param selected_focal_ If true, only pairs involving at least one
+          selected site are used.
+        */
+        {
+            if (edges.size() < 2)
+                throw std::invalid_argument(
+                    "at least two bin edges are required");
+            if (!std::is_sorted(edges.begin(), edges.end())
+                || std::adjacent_find(edges.begin(), edges.end())
+                       != edges.end())
+                throw std::invalid_argument(
+                    "bin edges must be strictly increasing");
+            if (!(minfreq >= 0. && minfreq < 0.5))
+                throw std::invalid_argument("minfreq must be in [0,0.5)");
+        }
+    };
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef FWDPY_POP_PROPERTIES_HPP
 #define FWDPY_POP_PROPERTIES_HPP
 
+#include "sampling_pass.hpp"
 #include "types.hpp"
 #include <array>
 #include <sampler_base.hpp>
@@ -49,6 +50,33 @@ namespace fwdpy
             call_operator_details(pop, generation);
         }
 
+        virtual bool
+        uses_sampling_pass() const
+        {
+            return true;
+        }
+
+        virtual void
+        apply_pass(const sampling_pass &p)
+        {
+            std::vector<double> VG(p.g), VE(p.e), wbar(p.w), trait, ndel;
+            trait.reserve(p.g.size());
+            ndel.reserve(p.g.size());
+            for (std::size_t i = 0; i < p.g.size(); ++i)
+                {
+                    trait.push_back(p.g[i] + p.e[i]);
+                    ndel.push_back(double(p.offsets[i + 1] - p.offsets[i]));
+                }
+            selected_summary sel;
+            for (const auto k : p.selected)
+                {
+                    if ((*p.mcounts)[k] < p.twoN)
+                        sel.add((*p.mutations)[k].s,
+                                double((*p.mcounts)[k]) / double(p.twoN));
+                }
+            summarize(p.generation, VG, VE, trait, wbar, ndel, sel);
+        }
+
         final_t
         final() const
         /*!
@@ -163,31 +191,55 @@ namespace fwdpy
             fill_vectors(pop, VG, VE, trait, wbar, ndel);
 
             double twoN = 2. * double(pop->diploids.size());
-            double mvexpl = 0.,
-                   leading_e = std::numeric_limits<double>::quiet_NaN(),
-                   leading_f = std::numeric_limits<double>::quiet_NaN();
-            double sum_e = 0.;
-            unsigned nm = 0;
+            selected_summary sel;
             for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
                 {
                     if (pop->mcounts[i] && pop->mcounts[i] < twoN
                         && !pop->mutations[i].neutral)
                         {
-                            auto n = pop->mcounts[i];
-                            double p = double(n) / twoN, q = 1. - p;
-                            double s = pop->mutations[i].s;
-                            double temp = 2. * p * q * std::pow(s, 2.0);
-                            if (temp > mvexpl)
-                                {
-                                    mvexpl = temp;
-                                    leading_e = s;
-                                    leading_f = p;
-                                }
-                            sum_e += pop->mutations[i].s;
-                            ++nm;
+                            sel.add(pop->mutations[i].s,
+                                    double(pop->mcounts[i]) / twoN);
                         }
                 }
+            summarize(generation, VG, VE, trait, wbar, ndel, sel);
+        }
 
+        struct selected_summary
+        /*!
+          Summaries of segregating, selected mutations
+        */
+        {
+            double mvexpl, leading_e, leading_f, sum_e;
+            unsigned nm;
+            selected_summary()
+                : mvexpl(0.),
+                  leading_e(std::numeric_limits<double>::quiet_NaN()),
+                  leading_f(std::numeric_limits<double>::quiet_NaN()),
+                  sum_e(0.), nm(0)
+            {
+            }
+            void
+            add(const double s, const double p)
+            {
+                double q = 1. - p;
+                double temp = 2. * p * q * std::pow(s, 2.0);
+                if (temp > mvexpl)
+                    {
+                        mvexpl = temp;
+                        leading_e = s;
+                        leading_f = p;
+                    }
+                sum_e += s;
+                ++nm;
+            }
+        };
+
+        void
+        summarize(const unsigned generation, std::vector<double> &VG,
+                  std::vector<double> &VE, std::vector<double> &trait,
+                  std::vector<double> &wbar, std::vector<double> &ndel,
+                  const selected_summary &sel)
+        {
             // Calcate V(G) here b/c we're going to mess
             // around with this container below when
             // calculating V_{s,t}
@@ -218,8 +270,8 @@ namespace fwdpy
             double unloaded = std::count(ndel.begin(), ndel.end(), 0.0);
             qstats.emplace_back(qtrait_stats_t::value_type{
                 { double(generation), VG_,
-                  gsl_stats_variance(VE.data(), 1, VE.size()), leading_f,
-                  leading_e, mvexpl, sum_e / double(nm),
+                  gsl_stats_variance(VE.data(), 1, VE.size()), sel.leading_f,
+                  sel.leading_e, sel.mvexpl, sel.sum_e / double(sel.nm),
                   gsl_stats_mean(wbar.data(), 1, wbar.size()),
                   gsl_stats_variance(wbar.data(), 1, wbar.size()), meanTrait,
                   vst, mload, unloaded / double(ndel.size()) } });
@@ -263,22 +315,22 @@ namespace fwdpy
                 VE.push_back(dip[0].e);
                 trait.push_back(dip[0].g + dip[0].e);
                 wbar.push_back(dip[0].w);
-                // Count up # deleterious per locus
+                // Count up # deleterious over all loci
                 unsigned nd = 0;
                 for (auto &&locus : dip)
                     {
                         for (auto &&m : pop->gametes[locus.first].smutations)
                             {
-                                if (pop->mcounts[m] <= 2 * pop->N)
+                                if (pop->mcounts[m] < 2 * pop->N)
                                     nd++;
                             }
                         for (auto &&m : pop->gametes[locus.second].smutations)
                             {
-                                if (pop->mcounts[m] <= 2 * pop->N)
+                                if (pop->mcounts[m] < 2 * pop->N)
                                     nd++;
                             }
-                        ndel.push_back(double(nd));
                     }
+                ndel.push_back(double(nd));
             }
     }
 }
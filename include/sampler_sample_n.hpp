@@ -1,11 +1,15 @@
 #ifndef FWDPY_SAMPLE_N_HPP
 #define FWDPY_SAMPLE_N_HPP
 
+#include "async_gz_writer.hpp"
+#include "packed_sample.hpp"
 #include "sample.hpp"
 #include "sampler_base.hpp"
 #include "types.hpp"
 #include <Sequence/SimData.hpp>
 #include <algorithm>
+#include <cstdint>
+#include <exception>
 #include <fwdpp/diploid.hh>
 #include <fwdpp/sugar/poptypes/tags.hpp>
 #include <fwdpp/sugar/sampling.hpp>
@@ -28,14 +32,27 @@ namespace fwdpy
         using final_t
             = std::shared_ptr<std::vector<std::pair<KTfwd::sep_sample_t,
                                                     popsample_details>>>;
+        using packed_final_t
+            = std::shared_ptr<std::vector<std::pair<packed_sep_sample_t,
+                                                    popsample_details>>>;
 
       private:
         final_t rv;
+        packed_final_t rv_packed;
         const unsigned nsam;
         GSLrng_t r;
         const std::string nfile, sfile;
         const std::vector<std::pair<double, double>> locus_boundaries;
-        const bool removeFixed, recordSamples, recordDetails;
+        const bool removeFixed, recordSamples, recordDetails, packed,
+            binary;
+        //! Output streams, opened on first use and closed by cleanup()
+        std::unique_ptr<async_gz_writer> nwriter, swriter;
+        //! The first error opening or writing an output file.  Sampling
+        //! happens on replicates' threads, so it is rethrown by flush().
+        std::exception_ptr write_error;
+        //! Re-used to format each sample
+        std::ostringstream text_buffer;
+        std::string binary_buffer;
 
         void
         remove_redundant_selected_fixations(KTfwd::sep_sample_t &sample)
@@ -54,64 +71,176 @@ namespace fwdpy
                 sample.second.end());
         }
 
+        async_gz_writer &
+        writer(std::unique_ptr<async_gz_writer> &w, const std::string &fn)
+        {
+            if (!w)
+                {
+                    w.reset(new async_gz_writer(fn, "ab"));
+                }
+            return *w;
+        }
+
         void
-        write_sample_details(gzFile gz, const Sequence::SimData &d)
+        write_sample(async_gz_writer &w, const KTfwd::sample_t &s)
         {
-            std::stringstream o;
-            o << d << '\n';
-            gzwrite(gz, o.str().c_str(), o.str().size());
+            if (binary)
+                {
+                    write_sample(w, s.empty() ? packed_sample(nsam)
+                                              : packed_sample::from_strings(s));
+                    return;
+                }
+            text_buffer.str(std::string());
+            text_buffer << Sequence::SimData(s.begin(), s.end()) << '\n';
+            w.write(text_buffer.str());
         }
 
         void
-        write_sample(const std::string &fn, const KTfwd::sample_t &s)
+        write_sample(async_gz_writer &w, const packed_sample &s)
+        /*!
+          The binary format of one sample is the number of sites and the
+          sample size, as 32-bit unsigned integers, followed by the
+          positions as doubles and then the bits of each site, as in
+          fwdpy::packed_sample.  All values are in native byte order.
+        */
         {
-            gzFile gz = gzopen(fn.c_str(), "ab");
-            write_sample_details(gz, Sequence::SimData(s.begin(), s.end()));
-            gzclose(gz);
+            if (!binary)
+                {
+                    write_sample(w, s.to_strings());
+                    return;
+                }
+            const std::uint32_t header[2]
+                = { std::uint32_t(s.size()), std::uint32_t(s.nsam) };
+            binary_buffer.assign(reinterpret_cast<const char *>(header),
+                                 sizeof(header));
+            binary_buffer.append(reinterpret_cast<const char *>(s.pos.data()),
+                                 s.pos.size() * sizeof(double));
+            binary_buffer.append(
+                reinterpret_cast<const char *>(s.bits.data()),
+                s.bits.size() * sizeof(packed_sample::word_t));
+            w.write(binary_buffer);
         }
 
+        template <typename sample_type>
         void
-        write_mloc_sample(const std::string &fn,
-                          const std::vector<KTfwd::sep_sample_t> &s,
-                          const bool neutral)
+        write_samples(const sample_type &neutral, const sample_type &selected)
         {
-            gzFile gz = gzopen(fn.c_str(), "ab");
-            for (auto &&si : s)
+            if (write_error)
+                return;
+            try
                 {
-                    if (neutral)
+                    if (!nfile.empty())
                         {
-                            write_sample_details(
-                                gz, Sequence::SimData(si.first.begin(),
-                                                      si.first.end()));
+                            write_sample(writer(nwriter, nfile), neutral);
                         }
-                    else
+                    if (!sfile.empty())
                         {
-                            write_sample_details(
-                                gz, Sequence::SimData(si.second.begin(),
-                                                      si.second.end()));
+                            write_sample(writer(swriter, sfile), selected);
                         }
                 }
-            gzclose(gz);
+            catch (...)
+                {
+                    write_error = std::current_exception();
+                }
+        }
+
+        void
+        close(std::unique_ptr<async_gz_writer> &w)
+        {
+            if (!w)
+                return;
+            try
+                {
+                    w->close();
+                }
+            catch (...)
+                {
+                    if (!write_error)
+                        write_error = std::current_exception();
+                }
+            w.reset();
+        }
+
+        template <typename pop_t>
+        variant_index
+        make_index(const pop_t *pop) const
+        //! The index is only needed, and so only built, if recording details
+        {
+            return recordDetails
+                       ? variant_index(pop->mutations, pop->fixations)
+                       : variant_index();
+        }
+
+        void
+        record_packed(packed_sep_sample_t &&s, const variant_index &index,
+                      const singlepop_t::mcont_t &mutations,
+                      const singlepop_t::mcont_t &fixations,
+                      const std::vector<KTfwd::uint_t> &fixation_times,
+                      const singlepop_t::mcount_t &mcounts,
+                      const std::size_t N, const unsigned generation,
+                      const unsigned locus)
+        {
+            popsample_details details;
+            if (recordDetails)
+                {
+                    details = get_sh_details(s.second, index, mutations,
+                                             fixations, fixation_times,
+                                             mcounts, N, generation, locus);
+                }
+            if (recordSamples)
+                {
+                    rv_packed->emplace_back(std::move(s), std::move(details));
+                }
+            else if (recordDetails)
+                {
+                    rv_packed->emplace_back(packed_sep_sample_t(),
+                                            std::move(details));
+                }
+        }
+
+        void
+        packed_call(const singlepop_t *pop, const unsigned generation)
+        {
+            auto s = packed_sample_separate(r.get(), *pop, nsam, removeFixed);
+            write_samples(s.first, s.second);
+            record_packed(std::move(s), make_index(pop), pop->mutations,
+                          pop->fixations, pop->fixation_times, pop->mcounts,
+                          pop->diploids.size(), generation, 0);
+        }
+
+        void
+        packed_call(const multilocus_t *pop, const unsigned generation)
+        {
+            auto s = packed_sample_separate(r.get(), *pop, nsam, removeFixed,
+                                            locus_boundaries);
+            const auto index = make_index(pop);
+            for (unsigned i = 0; i < s.size(); ++i)
+                {
+                    write_samples(s[i].first, s[i].second);
+                    record_packed(std::move(s[i]), index, pop->mutations,
+                                  pop->fixations, pop->fixation_times,
+                                  pop->mcounts, pop->diploids.size(),
+                                  generation, i);
+                }
         }
 
       public:
         virtual void
         operator()(const singlepop_t *pop, const unsigned generation)
         {
-            auto s = KTfwd::sample_separate(r.get(), *pop, nsam, removeFixed);
-            remove_redundant_selected_fixations(s);
-            if (!nfile.empty())
+            if (packed)
                 {
-                    write_sample(nfile, s.first);
-                }
-            if (!sfile.empty())
-                {
-                    write_sample(sfile, s.second);
+                    packed_call(pop, generation);
+                    return;
                 }
+            auto s = KTfwd::sample_separate(r.get(), *pop, nsam, removeFixed);
+            remove_redundant_selected_fixations(s);
+            write_samples(s.first, s.second);
             if (recordDetails)
                 {
                     auto details = get_sh_details(
-                        s.second, pop->mutations, pop->fixations,
+                        s.second, make_index(pop), pop->mutations,
+                        pop->fixations,
                         pop->fixation_times, pop->mcounts,
                         pop->diploids.size(), generation, 0);
                     if (recordSamples)
@@ -136,26 +265,26 @@ namespace fwdpy
         virtual void
         operator()(const multilocus_t *pop, const unsigned generation)
         {
+            if (packed)
+                {
+                    packed_call(pop, generation);
+                    return;
+                }
             auto s = KTfwd::sample_separate(r.get(), *pop, nsam, removeFixed,
                                             locus_boundaries);
             for (auto &si : s)
                 {
                     remove_redundant_selected_fixations(si);
+                    write_samples(si.first, si.second);
                 }
-            if (!nfile.empty())
-                {
-                    write_mloc_sample(nfile, s, true);
-                }
-            if (!sfile.empty())
-                {
-                    write_mloc_sample(sfile, s, false);
-                }
+            const auto index = make_index(pop);
             for (unsigned i = 0; i < s.size(); ++i)
                 {
                     if (recordDetails)
                         {
                             auto details = get_sh_details(
-                                s[i].second, pop->mutations, pop->fixations,
+                                s[i].second, index, pop->mutations,
+                                pop->fixations,
                                 pop->fixation_times, pop->mcounts,
                                 pop->diploids.size(), generation, i);
                             if (recordSamples)
@@ -179,7 +308,39 @@ namespace fwdpy
                         }
                 }
 		}
+            virtual void
+            cleanup()
+            /*!
+              Close output files.  Does not throw, because evolve functions
+              call this on a replicate's thread.
+            */
+            {
+                close(nwriter);
+                close(swriter);
+            }
+
+            virtual void
+            flush()
+            /*!
+              Wait for all samples to be written, and close the output
+              files.  They are re-opened in append mode if more samples are
+              taken.
+
+              \throw The first error that occurred while opening or writing
+              an output file since the last call.
+            */
+            {
+                cleanup();
+                if (write_error)
+                    {
+                        auto e = write_error;
+                        write_error = nullptr;
+                        std::rethrow_exception(e);
+                    }
+            }
+
             final_t final() const { return rv; }
+            packed_final_t packed_final() const { return rv_packed; }
             explicit sample_n(
                 unsigned nsam_, const gsl_rng *r_,
                 const std::string &neutral_file,
@@ -187,19 +348,36 @@ namespace fwdpy
                 const bool rec_samples = true, const bool rec_sh = true,
                 const std::vector<std::pair<double, double>> &boundaries
                 = std::vector<std::pair<double, double>>(),
-                const bool append = true)
+                const bool append = true, const bool packed_ = false,
+                const bool binary_ = false)
                 : rv(final_t(std::make_shared<final_t::element_type>(
                       final_t::element_type()))),
+                  rv_packed(std::make_shared<packed_final_t::element_type>()),
                   nsam(nsam_), r(GSLrng_t(gsl_rng_get(r_))),
                   nfile(neutral_file), sfile(selected_file),
                   locus_boundaries(boundaries), removeFixed(rfixed),
-                  recordSamples(rec_samples), recordDetails(rec_sh)
+                  recordSamples(rec_samples), recordDetails(rec_sh),
+                  packed(packed_), binary(binary_), nwriter{}, swriter{},
+                  write_error{}, text_buffer{}, binary_buffer{}
             /*!
               Note the implementation of this constructor!!
 
               By taking a gsl_rng * from outside, we are able to guarantee
               that this object is reproducibly seeded to the extent that
               this constructor is called in a reproducible order.
+
+              If packed_ is true, samples are stored as
+              fwdpy::packed_sep_sample_t, and are returned by packed_final()
+              instead of final().
+
+              Output files are kept open between sampling events, and are
+              compressed on a background thread.  They are complete once
+              cleanup() or flush() is called, or this object is destroyed.
+              Evolve functions and apply_sampler_cpp call flush() before
+              returning.
+              If binary_ is true, the format described at
+              write_sample(async_gz_writer &, const packed_sample &) is
+              written instead of "ms" format.
             */
             {
                 if (!append)
@@ -1,6 +1,7 @@
 #ifndef FWDPY_GET_SELECTED_MUT_DATA_HPP
 #define FWDPY_GET_SELECTED_MUT_DATA_HPP
 #include "sampler_base.hpp"
+#include "sampling_pass.hpp"
 #include "types.hpp"
 #include <limits>
 #include <memory>
@@ -102,6 +103,19 @@ namespace fwdpy
         {
             call_operator_details(pop, generation);
         }
+        virtual bool
+        uses_sampling_pass() const
+        {
+            return true;
+        }
+        virtual void
+        apply_pass(const sampling_pass &p)
+        {
+            for (const auto k : p.selected)
+                record((*p.mutations)[k],
+                       double((*p.mcounts)[k]) / double(p.twoN),
+                       p.generation);
+        }
 
         final_t
         final() const
@@ -119,6 +133,33 @@ namespace fwdpy
       private:
         trajectories_t trajectories;
         final_t data;
+        template <typename mutation_t>
+        inline void
+        record(const mutation_t &__m, const double freq,
+               const unsigned generation)
+        {
+            selected_mut_data __p(__m.g, __m.pos, __m.s, __m.xtra);
+            auto __itr = trajectories.find(__p);
+            if (__itr == trajectories.end())
+                {
+                    // update the data
+                    data->emplace_back(
+                        __p, std::vector<std::pair<unsigned, double>>(
+                                 1, std::make_pair(generation, freq)));
+                    // update index tree
+                    trajectories[__p] = data->size() - 1;
+                }
+            else
+                {
+                    // Don't keep updating for fixed
+                    // variants
+                    auto data_itr = data->begin() + __itr->second;
+                    if (data_itr->second.back().second < 1.)
+                        {
+                            data_itr->second.emplace_back(generation, freq);
+                        }
+                }
+        }
         template <typename pop_t>
         inline void
         call_operator_details(const pop_t *pop, const unsigned generation)
@@ -130,38 +171,11 @@ namespace fwdpy
                             const auto &__m = pop->mutations[i];
                             if (!__m.neutral)
                                 {
-                                    const auto freq
-                                        = double(pop->mcounts[i])
-                                          / double(2 * pop->diploids.size());
-                                    selected_mut_data __p(__m.g, __m.pos,
-                                                          __m.s, __m.xtra);
-                                    auto __itr = trajectories.find(__p);
-                                    if (__itr == trajectories.end())
-                                        {
-                                            // update the data
-                                            data->emplace_back(
-                                                __p,
-                                                std::vector<std::pair<unsigned,
-                                                                      double>>(
-                                                    1, std::make_pair(
-                                                           generation, freq)));
-                                            // update index tree
-                                            trajectories[__p] = data->size()-1;
-                                        }
-                                    else
-                                        {
-                                            // Don't keep updating for fixed
-                                            // variants
-                                            auto data_itr = data->begin()
-                                                            + __itr->second;
-                                            if (data_itr->second.back().second
-                                                < 1.)
-                                                {
-                                                    data_itr->second
-                                                        .emplace_back(
-                                                            generation, freq);
-                                                }
-                                        }
+                                    record(__m,
+                                           double(pop->mcounts[i])
+                                               / double(2
+                                                        * pop->diploids.size()),
+                                           generation);
                                 }
                         }
                 }
@@ -0,0 +1,162 @@
+/*!
+  \file sampler_sfs.hpp
+
+  \brief Expected site frequency spectra of a sample, from mcounts.
+
+  A mutation present in c of the M = 2N chromosomes in the population is
+  found in j copies in a sample of n chromosomes, drawn without replacement,
+  with hypergeometric probability C(c,j)C(M-c,n-j)/C(M,n).  Summing these
+  probabilities over mutations gives the expected SFS of a sample of size n.
+  This requires no sampling, and so has no sampling noise.
+*/
+#ifndef FWDPY_SAMPLER_SFS_HPP
+#define FWDPY_SAMPLER_SFS_HPP
+
+#include "sampler_base.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <gsl/gsl_randist.h>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace fwdpy
+{
+    struct sfs_data
+    /*!
+      Columnar output of fwdpy::sfs_sampler.  Each time point contributes one
+      row per (label, neutral/selected) combination.  Row i of the SFS is
+      sfs[i*(nsam+1)] to sfs[(i+1)*(nsam+1)-1], and element j is the expected
+      number of sites with j derived copies in the sample.
+    */
+    {
+        std::vector<unsigned> generation;
+        //! Mutation label, or -1 if the SFS is over all labels
+        std::vector<int> label;
+        std::vector<int> neutral;
+        std::vector<double> sfs;
+        unsigned nsam;
+    };
+
+    class sfs_sampler : public sampler_base
+    {
+      public:
+        using final_t = sfs_data;
+
+      private:
+        final_t rv;
+        const unsigned nsam;
+        const bool by_label;
+        //! Projection probabilities for each count c, for cached_twoN
+        std::unordered_map<unsigned, std::vector<double>> projections;
+        unsigned cached_twoN;
+
+        const std::vector<double> &
+        projection(const unsigned c, const unsigned twoN)
+        {
+            auto i = projections.find(c);
+            if (i != projections.end())
+                return i->second;
+            std::vector<double> p(nsam + 1, 0.);
+            const unsigned jmin = (nsam > twoN - c) ? nsam - (twoN - c) : 0;
+            const unsigned jmax = std::min(c, nsam);
+            for (unsigned j = jmin; j <= jmax; ++j)
+                p[j] = gsl_ran_hypergeometric_pdf(j, c, twoN - c, nsam);
+            return projections.emplace(c, std::move(p)).first->second;
+        }
+
+        template <typename pop_t>
+        void
+        call_operator_details(const pop_t *pop, const unsigned generation)
+        {
+            const unsigned twoN = unsigned(2 * pop->diploids.size());
+            if (nsam > twoN)
+                throw std::runtime_error(
+                    "sample size larger than number of chromosomes");
+            if (twoN != cached_twoN)
+                {
+                    projections.clear();
+                    cached_twoN = twoN;
+                }
+            // label -> (neutral SFS, selected SFS)
+            std::map<int, std::pair<std::vector<double>, std::vector<double>>>
+                spectra;
+            auto empty = [this]() {
+                return std::make_pair(std::vector<double>(nsam + 1, 0.),
+                                      std::vector<double>(nsam + 1, 0.));
+            };
+            if (!by_label)
+                spectra.emplace(-1, empty());
+            for (std::size_t k = 0; k < pop->mutations.size(); ++k)
+                {
+                    const auto c = pop->mcounts[k];
+                    if (!c)
+                        continue;
+                    const int label
+                        = by_label ? int(pop->mutations[k].xtra) : -1;
+                    auto s = spectra.find(label);
+                    if (s == spectra.end())
+                        s = spectra.emplace(label, empty()).first;
+                    auto &target = pop->mutations[k].neutral ? s->second.first
+                                                             : s->second.second;
+                    const auto &p = projection(c, twoN);
+                    for (unsigned j = 0; j <= nsam; ++j)
+                        target[j] += p[j];
+                }
+            for (const auto &s : spectra)
+                {
+                    for (int neutral = 1; neutral >= 0; --neutral)
+                        {
+                            const auto &x
+                                = neutral ? s.second.first : s.second.second;
+                            rv.generation.push_back(generation);
+                            rv.label.push_back(s.first);
+                            rv.neutral.push_back(neutral);
+                            rv.sfs.insert(rv.sfs.end(), x.begin(), x.end());
+                        }
+                }
+        }
+
+      public:
+        virtual void
+        operator()(const singlepop_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        operator()(const multilocus_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        cleanup()
+        {
+            projections.clear();
+        }
+
+        final_t
+        final() const
+        {
+            return rv;
+        }
+
+        explicit sfs_sampler(const unsigned nsam_, const bool by_label_)
+            : rv(final_t()), nsam(nsam_), by_label(by_label_), projections{},
+              cached_twoN(0)
+        /*!
+          \param nsam_ The sample size (number of chromosomes)
+          \param by_label_ If true, a separate SFS is recorded for each value
+          of the mutation label (xtra).
+        */
+        {
+            if (!nsam)
+                throw std::invalid_argument("sample size must be > 0");
+            rv.nsam = nsam;
+        }
+    };
+}
+
+#endif
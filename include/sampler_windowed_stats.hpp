@@ -0,0 +1,329 @@
+/*!
+  \file sampler_windowed_stats.hpp
+
+  \brief Summary statistics in windows, computed from gametes.
+
+  Statistics are obtained directly from the mutation keys stored in gametes
+  and from mcounts, without first converting the data into ms-style strings.
+  Either the entire population or a random sample of chromosomes is used.
+*/
+#ifndef FWDPY_SAMPLER_WINDOWED_STATS_HPP
+#define FWDPY_SAMPLER_WINDOWED_STATS_HPP
+
+#include "sampler_base.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gsl/gsl_randist.h>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fwdpy
+{
+    struct windowed_stats_data
+    /*!
+      Columnar output of fwdpy::windowed_stats.  Each element of each vector
+      is one window at one time point.
+
+      All statistics are totals for the window, not per-site values.
+      H is Fay and Wu's (2000) unnormalized H, pi - thetaH.  Tajima's D is
+      NaN if S == 0.
+    */
+    {
+        std::vector<unsigned> generation;
+        std::vector<double> left, right;
+        std::vector<unsigned> S;
+        std::vector<double> pi, thetaW, tajd, thetaH, H;
+        //! Haplotype diversity and number of distinct haplotypes
+        std::vector<double> hapdiv;
+        std::vector<unsigned> nhaps;
+    };
+
+    class windowed_stats : public sampler_base
+    {
+      public:
+        using final_t = windowed_stats_data;
+
+      private:
+        final_t rv;
+        GSLrng_t r;
+        //! Sorted, non-overlapping half-open windows [left,right)
+        std::vector<std::pair<double, double>> windows;
+        //! Number of chromosomes to sample.  0 means the entire population.
+        const unsigned nsam;
+        const bool include_selected;
+        // Buffers re-used across calls
+        std::vector<unsigned> sample_counts;
+        std::vector<std::size_t> chromosomes;
+        std::vector<std::vector<KTfwd::uint_t>> window_keys;
+
+        //! A distinct haplotype (one gamete per locus) and its count
+        using haplotype_t
+            = std::pair<std::vector<std::size_t>, unsigned>;
+
+        static double
+        harmonic(const unsigned n, const int power)
+        {
+            double rv = 0.;
+            for (unsigned i = 1; i < n; ++i)
+                rv += 1. / std::pow(double(i), power);
+            return rv;
+        }
+
+        std::size_t
+        window_index(const double pos) const
+        //! \return index of the window containing pos, or windows.size()
+        {
+            auto i = std::upper_bound(
+                windows.begin(), windows.end(), pos,
+                [](const double p, const std::pair<double, double> &w) {
+                    return p < w.first;
+                });
+            if (i == windows.begin())
+                return windows.size();
+            --i;
+            return (pos < i->second)
+                       ? std::size_t(std::distance(windows.begin(), i))
+                       : windows.size();
+        }
+
+        std::vector<std::size_t> &
+        sample_chromosomes(const std::size_t twoN)
+        {
+            if (nsam > twoN)
+                throw std::runtime_error(
+                    "sample size larger than number of chromosomes");
+            chromosomes.resize(twoN);
+            for (std::size_t i = 0; i < twoN; ++i)
+                chromosomes[i] = i;
+            std::vector<std::size_t> s(nsam);
+            gsl_ran_choose(r.get(), s.data(), nsam, chromosomes.data(),
+                           twoN, sizeof(std::size_t));
+            chromosomes.swap(s);
+            return chromosomes;
+        }
+
+        std::vector<haplotype_t>
+        haplotypes(const singlepop_t *pop)
+        {
+            std::vector<haplotype_t> h;
+            if (!nsam)
+                {
+                    for (std::size_t g = 0; g < pop->gametes.size(); ++g)
+                        {
+                            if (pop->gametes[g].n)
+                                h.emplace_back(std::vector<std::size_t>(1, g),
+                                               pop->gametes[g].n);
+                        }
+                    return h;
+                }
+            std::unordered_map<std::size_t, unsigned> counts;
+            for (const auto c : sample_chromosomes(2 * pop->diploids.size()))
+                {
+                    const auto &dip = pop->diploids[c / 2];
+                    counts[(c % 2) ? dip.second : dip.first]++;
+                }
+            for (const auto &c : counts)
+                h.emplace_back(std::vector<std::size_t>(1, c.first),
+                               c.second);
+            return h;
+        }
+
+        std::vector<haplotype_t>
+        haplotypes(const multilocus_t *pop)
+        {
+            const std::size_t twoN = 2 * pop->diploids.size();
+            std::map<std::vector<std::size_t>, unsigned> counts;
+            std::vector<std::size_t> g;
+            auto add = [&](const std::size_t c) {
+                g.clear();
+                for (const auto &locus : pop->diploids[c / 2])
+                    g.push_back((c % 2) ? locus.second : locus.first);
+                counts[g]++;
+            };
+            if (nsam)
+                {
+                    for (const auto c : sample_chromosomes(twoN))
+                        add(c);
+                }
+            else
+                {
+                    for (std::size_t c = 0; c < twoN; ++c)
+                        add(c);
+                }
+            return std::vector<haplotype_t>(counts.begin(), counts.end());
+        }
+
+        template <typename pop_t>
+        void
+        call_operator_details(const pop_t *pop, const unsigned generation)
+        {
+            const auto hap = haplotypes(pop);
+            const unsigned n
+                = nsam ? nsam : unsigned(2 * pop->diploids.size());
+            const bool sampled = nsam > 0;
+            if (sampled)
+                sample_counts.assign(pop->mutations.size(), 0);
+
+            // Count each distinct haplotype within each window
+            std::vector<std::map<std::vector<KTfwd::uint_t>, unsigned>>
+                window_haps(windows.size());
+            window_keys.resize(windows.size());
+            auto bin_keys = [&](const typename gamete_t::mutation_container
+                                    &keys,
+                                const unsigned count) {
+                for (const auto k : keys)
+                    {
+                        const auto w = window_index(pop->mutations[k].pos);
+                        if (w < windows.size())
+                            window_keys[w].push_back(k);
+                        if (sampled)
+                            sample_counts[k] += count;
+                    }
+            };
+            for (const auto &h : hap)
+                {
+                    for (auto &wk : window_keys)
+                        wk.clear();
+                    for (const auto g : h.first)
+                        {
+                            bin_keys(pop->gametes[g].mutations, h.second);
+                            if (include_selected)
+                                bin_keys(pop->gametes[g].smutations,
+                                         h.second);
+                        }
+                    for (std::size_t w = 0; w < windows.size(); ++w)
+                        {
+                            std::sort(window_keys[w].begin(),
+                                      window_keys[w].end());
+                            window_haps[w][window_keys[w]] += h.second;
+                        }
+                }
+
+            // Site-based statistics from allele counts
+            std::vector<unsigned> S(windows.size(), 0);
+            std::vector<double> pi(windows.size(), 0.),
+                thetaH(windows.size(), 0.);
+            const double denom = double(n) * double(n - 1);
+            const auto &counts = sampled ? sample_counts : pop->mcounts;
+            for (std::size_t k = 0; k < pop->mutations.size(); ++k)
+                {
+                    const auto c = counts[k];
+                    if (!c || c >= n)
+                        continue;
+                    if (!include_selected && !pop->mutations[k].neutral)
+                        continue;
+                    const auto w = window_index(pop->mutations[k].pos);
+                    if (w == windows.size())
+                        continue;
+                    ++S[w];
+                    pi[w] += 2. * double(c) * double(n - c) / denom;
+                    thetaH[w] += 2. * double(c) * double(c) / denom;
+                }
+
+            const double a1 = harmonic(n, 1), a2 = harmonic(n, 2);
+            const double b1 = double(n + 1) / (3. * double(n - 1)),
+                         b2 = 2. * (double(n) * double(n) + n + 3.)
+                              / (9. * double(n) * double(n - 1));
+            const double c1 = b1 - 1. / a1,
+                         c2 = b2 - double(n + 2) / (a1 * double(n))
+                              + a2 / (a1 * a1);
+            const double e1 = c1 / a1, e2 = c2 / (a1 * a1 + a2);
+            for (std::size_t w = 0; w < windows.size(); ++w)
+                {
+                    rv.generation.push_back(generation);
+                    rv.left.push_back(windows[w].first);
+                    rv.right.push_back(windows[w].second);
+                    rv.S.push_back(S[w]);
+                    rv.pi.push_back(pi[w]);
+                    rv.thetaW.push_back(double(S[w]) / a1);
+                    rv.tajd.push_back(
+                        S[w] ? (pi[w] - double(S[w]) / a1)
+                                   / std::sqrt(e1 * S[w]
+                                               + e2 * S[w] * (S[w] - 1.))
+                             : std::numeric_limits<double>::quiet_NaN());
+                    rv.thetaH.push_back(thetaH[w]);
+                    rv.H.push_back(pi[w] - thetaH[w]);
+                    double ssh = 0.;
+                    for (const auto &wh : window_haps[w])
+                        {
+                            const double f = double(wh.second) / double(n);
+                            ssh += f * f;
+                        }
+                    rv.hapdiv.push_back(double(n) / double(n - 1)
+                                        * (1. - ssh));
+                    rv.nhaps.push_back(unsigned(window_haps[w].size()));
+                }
+        }
+
+      public:
+        virtual void
+        operator()(const singlepop_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        operator()(const multilocus_t *pop, const unsigned generation)
+        {
+            call_operator_details(pop, generation);
+        }
+
+        virtual void
+        cleanup()
+        {
+            sample_counts.clear();
+            sample_counts.shrink_to_fit();
+            chromosomes.clear();
+            chromosomes.shrink_to_fit();
+            window_keys.clear();
+            window_keys.shrink_to_fit();
+        }
+
+        final_t
+        final() const
+        {
+            return rv;
+        }
+
+        explicit windowed_stats(
+            const gsl_rng *r_,
+            const std::vector<std::pair<double, double>> &windows_,
+            const unsigned nsam_, const bool include_selected_)
+            : rv(final_t()), r(GSLrng_t(gsl_rng_get(r_))), windows(windows_),
+              nsam(nsam_), include_selected(include_selected_),
+              sample_counts{}, chromosomes{}, window_keys{}
+        /*!
+          \param r_ Used to seed this object's random number generator, as
+          in fwdpy::sample_n.
+          \param windows_ Half-open intervals [left,right).  They may be
+          given in any order, but may not overlap.
+          \param nsam_ Number of chromosomes to sample without replacement.
+          If 0, the entire population is used.
+          \param include_selected_ If true, selected mutations are included.
+          Otherwise, only neutral mutations are used.
+        */
+        {
+            if (windows.empty())
+                throw std::invalid_argument("no windows given");
+            if (nsam == 1)
+                throw std::invalid_argument("sample size must be > 1");
+            std::sort(windows.begin(), windows.end());
+            for (std::size_t i = 0; i < windows.size(); ++i)
+                {
+                    if (!(windows[i].second > windows[i].first))
+                        throw std::invalid_argument(
+                            "window right must be > window left");
+                    if (i && windows[i].first < windows[i - 1].second)
+                        throw std::invalid_argument(
+                            "windows may not overlap");
+                }
+        }
+    };
+}
+
+#endif
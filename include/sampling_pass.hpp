@@ -0,0 +1,125 @@
+/*!
+  \file sampling_pass.hpp
+
+  \brief Data gathered in one traversal of a population, shared by the
+  children of a fwdpy::composite_sampler.
+*/
+#ifndef FWDPY_SAMPLING_PASS_HPP
+#define FWDPY_SAMPLING_PASS_HPP
+
+#include "types.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace fwdpy
+{
+    struct sampling_pass
+    /*!
+      Filled by fwdpy::fill_sampling_pass.  mutations and mcounts point
+      into the population and are only valid while the pass is being
+      dispatched.
+
+      The selected mutations carried by diploid i are
+      carried[offsets[i]] to carried[offsets[i+1]-1], over both gametes
+      (and all loci), with one entry per copy.  Fixed mutations are left
+      out.  For multi-locus populations, g, e and w are taken from the
+      first locus.
+    */
+    {
+        const mcont_t *mutations;
+        const std::vector<unsigned> *mcounts;
+        unsigned generation;
+        //! Twice the number of diploids
+        unsigned twoN;
+        //! Keys of extant, non-neutral mutations, including fixations
+        std::vector<KTfwd::uint_t> selected;
+        std::vector<double> g, e, w;
+        std::vector<std::size_t> offsets;
+        std::vector<KTfwd::uint_t> carried;
+
+        sampling_pass()
+            : mutations(nullptr), mcounts(nullptr), generation(0), twoN(0),
+              selected{}, g{}, e{}, w{}, offsets{}, carried{}
+        {
+        }
+    };
+
+    namespace sampling_pass_detail
+    {
+        template <typename pop_t>
+        void
+        start(const pop_t *pop, const unsigned generation, sampling_pass &p)
+        // Buffers are cleared, not freed, so they are reused between calls
+        {
+            p.mutations = &pop->mutations;
+            p.mcounts = &pop->mcounts;
+            p.generation = generation;
+            p.twoN = unsigned(2 * pop->diploids.size());
+            p.selected.clear();
+            p.g.clear();
+            p.e.clear();
+            p.w.clear();
+            p.offsets.assign(1, 0);
+            p.carried.clear();
+            for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
+                {
+                    if (pop->mcounts[i] && !pop->mutations[i].neutral)
+                        p.selected.push_back(KTfwd::uint_t(i));
+                }
+        }
+
+        template <typename pop_t, typename diploid_t>
+        void
+        add_carried(const pop_t *pop, const diploid_t &dip, sampling_pass &p)
+        {
+            for (const auto k : pop->gametes[dip.first].smutations)
+                {
+                    if (pop->mcounts[k] < p.twoN)
+                        p.carried.push_back(k);
+                }
+            for (const auto k : pop->gametes[dip.second].smutations)
+                {
+                    if (pop->mcounts[k] < p.twoN)
+                        p.carried.push_back(k);
+                }
+        }
+
+        template <typename diploid_t>
+        void
+        add_values(const diploid_t &dip, sampling_pass &p)
+        {
+            p.g.push_back(dip.g);
+            p.e.push_back(dip.e);
+            p.w.push_back(dip.w);
+        }
+    }
+
+    inline void
+    fill_sampling_pass(const singlepop_t *pop, const unsigned generation,
+                       sampling_pass &p)
+    {
+        sampling_pass_detail::start(pop, generation, p);
+        for (const auto &dip : pop->diploids)
+            {
+                sampling_pass_detail::add_values(dip, p);
+                sampling_pass_detail::add_carried(pop, dip, p);
+                p.offsets.push_back(p.carried.size());
+            }
+    }
+
+    inline void
+    fill_sampling_pass(const multilocus_t *pop, const unsigned generation,
+                       sampling_pass &p)
+    {
+        sampling_pass_detail::start(pop, generation, p);
+        for (const auto &dip : pop->diploids)
+            {
+                sampling_pass_detail::add_values(dip.front(), p);
+                for (const auto &locus : dip)
+                    sampling_pass_detail::add_carried(pop, locus, p);
+                p.offsets.push_back(p.carried.size());
+            }
+    }
+}
+
+#endif
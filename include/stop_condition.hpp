@@ -0,0 +1,213 @@
+/*!
+  \file stop_condition.hpp
+
+  \brief Conditions that end a simulation before the end of Nvector.
+*/
+#ifndef FWDPY_STOP_CONDITION_HPP
+#define FWDPY_STOP_CONDITION_HPP
+
+#include "types.hpp"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace fwdpy
+{
+    struct stop_condition
+    /*!
+      Base class for a condition checked once per generation by the evolve
+      functions.  Evolution of a replicate stops at the first generation for
+      which done() returns true.
+
+      As with samplers, each replicate has its own object.
+    */
+    {
+        //! Generation at which the condition was met
+        unsigned generation;
+        stop_condition() : generation(std::numeric_limits<unsigned>::max()) {}
+
+        virtual bool
+        done(const singlepop_t *)
+        {
+            throw std::runtime_error("stop condition not implemented for "
+                                     "single deme simulations");
+        }
+        virtual void
+        reset()
+        /*!
+          Evolve functions call this before the first generation.  Derived
+          classes keeping state between generations must call this version.
+        */
+        {
+            generation = std::numeric_limits<unsigned>::max();
+        }
+        bool
+        check(const singlepop_t *pop)
+        {
+            if (done(pop))
+                {
+                    generation = pop->generation;
+                    return true;
+                }
+            return false;
+        }
+        bool
+        stopped() const
+        {
+            return generation != std::numeric_limits<unsigned>::max();
+        }
+        virtual ~stop_condition() {}
+    };
+
+    inline void
+    clear_stop_conditions(std::vector<std::unique_ptr<stop_condition>> &v)
+    {
+        std::vector<std::unique_ptr<stop_condition>>().swap(v);
+    }
+
+    class tracked_mutation_stop : public stop_condition
+    /*!
+      Stop when the mutation at a given position fixes and/or is lost.  The
+      mutation must be present when evolution starts.
+    */
+    {
+      public:
+        tracked_mutation_stop(const double pos_, const bool on_fixation_,
+                              const bool on_loss_)
+            : stop_condition(), pos(pos_), on_fixation(on_fixation_),
+              on_loss(on_loss_), key(std::numeric_limits<std::size_t>::max())
+        {
+            if (!on_fixation && !on_loss)
+                throw std::invalid_argument(
+                    "tracked mutation must stop on fixation or loss");
+        }
+
+        virtual void
+        reset()
+        {
+            stop_condition::reset();
+            key = std::numeric_limits<std::size_t>::max();
+        }
+
+        virtual bool
+        done(const singlepop_t *pop)
+        {
+            if (key == std::numeric_limits<std::size_t>::max()
+                && !find_key(pop))
+                return gone(pop);
+            // A key is only recycled once its count is zero, so a
+            // change of position means the mutation is gone.
+            if (!pop->mcounts[key] || pop->mutations[key].pos != pos)
+                return gone(pop);
+            if (pop->mcounts[key] == 2 * pop->diploids.size())
+                return on_fixation;
+            return false;
+        }
+
+      private:
+        const double pos;
+        const bool on_fixation, on_loss;
+        std::size_t key;
+
+        bool
+        find_key(const singlepop_t *pop)
+        {
+            for (std::size_t i = 0; i < pop->mutations.size(); ++i)
+                {
+                    if (pop->mcounts[i] && pop->mutations[i].pos == pos)
+                        {
+                            key = i;
+                            return true;
+                        }
+                }
+            return false;
+        }
+
+        bool
+        gone(const singlepop_t *pop) const
+        // Fixations may have been removed from the population
+        {
+            for (const auto &m : pop->fixations)
+                {
+                    if (m.pos == pos)
+                        return on_fixation;
+                }
+            return on_loss;
+        }
+    };
+
+    class optimum_stop : public stop_condition
+    /*!
+      Stop when the mean trait value (g + e) is within epsilon of an
+      optimum.
+    */
+    {
+      public:
+        optimum_stop(const double optimum_, const double epsilon_)
+            : stop_condition(), optimum(optimum_), epsilon(epsilon_)
+        {
+            if (!std::isfinite(optimum) || !std::isfinite(epsilon)
+                || epsilon < 0.)
+                throw std::invalid_argument(
+                    "optimum must be finite and epsilon must be >= 0");
+        }
+
+        virtual bool
+        done(const singlepop_t *pop)
+        {
+            double sum = 0.;
+            for (const auto &dip : pop->diploids)
+                sum += dip.g + dip.e;
+            return std::fabs(sum / double(pop->diploids.size()) - optimum)
+                   <= epsilon;
+        }
+
+      private:
+        const double optimum, epsilon;
+    };
+
+    struct no_selected_sites_stop : public stop_condition
+    /*!
+      Stop when no selected mutation is segregating.
+    */
+    {
+        virtual bool
+        done(const singlepop_t *pop)
+        {
+            const auto twoN = 2 * pop->diploids.size();
+            for (std::size_t i = 0; i < pop->mcounts.size(); ++i)
+                {
+                    if (pop->mcounts[i] && pop->mcounts[i] < twoN
+                        && !pop->mutations[i].neutral)
+                        return false;
+                }
+            return true;
+        }
+    };
+
+    struct custom_stop_condition : public stop_condition
+    /*!
+      The basis of a stop condition defined by a function in Cython
+    */
+    {
+        using singlepop_predicate = bool (*)(const singlepop_t *,
+                                             const unsigned);
+        singlepop_predicate spred;
+        explicit custom_stop_condition(singlepop_predicate s)
+            : stop_condition(), spred(s)
+        {
+        }
+        virtual bool
+        done(const singlepop_t *pop)
+        {
+            if (spred == nullptr)
+                return stop_condition::done(pop);
+            return spred(pop, pop->generation);
+        }
+    };
+}
+
+#endif
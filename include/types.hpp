@@ -7,6 +7,7 @@
 #ifndef __FWDPY_TYPES__
 #define __FWDPY_TYPES__
 
+#include "evolve_profile.hpp"
 #include "fwdpy_serialization.hpp"
 #include <fwdpp/sugar.hpp>
 #include <fwdpp/sugar/GSLrng_t.hpp>
@@ -151,8 +152,11 @@ namespace fwdpy
         using base = KTfwd::singlepop<KTfwd::popgenmut, diploid_t>;
         //! The current generation.  Start counting from zero
         unsigned generation;
+        //! Timings and counters from evolve functions.  See
+        //! fwdpy::evolve_profile.
+        evolve_profile profile;
         //! Constructor takes number of diploids as argument
-	    explicit singlepop_t(const unsigned &N) : base(N), generation(0) {}
+	    explicit singlepop_t(const unsigned &N) : base(N), generation(0), profile() {}
 
         unsigned
         gen() const
@@ -209,12 +213,23 @@ namespace fwdpy
                 filename, append);
         }
 
+        std::int64_t
+        tofile_bgzf(const char *filename, bool append = false,
+                    const unsigned nthreads = 0) const
+        //! Write BGZF, compressed in parallel.  Read with fromfile.
+        {
+            return fwdpy::serialize_objects::bgzserialize_details(
+                *this, KTfwd::mutation_writer(), fwdpy::diploid_writer(),
+                filename, append, nthreads);
+        }
+
         void
-        fromfile(const char *filename, std::size_t offset)
+        fromfile(const char *filename, std::size_t offset,
+                 const unsigned nthreads = 0)
         {
-            *this = serialize_objects::gzdeserialize_details<singlepop_t>()(
+            *this = serialize_objects::bgzdeserialize_details<singlepop_t>()(
                 KTfwd::mutation_reader<singlepop_t::mutation_t>(),
-                fwdpy::diploid_reader(), filename, offset, 0u);
+                fwdpy::diploid_reader(), filename, offset, nthreads, 0u);
         }
     };
 
@@ -341,12 +356,23 @@ namespace fwdpy
                 filename, append);
         }
 
+        std::int64_t
+        tofile_bgzf(const char *filename, bool append = false,
+                    const unsigned nthreads = 0) const
+        //! Write BGZF, compressed in parallel.  Read with fromfile.
+        {
+            return fwdpy::serialize_objects::bgzserialize_details(
+                *this, KTfwd::mutation_writer(), fwdpy::diploid_writer(),
+                filename, append, nthreads);
+        }
+
         void
-        fromfile(const char *filename, std::size_t offset)
+        fromfile(const char *filename, std::size_t offset,
+                 const unsigned nthreads = 0)
         {
-            *this = serialize_objects::gzdeserialize_details<metapop_t>()(
+            *this = serialize_objects::bgzdeserialize_details<metapop_t>()(
                 KTfwd::mutation_reader<metapop_t::mutation_t>(),
-                fwdpy::diploid_reader(), filename, offset, std::vector<unsigned>(0u));
+                fwdpy::diploid_reader(), filename, offset, nthreads, std::vector<unsigned>(0u));
         }
     };
 
@@ -408,13 +434,24 @@ namespace fwdpy
                 filename, append);
         }
 
+        std::int64_t
+        tofile_bgzf(const char *filename, bool append = false,
+                    const unsigned nthreads = 0) const
+        //! Write BGZF, compressed in parallel.  Read with fromfile.
+        {
+            return fwdpy::serialize_objects::bgzserialize_details(
+                *this, KTfwd::mutation_writer(), fwdpy::diploid_writer(),
+                filename, append, nthreads);
+        }
+
         void
-        fromfile(const char *filename, std::size_t offset)
+        fromfile(const char *filename, std::size_t offset,
+                 const unsigned nthreads = 0)
         {
             *this = serialize_objects::
-                gzdeserialize_details<singlepop_gm_vec_t>()(
+                bgzdeserialize_details<singlepop_gm_vec_t>()(
                     KTfwd::mutation_reader<singlepop_gm_vec_t::mutation_t>(),
-                    fwdpy::diploid_reader(), filename, offset, 0u);
+                    fwdpy::diploid_reader(), filename, offset, nthreads, 0u);
         }
     };
 
@@ -470,12 +507,23 @@ namespace fwdpy
                 filename, append);
         }
 
+        std::int64_t
+        tofile_bgzf(const char *filename, bool append = false,
+                    const unsigned nthreads = 0) const
+        //! Write BGZF, compressed in parallel.  Read with fromfile.
+        {
+            return fwdpy::serialize_objects::bgzserialize_details(
+                *this, KTfwd::mutation_writer(), fwdpy::diploid_writer(),
+                filename, append, nthreads);
+        }
+
         void
-        fromfile(const char *filename, std::size_t offset)
+        fromfile(const char *filename, std::size_t offset,
+                 const unsigned nthreads = 0)
         {
-            *this = serialize_objects::gzdeserialize_details<multilocus_t>()(
+            *this = serialize_objects::bgzdeserialize_details<multilocus_t>()(
                 KTfwd::mutation_reader<multilocus_t::mutation_t>(),
-                fwdpy::diploid_reader(), filename, offset, 0u, 0u);
+                fwdpy::diploid_reader(), filename, offset, nthreads, 0u, 0u);
         }
     };
 }
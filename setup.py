@@ -65,6 +65,12 @@ if '--qtrait' in sys.argv:
 else:
     QTRAIT=False
 
+if '--profile' in sys.argv:
+    PROFILE=True
+    sys.argv.remove('--profile')
+else:
+    PROFILE=False
+
 ##Set up our dependent libraries
 GSLLIBS=["gsl","gslcblas"]
 #MEMLIBS=None
@@ -117,6 +123,9 @@ GLOBAL_COMPILE_ARGS=['-std=c++11','-fopenmp',
                      str('-DPACKAGE_VERSION=')+'"0.0.4"',
                      '-DHAVE_INLINE'
 ]
+if PROFILE is True:
+    #Record per-generation timings and counters in evolve functions
+    GLOBAL_COMPILE_ARGS.append('-DFWDPY_PROFILE')
 LINK_ARGS=["-std=c++11",'-fopenmp']
 GLOBAL_INCLUDES=['.','..','include']
 